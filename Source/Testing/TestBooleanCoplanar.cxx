@@ -0,0 +1,122 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanCoplanar.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the operations on boxes sharing part of a face, with the
+// normals of the shared part pointing the same way or opposite ways,
+// and the shared part inside the face of the first box or across its
+// edge. The volume and area of each result are known exactly; a hole
+// or a doubled copy of the shared part changes them. The boxes are
+// away from the origin so that the faces on the shared plane count in
+// the volume. Also checks three boxes at once, with two smaller boxes
+// touching the first from outside, or filling a column of it and
+// touching each other.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestBooleanCoplanar(int, char *[])
+{
+  const double first[6] = { 0.0, 1.0, 0.0, 1.0, 1.0, 2.0 };
+  const double seconds[4][6] = {
+    // Same orientation, contained and across an edge.
+    { 0.25, 0.75, 0.25, 0.75, 1.0, 1.5 },
+    { 0.5, 1.5, 0.25, 0.75, 1.0, 1.5 },
+    // Opposite orientation, contained and across an edge.
+    { 0.25, 0.75, 0.25, 0.75, 0.5, 1.0 },
+    { 0.5, 1.5, 0.25, 0.75, 0.5, 1.0 } };
+
+  // Volume and area of the union, intersection and difference.
+  const double expected[4][3][2] = {
+    { { 1.0, 6.0 }, { 0.125, 1.5 }, { 0.875, 7.0 } },
+    { { 1.125, 7.0 }, { 0.125, 1.5 }, { 0.875, 6.5 } },
+    { { 1.125, 7.0 }, { 0.0, 0.0 }, { 1.0, 6.0 } },
+    { { 1.25, 8.0 }, { 0.0, 0.0 }, { 1.0, 6.0 } } };
+
+  vtkSmartPointer<vtkPolyData> input0 = vtkBooleanTestBox( first, 2 );
+  for (int c = 0; c < 4; c++)
+    {
+    vtkSmartPointer<vtkPolyData> input1 = vtkBooleanTestBox( seconds[c], 2 );
+    for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+         operation <= vtkBooleanOperationPolyDataFilter::DIFFERENCE;
+         operation++)
+      {
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+        vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+      boolean->SetOperation( operation );
+      boolean->IntersectCoplanarTrianglesOn();
+
+      vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+      if (!boolean->ComputeBoolean( input0, input1, output, lines ))
+        {
+        cerr << "Operation " << operation << " failed for case " << c << endl;
+        return EXIT_FAILURE;
+        }
+
+      double volume = vtkBooleanTestVolume( output );
+      double area = vtkBooleanTestArea( output );
+      if (fabs( volume - expected[c][operation][0] ) > 1e-6 ||
+          fabs( area - expected[c][operation][1] ) > 1e-6)
+        {
+        cerr << "Operation " << operation << " for case " << c
+             << " gives volume " << volume << " and area " << area
+             << " instead of " << expected[c][operation][0] << " and "
+             << expected[c][operation][1] << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  const double cutters[2][2][6] = {
+    // Opposite orientation, below and above the first box.
+    { { 0.25, 0.75, 0.25, 0.75, 0.5, 1.0 },
+      { 0.25, 0.75, 0.25, 0.75, 2.0, 2.5 } },
+    // Same orientation as the first box, and opposite to each other.
+    { { 0.25, 0.75, 0.25, 0.75, 1.0, 1.5 },
+      { 0.25, 0.75, 0.25, 0.75, 1.5, 2.0 } } };
+  const double expectedMultiple[2][3][2] = {
+    { { 1.25, 8.0 }, { 0.0, 0.0 }, { 1.0, 6.0 } },
+    { { 1.0, 6.0 }, { 0.0, 0.0 }, { 0.75, 7.5 } } };
+  for (int c = 0; c < 2; c++)
+    {
+    for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+         operation <= vtkBooleanOperationPolyDataFilter::DIFFERENCE;
+         operation++)
+      {
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+        vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+      boolean->SetOperation( operation );
+      boolean->IntersectCoplanarTrianglesOn();
+      boolean->SetInput( 0, input0 );
+      boolean->AddInput( 1, vtkBooleanTestBox( cutters[c][0], 2 ) );
+      boolean->AddInput( 1, vtkBooleanTestBox( cutters[c][1], 2 ) );
+      boolean->Update();
+
+      double volume = vtkBooleanTestVolume( boolean->GetOutput() );
+      double area = vtkBooleanTestArea( boolean->GetOutput() );
+      if (fabs( volume - expectedMultiple[c][operation][0] ) > 1e-6 ||
+          fabs( area - expectedMultiple[c][operation][1] ) > 1e-6)
+        {
+        cerr << "Operation " << operation << " on three boxes for case " << c
+             << " gives volume " << volume << " and area " << area
+             << " instead of " << expectedMultiple[c][operation][0]
+             << " and " << expectedMultiple[c][operation][1] << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanCopyCells.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the output of the boolean filter carries the data
+// vtkDataSetAttributes::CopyData() would copy: active scalars of
+// different names are paired by attribute type, and every output point
+// keeps the data of the input point it comes from. Also checks that
+// the output points are numbered in the order the cells use them.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Sets the z coordinate of the points of input as its point scalars and
+// the cell ids as its cell scalars, both under the given name.
+static void TestBooleanCopyCellsAddScalars(vtkPolyData *input,
+                                           const char *name)
+{
+  vtkSmartPointer<vtkFloatArray> pointScalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  pointScalars->SetName( name );
+  pointScalars->SetNumberOfTuples( input->GetNumberOfPoints() );
+  for (vtkIdType i = 0; i < input->GetNumberOfPoints(); i++)
+    {
+    pointScalars->SetValue( i, static_cast<float>( input->GetPoint( i )[2] ) );
+    }
+  input->GetPointData()->SetScalars( pointScalars );
+
+  vtkSmartPointer<vtkFloatArray> cellScalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  cellScalars->SetName( name );
+  cellScalars->SetNumberOfTuples( input->GetNumberOfCells() );
+  for (vtkIdType i = 0; i < input->GetNumberOfCells(); i++)
+    {
+    cellScalars->SetValue( i, static_cast<float>( i ) );
+    }
+  input->GetCellData()->SetScalars( cellScalars );
+}
+
+//-----------------------------------------------------------------------------
+int TestBooleanCopyCells(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input0 =
+    vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 24 );
+  vtkSmartPointer<vtkPolyData> input1 =
+    vtkBooleanTestSphere( 0.2, 0.05, 0.0, 0.45, 20 );
+  TestBooleanCopyCellsAddScalars( input0, "Height0" );
+  TestBooleanCopyCellsAddScalars( input1, "Height1" );
+
+  for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+       operation <= vtkBooleanOperationPolyDataFilter::INTERSECTION;
+       operation++)
+    {
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+    boolean->SetOperation( operation );
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+    if (!boolean->ComputeBoolean( input0, input1, output, lines ) ||
+        output->GetNumberOfCells() == 0)
+      {
+      cerr << "Operation " << operation << " failed" << endl;
+      return EXIT_FAILURE;
+      }
+
+    vtkDataArray *pointScalars = output->GetPointData()->GetScalars();
+    vtkDataArray *cellScalars = output->GetCellData()->GetScalars();
+    if (pointScalars == NULL ||
+        pointScalars->GetNumberOfTuples() != output->GetNumberOfPoints() ||
+        cellScalars == NULL ||
+        cellScalars->GetNumberOfTuples() != output->GetNumberOfCells())
+      {
+      cerr << "Scalars were not copied for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+
+    // The scalars are linear in the coordinates, so the points made by
+    // the split keep them up to round-off too.
+    for (vtkIdType i = 0; i < output->GetNumberOfPoints(); i++)
+      {
+      if (fabs( pointScalars->GetTuple1( i ) - output->GetPoint( i )[2] ) >
+          1e-5)
+        {
+        cerr << "Point " << i << " has the scalar of another point for "
+             << "operation " << operation << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // Neither operation reverses cells, so the points first met when
+    // walking the cells in order must be numbered 0, 1, 2, ...
+    vtkIdType nextPtId = 0;
+    vtkIdType npts, *pts;
+    vtkCellArray *polys = output->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); )
+      {
+      for (vtkIdType j = 0; j < npts; j++)
+        {
+        if (pts[j] == nextPtId)
+          {
+          nextPtId++;
+          }
+        else if (pts[j] > nextPtId)
+          {
+          cerr << "Point " << pts[j] << " is used before point " << nextPtId
+               << " for operation " << operation << endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    if (nextPtId != output->GetNumberOfPoints())
+      {
+      cerr << "Some output points are not used for operation " << operation
+           << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanMultipleOperands.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that applying the operation to three overlapping spheres at
+// once encloses the same volume as a chain of binary filters, that the
+// surfaces meeting along a seam are split at the same points, and that
+// region growing is rejected with more than two surfaces.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkIntArray.h>
+#include <vtkPointData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Returns whether each point of lines found in output comes from at
+// least two surfaces, according to the "PointSource" array.
+static bool TestBooleanMultipleOperandsSharedSeams(vtkPolyData *output,
+                                                   vtkPolyData *lines)
+{
+  vtkIntArray *sources = vtkIntArray::SafeDownCast
+    ( output->GetPointData()->GetArray( "PointSource" ) );
+  if (sources == NULL)
+    {
+    cerr << "No PointSource array" << endl;
+    return false;
+    }
+
+  vtkIdType numShared = 0;
+  for (vtkIdType i = 0; i < lines->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    lines->GetPoint( i, x );
+    int firstSource = -1;
+    bool found = false, shared = false;
+    for (vtkIdType j = 0; !shared && j < output->GetNumberOfPoints(); j++)
+      {
+      if (vtkMath::Distance2BetweenPoints( x, output->GetPoint( j ) ) > 1e-12)
+        {
+        continue;
+        }
+      if (!found)
+        {
+        firstSource = sources->GetValue( j );
+        found = true;
+        }
+      shared = sources->GetValue( j ) != firstSource;
+      }
+    if (found && !shared)
+      {
+      cerr << "Seam point " << i << " is only in surface " << firstSource
+           << endl;
+      return false;
+      }
+    numShared += shared;
+    }
+
+  if (numShared == 0)
+    {
+    cerr << "No seam points in the output" << endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestBooleanMultipleOperands(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> spheres[3];
+  spheres[0] = vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 30 );
+  spheres[1] = vtkBooleanTestSphere( 0.2, 0.05, 0.02, 0.45, 28 );
+  spheres[2] = vtkBooleanTestSphere( 0.0, 0.3, -0.05, 0.4, 26 );
+
+  for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+       operation <= vtkBooleanOperationPolyDataFilter::DIFFERENCE; operation++)
+    {
+    // Chain of binary filters.
+    vtkSmartPointer<vtkPolyData> expected = spheres[0];
+    for (int i = 1; i < 3; i++)
+      {
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter> binary =
+        vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+      binary->SetOperation( operation );
+      vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+      if (!binary->ComputeBoolean( expected, spheres[i], output, lines ))
+        {
+        cerr << "Binary operation " << operation << " failed" << endl;
+        return EXIT_FAILURE;
+        }
+      expected = output;
+      }
+
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+    boolean->SetOperation( operation );
+    boolean->SetInput( 0, spheres[0] );
+    boolean->AddInput( 1, spheres[1] );
+    boolean->AddInput( 1, spheres[2] );
+    boolean->Update();
+    vtkPolyData *output = boolean->GetOutput( 0 );
+    vtkPolyData *lines = boolean->GetOutput( 1 );
+
+    // The seams are cut differently, so only the enclosed volume and
+    // the area are compared.
+    double expectedVolume = vtkBooleanTestVolume( expected );
+    double expectedArea = vtkBooleanTestArea( expected );
+    if (output->GetNumberOfCells() == 0 ||
+        fabs( vtkBooleanTestVolume( output ) - expectedVolume ) >
+        0.01 * fabs( expectedVolume ) ||
+        fabs( vtkBooleanTestArea( output ) - expectedArea ) >
+        0.01 * expectedArea)
+      {
+      cerr << "Operation " << operation << " encloses volume "
+           << vtkBooleanTestVolume( output ) << " and area "
+           << vtkBooleanTestArea( output ) << " instead of " << expectedVolume
+           << " and " << expectedArea << endl;
+      return EXIT_FAILURE;
+      }
+
+    if (!TestBooleanMultipleOperandsSharedSeams( output, lines ))
+      {
+      cerr << "Seams are not shared for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkSmartPointer<vtkBooleanOperationPolyDataFilter> growing =
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+  growing->SetClassificationModeToRegionGrowing();
+  growing->SetInput( 0, spheres[0] );
+  growing->AddInput( 1, spheres[1] );
+  growing->AddInput( 1, spheres[2] );
+  vtkObject::GlobalWarningDisplayOff();
+  growing->Update();
+  vtkObject::GlobalWarningDisplayOn();
+  if (growing->GetOutput( 0 )->GetNumberOfCells() != 0)
+    {
+    cerr << "Region growing was accepted with three surfaces" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanPipelineChain.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the boolean filter, which runs its intersection and
+// distance stages directly on one working mesh per input, gives the
+// same result as a pipeline of vtkIntersectionPolyDataFilter and
+// vtkDistancePolyDataFilter whose outputs are sorted by the sign of
+// the cell distances. Also checks that running the filter through the
+// pipeline and calling ComputeBoolean() give identical outputs.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkCellData.h>
+#include <vtkDistancePolyDataFilter.h>
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Appends to polys the cells of input whose distance is above the
+// tolerance if outside is true, or not above it otherwise, numbering
+// their points from offset and reversing them if reverse is true.
+static void TestBooleanPipelineChainSelect(vtkPolyData *input, bool outside,
+                                           bool reverse, vtkIdType offset,
+                                           vtkPoints *points,
+                                           vtkCellArray *polys)
+{
+  vtkDataArray *distances = input->GetCellData()->GetArray( "Distance" );
+  for (vtkIdType ptId = 0; ptId < input->GetNumberOfPoints(); ptId++)
+    {
+    points->InsertNextPoint( input->GetPoint( ptId ) );
+    }
+  vtkIdType npts, *pts;
+  for (vtkIdType cellId = 0; cellId < input->GetNumberOfCells(); cellId++)
+    {
+    if ((distances->GetTuple1( cellId ) > 1e-6) != outside)
+      {
+      continue;
+      }
+    input->GetCellPoints( cellId, npts, pts );
+    polys->InsertNextCell( npts );
+    for (vtkIdType j = 0; j < npts; j++)
+      {
+      polys->InsertCellPoint( offset + pts[reverse ? npts - 1 - j : j] );
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+int TestBooleanPipelineChain(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input0 =
+    vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 28 );
+  vtkSmartPointer<vtkPolyData> input1 =
+    vtkBooleanTestSphere( 0.2, 0.05, 0.03, 0.45, 22 );
+
+  vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+    vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+  intersection->SetInput( 0, input0 );
+  intersection->SetInput( 1, input1 );
+  vtkSmartPointer<vtkDistancePolyDataFilter> distance =
+    vtkSmartPointer<vtkDistancePolyDataFilter>::New();
+  distance->SetInputConnection( 0, intersection->GetOutputPort( 1 ) );
+  distance->SetInputConnection( 1, intersection->GetOutputPort( 2 ) );
+  distance->ComputeSecondDistanceOn();
+  distance->Update();
+  vtkPolyData *split0 = distance->GetOutput();
+  vtkPolyData *split1 = distance->GetSecondDistanceOutput();
+
+  for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+       operation <= vtkBooleanOperationPolyDataFilter::INTERSECTION;
+       operation++)
+    {
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter> piped =
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+    piped->SetOperation( operation );
+    piped->SetInput( 0, input0 );
+    piped->SetInput( 1, input1 );
+    piped->Update();
+
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter> direct =
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+    direct->SetOperation( operation );
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+    if (!direct->ComputeBoolean( input0, input1, output, lines ))
+      {
+      cerr << "ComputeBoolean() failed for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+    if (!vtkBooleanTestSamePolyData( piped->GetOutput( 0 ), output, 0.0 ) ||
+        !vtkBooleanTestSamePolyData( piped->GetOutput( 1 ), lines, 0.0 ))
+      {
+      cerr << "The pipeline and ComputeBoolean() differ for operation "
+           << operation << endl;
+      return EXIT_FAILURE;
+      }
+    if (!vtkBooleanTestSamePolyData( intersection->GetOutput( 0 ), lines,
+                                     0.0 ))
+      {
+      cerr << "The intersection lines differ from those of the intersection "
+           << "filter for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+
+    // A union keeps the outside of both surfaces, an intersection the
+    // inside of both, and a difference the outside of the first and
+    // the reversed inside of the second.
+    bool outside0 = operation != vtkBooleanOperationPolyDataFilter::INTERSECTION;
+    bool outside1 = operation == vtkBooleanOperationPolyDataFilter::UNION;
+    bool reverse1 = operation == vtkBooleanOperationPolyDataFilter::DIFFERENCE;
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToDouble();
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    TestBooleanPipelineChainSelect( split0, outside0, false, 0, points, polys );
+    TestBooleanPipelineChainSelect( split1, outside1, reverse1,
+                                    split0->GetNumberOfPoints(), points, polys );
+    vtkSmartPointer<vtkPolyData> expected = vtkSmartPointer<vtkPolyData>::New();
+    expected->SetPoints( points );
+    expected->SetPolys( polys );
+    if (!vtkBooleanTestSameSurface( expected, output, 1e-9 ))
+      {
+      cerr << "Operation " << operation << " differs from the pipeline of "
+           << "the intersection and distance filters" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
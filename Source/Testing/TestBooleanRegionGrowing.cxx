@@ -0,0 +1,66 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanRegionGrowing.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that classifying the cells by region growing keeps the same
+// cells as classifying every cell by its distance, for each operation.
+// The first input has a component away from the cut, so some regions
+// are decided by their seed cell alone.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestBooleanRegionGrowing(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input0 = vtkBooleanTestAppend
+    ( vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 30 ),
+      vtkBooleanTestSphere( 3.0, 0.0, 0.0, 0.5, 12 ) );
+  vtkSmartPointer<vtkPolyData> input1 =
+    vtkBooleanTestSphere( 0.2, 0.05, 0.0, 0.45, 26 );
+
+  for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+       operation <= vtkBooleanOperationPolyDataFilter::DIFFERENCE; operation++)
+    {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int mode = 0; mode < 2; mode++)
+      {
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+        vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+      boolean->SetOperation( operation );
+      if (mode == 1)
+        {
+        boolean->SetClassificationModeToRegionGrowing();
+        boolean->SetNumberOfThreads( 4 );
+        }
+
+      outputs[mode] = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+      if (!boolean->ComputeBoolean( input0, input1, outputs[mode], lines ))
+        {
+        cerr << "Operation " << operation << " failed" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    if (outputs[0]->GetNumberOfCells() == 0 ||
+        !vtkBooleanTestSamePolyData( outputs[0], outputs[1], 0.0 ))
+      {
+      cerr << "Region growing differs from the distance classification "
+           << "for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBooleanWindingNumber.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the threaded vtkImplicitWindingNumber::FunctionValue()
+// matches one evaluation per point, and that classifying the cells by
+// winding number keeps the same cells as classifying them by distance.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkDoubleArray.h>
+#include <vtkImplicitWindingNumber.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestBooleanWindingNumber(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input0 =
+    vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 30 );
+  vtkSmartPointer<vtkPolyData> input1 =
+    vtkBooleanTestSphere( 0.2, 0.05, 0.0, 0.45, 26 );
+
+  vtkSmartPointer<vtkImplicitWindingNumber> winding =
+    vtkSmartPointer<vtkImplicitWindingNumber>::New();
+  winding->SetNumberOfThreads( 4 );
+  winding->SetInput( input0 );
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 2000, 1.0, 4099 );
+  vtkSmartPointer<vtkDoubleArray> values =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  winding->FunctionValue( points->GetData(), values );
+  for (vtkIdType ptId = 0; ptId < points->GetNumberOfPoints(); ptId++)
+    {
+    double x[3];
+    points->GetPoint( ptId, x );
+    if (values->GetValue( ptId ) != winding->EvaluateFunction( x ))
+      {
+      cerr << "Point " << ptId << " differs from EvaluateFunction()" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  for (int operation = vtkBooleanOperationPolyDataFilter::UNION;
+       operation <= vtkBooleanOperationPolyDataFilter::DIFFERENCE; operation++)
+    {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int mode = 0; mode < 2; mode++)
+      {
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+        vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+      boolean->SetOperation( operation );
+      if (mode == 1)
+        {
+        boolean->SetClassificationModeToWindingNumber();
+        boolean->SetNumberOfThreads( 4 );
+        }
+
+      outputs[mode] = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+      if (!boolean->ComputeBoolean( input0, input1, outputs[mode], lines ))
+        {
+        cerr << "Operation " << operation << " failed" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    if (outputs[0]->GetNumberOfCells() == 0 ||
+        !vtkBooleanTestSamePolyData( outputs[0], outputs[1], 0.0 ))
+      {
+      cerr << "The winding number classification differs from the "
+           << "distance classification for operation " << operation << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCSGTreeThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that evaluating a tree whose leaves share surfaces with
+// several threads gives the same surface as evaluating it with one, and
+// leaves the surfaces of the leaves untouched.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkCSGTreePolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+int TestCSGTreeThreads(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> spheres[5];
+  spheres[0] = vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 24 );
+  spheres[1] = vtkBooleanTestSphere( 0.2, 0.05, 0.0, 0.45, 22 );
+  spheres[2] = vtkBooleanTestSphere( 0.0, 0.3, 0.05, 0.4, 20 );
+  spheres[3] = vtkBooleanTestSphere( 0.4, -0.2, 0.1, 0.35, 20 );
+  spheres[4] = vtkBooleanTestSphere( 3.0, 0.0, 0.0, 0.5, 12 );
+  vtkPoints *points[5];
+  for (int i = 0; i < 5; i++)
+    {
+    points[i] = spheres[i]->GetPoints();
+    }
+
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  for (int threaded = 0; threaded < 2; threaded++)
+    {
+    // The first two spheres are the surfaces of several leaves.
+    vtkSmartPointer<vtkCSGTreePolyDataFilter> tree =
+      vtkSmartPointer<vtkCSGTreePolyDataFilter>::New();
+    int leaves[7];
+    for (int i = 0; i < 5; i++)
+      {
+      leaves[i] = tree->AddLeaf( spheres[i] );
+      }
+    leaves[5] = tree->AddLeaf( spheres[0] );
+    leaves[6] = tree->AddLeaf( spheres[1] );
+
+    int difference = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::DIFFERENCE, leaves[0], leaves[1] );
+    int intersection = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::INTERSECTION, leaves[2], leaves[5] );
+    int unionNode = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::UNION, leaves[3], leaves[6] );
+    int root = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::UNION, difference, intersection );
+    root = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::UNION, root, unionNode );
+    root = tree->AddOperation
+      ( vtkBooleanOperationPolyDataFilter::UNION, root, leaves[4] );
+    tree->SetRoot( root );
+    tree->SetNumberOfThreads( threaded ? 4 : 1 );
+    tree->Update();
+
+    outputs[threaded] = vtkSmartPointer<vtkPolyData>::New();
+    outputs[threaded]->DeepCopy( tree->GetOutput() );
+    }
+
+  if (outputs[0]->GetNumberOfCells() == 0 ||
+      !vtkBooleanTestSamePolyData( outputs[0], outputs[1], 0.0 ))
+    {
+    cerr << "The threaded tree differs from the serial one" << endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 0; i < 5; i++)
+    {
+    if (spheres[i]->GetPoints() != points[i])
+      {
+      cerr << "The surface of leaf " << i << " was changed" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
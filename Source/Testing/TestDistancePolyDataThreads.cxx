@@ -0,0 +1,95 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDistancePolyDataThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkDistancePolyDataFilter gives the same point and cell
+// distances on both meshes with several threads as with one, and that
+// the batched point distances match vtkImplicitPolyData evaluated one
+// point at a time.
+
+#include <vtkCellData.h>
+#include <vtkDistancePolyDataFilter.h>
+#include <vtkImplicitPolyData.h>
+#include <vtkPointData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestDistancePolyDataThreads(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere0 =
+    vtkBooleanTestSphere( -0.2, 0.0, 0.0, 0.5, 36 );
+  vtkSmartPointer<vtkPolyData> sphere1 =
+    vtkBooleanTestSphere( 0.2, 0.1, 0.0, 0.4, 28 );
+
+  vtkSmartPointer<vtkPolyData> serial[2];
+  for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+    vtkSmartPointer<vtkPolyData> meshes[2];
+    meshes[0] = vtkSmartPointer<vtkPolyData>::New();
+    meshes[0]->DeepCopy( sphere0 );
+    meshes[1] = vtkSmartPointer<vtkPolyData>::New();
+    meshes[1]->DeepCopy( sphere1 );
+
+    vtkSmartPointer<vtkDistancePolyDataFilter> distance =
+      vtkSmartPointer<vtkDistancePolyDataFilter>::New();
+    distance->SetNumberOfThreads( numThreads );
+    distance->GetPolyDataDistances( meshes[0], sphere1, meshes[1], sphere0 );
+
+    for (int i = 0; i < 2; i++)
+      {
+      vtkDataArray *pointDist =
+        meshes[i]->GetPointData()->GetArray( "Distance" );
+      vtkDataArray *cellDist = meshes[i]->GetCellData()->GetArray( "Distance" );
+      if (pointDist == NULL || cellDist == NULL ||
+          pointDist->GetNumberOfTuples() != meshes[i]->GetNumberOfPoints() ||
+          cellDist->GetNumberOfTuples() != meshes[i]->GetNumberOfCells())
+        {
+        cerr << "Missing distances on mesh " << i << " with " << numThreads
+             << " threads" << endl;
+        return EXIT_FAILURE;
+        }
+      if (numThreads == 1)
+        {
+        vtkSmartPointer<vtkImplicitPolyData> implicit =
+          vtkSmartPointer<vtkImplicitPolyData>::New();
+        implicit->SetInput( i == 0 ? sphere1 : sphere0 );
+        for (vtkIdType ptId = 0; ptId < meshes[i]->GetNumberOfPoints(); ptId++)
+          {
+          double x[3];
+          meshes[i]->GetPoint( ptId, x );
+          if (fabs( implicit->EvaluateFunction( x ) -
+                    pointDist->GetTuple1( ptId ) ) > 1e-12)
+            {
+            cerr << "Distance of point " << ptId << " of mesh " << i
+                 << " differs from EvaluateFunction()" << endl;
+            return EXIT_FAILURE;
+            }
+          }
+        serial[i] = meshes[i];
+        continue;
+        }
+
+      if (!vtkBooleanTestSameArray
+          ( serial[i]->GetPointData()->GetArray( "Distance" ), pointDist, 0.0 ) ||
+          !vtkBooleanTestSameArray
+          ( serial[i]->GetCellData()->GetArray( "Distance" ), cellDist, 0.0 ))
+        {
+        cerr << "Distances on mesh " << i << " with " << numThreads
+             << " threads differ from the serial ones" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImplicitPolyDataDistance.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the distances and gradients evaluated by
+// vtkImplicitPolyData, which reuses its scratch objects from one
+// evaluation to the next, match the closest cells found by visiting
+// every cell with a vtkGenericCell of its own.
+
+#include <vtkGenericCell.h>
+#include <vtkImplicitPolyData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestImplicitPolyDataDistance(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.05, -0.1, 0.0, 0.5, 20 );
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 1000, 1.0, 4421 );
+
+  vtkSmartPointer<vtkImplicitPolyData> imp =
+    vtkSmartPointer<vtkImplicitPolyData>::New();
+  imp->SetInput( sphere );
+
+  vtkSmartPointer<vtkGenericCell> cell =
+    vtkSmartPointer<vtkGenericCell>::New();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    points->GetPoint( i, x );
+
+    double minDist2 = VTK_DOUBLE_MAX, closest[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType cid = 0; cid < sphere->GetNumberOfCells(); cid++)
+      {
+      double cellClosest[3], pcoords[3], weights[3], dist2;
+      int subId;
+      sphere->GetCell( cid, cell );
+      cell->EvaluatePosition( x, cellClosest, subId, pcoords, dist2,
+                              weights );
+      if (dist2 < minDist2)
+        {
+        minDist2 = dist2;
+        std::copy( cellClosest, cellClosest + 3, closest );
+        }
+      }
+
+    // Evaluated twice, so that the second evaluation runs on the
+    // scratch objects left by the first one.
+    for (int repeat = 0; repeat < 2; repeat++)
+      {
+      double value = imp->EvaluateFunction( x );
+      if (fabs( fabs( value ) - sqrt( minDist2 ) ) > 1e-9)
+        {
+        cerr << "Point " << i << " is at distance " << fabs( value )
+             << " instead of " << sqrt( minDist2 ) << endl;
+        return EXIT_FAILURE;
+        }
+
+      // The gradient points away from the closest point, or towards it
+      // inside.
+      double g[3], d[3];
+      imp->EvaluateGradient( x, g );
+      for (int k = 0; k < 3; k++)
+        {
+        d[k] = x[k] - closest[k];
+        }
+      double length = vtkMath::Normalize( d );
+      if (length > 1e-6 &&
+          vtkMath::Dot( g, d ) * (value < 0.0 ? -1.0 : 1.0) < 1.0 - 1e-6)
+        {
+        cerr << "Gradient at point " << i << " does not point away from "
+             << "the closest point" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
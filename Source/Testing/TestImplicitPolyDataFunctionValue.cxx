@@ -0,0 +1,79 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImplicitPolyDataFunctionValue.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the batched vtkImplicitPolyData::FunctionValue() gives
+// the same values as evaluating one point at a time, with and without
+// a transform and into double and float arrays.
+
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImplicitPolyData.h>
+#include <vtkTransform.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestImplicitPolyDataFunctionValue(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.0, 0.1, 0.0, 0.6, 24 );
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 3000, 1.0, 1103 );
+
+  vtkSmartPointer<vtkTransform> transform =
+    vtkSmartPointer<vtkTransform>::New();
+  transform->Translate( 0.2, -0.1, 0.05 );
+  transform->RotateZ( 30.0 );
+
+  for (int useTransform = 0; useTransform < 2; useTransform++)
+    {
+    vtkSmartPointer<vtkImplicitPolyData> imp =
+      vtkSmartPointer<vtkImplicitPolyData>::New();
+    imp->SetNumberOfThreads( 4 );
+    imp->SetInput( sphere );
+    if (useTransform)
+      {
+      imp->SetTransform( transform );
+      }
+
+    vtkSmartPointer<vtkDoubleArray> values =
+      vtkSmartPointer<vtkDoubleArray>::New();
+    imp->FunctionValue( points->GetData(), values );
+    vtkSmartPointer<vtkFloatArray> floatValues =
+      vtkSmartPointer<vtkFloatArray>::New();
+    imp->FunctionValue( points->GetData(), floatValues );
+
+    if (values->GetNumberOfTuples() != points->GetNumberOfPoints() ||
+        floatValues->GetNumberOfTuples() != points->GetNumberOfPoints())
+      {
+      cerr << "Wrong number of values" << endl;
+      return EXIT_FAILURE;
+      }
+
+    for (vtkIdType ptId = 0; ptId < points->GetNumberOfPoints(); ptId++)
+      {
+      double x[3];
+      points->GetPoint( ptId, x );
+      double expected = imp->FunctionValue( x );
+      if (values->GetValue( ptId ) != expected ||
+          floatValues->GetValue( ptId ) != static_cast<float>(expected))
+        {
+        cerr << "Point " << ptId << " differs from FunctionValue(x)"
+             << (useTransform ? " with a transform" : "") << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
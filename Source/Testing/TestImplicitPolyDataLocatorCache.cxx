@@ -0,0 +1,121 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImplicitPolyDataLocatorCache.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that several threaded vtkImplicitPolyData objects that take
+// the same input from a vtkPolyDataLocatorCache, set it up and evaluate
+// it at the same time give the same distances as an object without a
+// cache, both when the cache entry is built and when it is reused.
+
+#include <vtkDoubleArray.h>
+#include <vtkImplicitPolyData.h>
+#include <vtkMultiThreader.h>
+#include <vtkPolyDataLocatorCache.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+namespace
+{
+const int NumberOfObjects = 4;
+
+struct CacheWork
+{
+  vtkPolyData         *Input;
+  vtkDataArray        *Points;
+  vtkImplicitPolyData *Objects[NumberOfObjects];
+  vtkDoubleArray      *Distances[NumberOfObjects];
+};
+}
+
+//-----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE TestImplicitPolyDataLocatorCacheThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  CacheWork *work = static_cast<CacheWork*>(info->UserData);
+  int threadId = info->ThreadID;
+  if (threadId >= NumberOfObjects)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  work->Objects[threadId]->SetInput( work->Input );
+  work->Objects[threadId]->FunctionValue( work->Points,
+                                          work->Distances[threadId] );
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+int TestImplicitPolyDataLocatorCache(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.1, 0.0, -0.05, 0.5, 32 );
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 3000, 1.0, 9173 );
+
+  vtkSmartPointer<vtkImplicitPolyData> reference =
+    vtkSmartPointer<vtkImplicitPolyData>::New();
+  reference->SetInput( sphere );
+  vtkSmartPointer<vtkDoubleArray> expected =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  expected->SetNumberOfTuples( points->GetNumberOfPoints() );
+  reference->FunctionValue( points->GetData(), expected );
+
+  vtkSmartPointer<vtkPolyDataLocatorCache> cache =
+    vtkSmartPointer<vtkPolyDataLocatorCache>::New();
+  vtkSmartPointer<vtkImplicitPolyData> objects[NumberOfObjects];
+  vtkSmartPointer<vtkDoubleArray> distances[NumberOfObjects];
+  CacheWork work;
+  work.Input = sphere;
+  work.Points = points->GetData();
+  for (int i = 0; i < NumberOfObjects; i++)
+    {
+    objects[i] = vtkSmartPointer<vtkImplicitPolyData>::New();
+    objects[i]->SetLocatorCache( cache );
+    objects[i]->SetNumberOfThreads( 2 );
+    distances[i] = vtkSmartPointer<vtkDoubleArray>::New();
+    distances[i]->SetNumberOfTuples( points->GetNumberOfPoints() );
+    work.Objects[i] = objects[i];
+    work.Distances[i] = distances[i];
+    }
+
+  // The first round builds the entry, the second reuses it along with
+  // the locators the first round gave back.
+  for (int round = 0; round < 2; round++)
+    {
+    vtkSmartPointer<vtkMultiThreader> threader =
+      vtkSmartPointer<vtkMultiThreader>::New();
+    threader->SetNumberOfThreads( NumberOfObjects );
+    threader->SetSingleMethod( TestImplicitPolyDataLocatorCacheThread, &work );
+    threader->SingleMethodExecute();
+
+    for (int i = 0; i < NumberOfObjects; i++)
+      {
+      if (!vtkBooleanTestSameArray( expected, distances[i], 0.0 ))
+        {
+        cerr << "Object " << i << " differs from the uncached one in round "
+             << round << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  if (cache->GetNumberOfEntries() != 1)
+    {
+    cerr << "Expected one cache entry, got " << cache->GetNumberOfEntries()
+         << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImplicitPolyDataPseudonormals.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the sign given by the precomputed pseudonormals against the
+// exact inside test of a box, both for random points and for points
+// whose closest point is a corner, an edge or a point in the middle of
+// a face, where the face, edge and vertex pseudonormals are used.
+
+#include <vtkImplicitPolyData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestImplicitPolyDataPseudonormals(int, char *[])
+{
+  const double bounds[6] = { -0.5, 0.5, -0.5, 0.5, -0.5, 0.5 };
+  vtkSmartPointer<vtkPolyData> box = vtkBooleanTestBox( bounds, 2 );
+
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 2000, 1.0, 6607 );
+
+  // The corners, the middles of the edges and the centers of the faces,
+  // moved slightly out of and into the box.
+  for (int i = -1; i <= 1; i++)
+    {
+    for (int j = -1; j <= 1; j++)
+      {
+      for (int k = -1; k <= 1; k++)
+        {
+        if (i == 0 && j == 0 && k == 0)
+          {
+          continue;
+          }
+        points->InsertNextPoint( 0.51 * i, 0.51 * j, 0.51 * k );
+        points->InsertNextPoint( 0.49 * i, 0.49 * j, 0.49 * k );
+        }
+      }
+    }
+
+  vtkSmartPointer<vtkImplicitPolyData> imp =
+    vtkSmartPointer<vtkImplicitPolyData>::New();
+  imp->SetInput( box );
+
+  int numTested = 0;
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    points->GetPoint( i, x );
+    double depth = 0.5 - std::max( fabs( x[0] ),
+                                   std::max( fabs( x[1] ), fabs( x[2] ) ) );
+    if (fabs( depth ) < 1e-6)
+      {
+      continue;
+      }
+
+    double value = imp->EvaluateFunction( x );
+    if ((value < 0.0) != (depth > 0.0))
+      {
+      cerr << "Point (" << x[0] << ", " << x[1] << ", " << x[2]
+           << ") has value " << value << " but is "
+           << (depth > 0.0 ? "inside" : "outside") << " the box" << endl;
+      return EXIT_FAILURE;
+      }
+    numTested++;
+    }
+
+  if (numTested < points->GetNumberOfPoints() / 2)
+    {
+    cerr << "Too few points tested" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
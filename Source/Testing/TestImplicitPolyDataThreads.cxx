@@ -0,0 +1,72 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImplicitPolyDataThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that evaluating vtkImplicitPolyData with several threads, and
+// with the per-thread locators that are built on first use, gives the
+// same distances, gradients and closest cells as one thread.
+
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImplicitPolyData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestImplicitPolyDataThreads(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.1, 0.0, -0.05, 0.5, 32 );
+  vtkSmartPointer<vtkPoints> points =
+    vtkBooleanTestRandomPoints( 5000, 1.0, 2357 );
+
+  vtkSmartPointer<vtkDoubleArray> distances[2];
+  vtkSmartPointer<vtkDoubleArray> gradients[2];
+  vtkSmartPointer<vtkIdTypeArray> cellIds[2];
+  for (int i = 0; i < 2; i++)
+    {
+    vtkSmartPointer<vtkImplicitPolyData> imp =
+      vtkSmartPointer<vtkImplicitPolyData>::New();
+    imp->SetNumberOfThreads( i == 0 ? 1 : 4 );
+    imp->SetInput( sphere );
+
+    distances[i] = vtkSmartPointer<vtkDoubleArray>::New();
+    gradients[i] = vtkSmartPointer<vtkDoubleArray>::New();
+    cellIds[i] = vtkSmartPointer<vtkIdTypeArray>::New();
+    imp->EvaluateFunctionAndGradient( points->GetData(), distances[i],
+                                      gradients[i], cellIds[i] );
+
+    // The last thread of the threaded function gets its locator here
+    // if the batch did not need it.
+    for (vtkIdType ptId = 0; ptId < 100; ptId++)
+      {
+      double x[3];
+      points->GetPoint( ptId, x );
+      if (imp->EvaluateFunction( x, imp->GetNumberOfThreads() - 1 ) !=
+          distances[i]->GetValue( ptId ))
+        {
+        cerr << "Point " << ptId << " differs from the batch" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  if (!vtkBooleanTestSameArray( distances[0], distances[1], 0.0 ) ||
+      !vtkBooleanTestSameArray( gradients[0], gradients[1], 0.0 ) ||
+      !vtkBooleanTestSameArray( cellIds[0], cellIds[1], 0.0 ))
+    {
+    cerr << "The threaded evaluation differs from the serial one" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
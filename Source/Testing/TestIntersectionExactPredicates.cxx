@@ -0,0 +1,84 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionExactPredicates.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the exact predicates give the same intersection lines as
+// the floating-point path on spheres in general position, where the
+// two cannot disagree on a sign, and that the split meshes keep the
+// area of the inputs either way.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+static bool TestIntersectionExactPredicatesCompare(vtkPolyData *input0,
+                                                   vtkPolyData *input1)
+{
+  vtkSmartPointer<vtkPolyData> outputs[2][3];
+  for (int exact = 0; exact < 2; exact++)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    intersection->SetExactPredicates( exact );
+    for (int i = 0; i < 3; i++)
+      {
+      outputs[exact][i] = vtkSmartPointer<vtkPolyData>::New();
+      }
+    if (!intersection->ComputeIntersection( input0, input1,
+                                            outputs[exact][0],
+                                            outputs[exact][1],
+                                            outputs[exact][2] ) ||
+        outputs[exact][0]->GetNumberOfLines() == 0)
+      {
+      cerr << "Intersection failed with ExactPredicates " << exact << endl;
+      return false;
+      }
+
+    vtkPolyData *inputs[2] = { input0, input1 };
+    for (int i = 0; i < 2; i++)
+      {
+      double area = vtkBooleanTestArea( inputs[i] );
+      if (fabs( vtkBooleanTestArea( outputs[exact][i+1] ) - area ) >
+          1e-9 * area)
+        {
+        cerr << "Split mesh " << i << " changes the area with "
+             << "ExactPredicates " << exact << endl;
+        return false;
+        }
+      }
+    }
+
+  if (!vtkBooleanTestSameSegments( outputs[0][0], outputs[1][0], 1e-9 ))
+    {
+    cerr << "The exact predicates give other segments" << endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionExactPredicates(int, char *[])
+{
+  if (!TestIntersectionExactPredicatesCompare
+      ( vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 36 ),
+        vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.45, 30 ) ) ||
+      !TestIntersectionExactPredicatesCompare
+      ( vtkBooleanTestSphere( 0.013, -0.021, 0.007, 1.0, 40 ),
+        vtkBooleanTestSphere( 0.71, 0.37, -0.29, 0.6, 25 ) ))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
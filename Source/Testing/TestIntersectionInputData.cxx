@@ -0,0 +1,140 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionInputData.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the intersection filter leaves its inputs untouched now
+// that it works on shallow copies of them, and that the split meshes
+// start with the points and point data of the inputs, as copying them
+// point by point would give. The input carries active scalars and
+// another array with the same name but a different number of
+// components, so arrays matched by name alone would be mixed up.
+
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIntersectionPolyDataFilter.h>
+#include <vtkPointData.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Returns whether the first tuples of output are those of input.
+static bool TestIntersectionInputDataSameTuples(vtkDataArray *input,
+                                                vtkDataArray *output)
+{
+  if (input == NULL || output == NULL ||
+      input->GetNumberOfComponents() != output->GetNumberOfComponents() ||
+      output->GetNumberOfTuples() < input->GetNumberOfTuples())
+    {
+    return false;
+    }
+  for (vtkIdType i = 0; i < input->GetNumberOfTuples(); i++)
+    {
+    for (int k = 0; k < input->GetNumberOfComponents(); k++)
+      {
+      if (input->GetComponent( i, k ) != output->GetComponent( i, k ))
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionInputData(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> inputs[2];
+  inputs[0] = vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 30 );
+  inputs[1] = vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.45, 26 );
+
+  // A non-attribute array first, so that a lookup by name finds it
+  // for the scalars.
+  vtkIdType numPoints = inputs[0]->GetNumberOfPoints();
+  vtkSmartPointer<vtkDoubleArray> positions =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  positions->SetName( "Height" );
+  positions->SetNumberOfComponents( 3 );
+  positions->SetNumberOfTuples( numPoints );
+  vtkSmartPointer<vtkFloatArray> heights =
+    vtkSmartPointer<vtkFloatArray>::New();
+  heights->SetName( "Height" );
+  heights->SetNumberOfTuples( numPoints );
+  for (vtkIdType i = 0; i < numPoints; i++)
+    {
+    double x[3];
+    inputs[0]->GetPoint( i, x );
+    positions->SetTuple( i, x );
+    heights->SetValue( i, static_cast<float>( x[2] ) );
+    }
+  inputs[0]->GetPointData()->AddArray( positions );
+  inputs[0]->GetPointData()->SetScalars( heights );
+
+  vtkPoints *points[2];
+  unsigned long mtimes[2];
+  for (int i = 0; i < 2; i++)
+    {
+    points[i] = inputs[i]->GetPoints();
+    mtimes[i] = inputs[i]->GetMTime();
+    }
+
+  vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+    vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+  vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  outputs[0] = vtkSmartPointer<vtkPolyData>::New();
+  outputs[1] = vtkSmartPointer<vtkPolyData>::New();
+  if (!intersection->ComputeIntersection( inputs[0], inputs[1], lines,
+                                          outputs[0], outputs[1] ) ||
+      lines->GetNumberOfLines() == 0)
+    {
+    cerr << "Intersection failed" << endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 0; i < 2; i++)
+    {
+    if (inputs[i]->GetPoints() != points[i] ||
+        inputs[i]->GetMTime() != mtimes[i])
+      {
+      cerr << "Input " << i << " was modified" << endl;
+      return EXIT_FAILURE;
+      }
+    if (!TestIntersectionInputDataSameTuples( inputs[i]->GetPoints()->GetData(),
+                                              outputs[i]->GetPoints()->GetData() ))
+      {
+      cerr << "Split mesh " << i << " does not start with the input points"
+           << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkPointData *outPD = outputs[0]->GetPointData();
+  vtkDataArray *outPositions = NULL;
+  for (int i = 0; i < outPD->GetNumberOfArrays(); i++)
+    {
+    if (outPD->IsArrayAnAttribute( i ) < 0 &&
+        outPD->GetArray( i )->GetNumberOfComponents() == 3)
+      {
+      outPositions = outPD->GetArray( i );
+      }
+    }
+  if (!TestIntersectionInputDataSameTuples( heights, outPD->GetScalars() ) ||
+      !TestIntersectionInputDataSameTuples( positions, outPositions ))
+    {
+    cerr << "The point data of the split mesh differs from the input"
+         << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionParallelTraversal.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the threaded OBB tree traversal gives the same
+// intersection lines and split meshes as the serial one, also for
+// surfaces far from the origin.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Compares the outputs with 2, 4 and 8 threads to the serial ones for
+// spheres centered around the given point.
+static bool TestIntersectionParallelTraversalAt(double x, double radius)
+{
+  vtkSmartPointer<vtkPolyData> sphere0 =
+    vtkBooleanTestSphere( x - 0.3*radius, 0.0, 0.0, radius, 48 );
+  vtkSmartPointer<vtkPolyData> sphere1 =
+    vtkBooleanTestSphere( x + 0.3*radius, 0.1*radius, 0.04*radius, radius,
+                          40 );
+
+  vtkSmartPointer<vtkPolyData> serial[3];
+  for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    intersection->SetNumberOfThreads( numThreads );
+
+    vtkSmartPointer<vtkPolyData> outputs[3];
+    for (int i = 0; i < 3; i++)
+      {
+      outputs[i] = vtkSmartPointer<vtkPolyData>::New();
+      }
+    if (!intersection->ComputeIntersection( sphere0, sphere1, outputs[0],
+                                            outputs[1], outputs[2] ))
+      {
+      cerr << "Intersection failed with " << numThreads << " threads" << endl;
+      return false;
+      }
+
+    if (numThreads == 1)
+      {
+      if (outputs[0]->GetNumberOfLines() == 0)
+        {
+        cerr << "The spheres do not intersect" << endl;
+        return false;
+        }
+      for (int i = 0; i < 3; i++)
+        {
+        serial[i] = outputs[i];
+        }
+      continue;
+      }
+
+    for (int i = 0; i < 3; i++)
+      {
+      if (!vtkBooleanTestSamePolyData( serial[i], outputs[i], 0.0 ))
+        {
+        cerr << "Output " << i << " with " << numThreads
+             << " threads differs from the serial one" << endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionParallelTraversal(int, char *[])
+{
+  // The spheres far from the origin have coordinates that, divided by
+  // the merge tolerance, do not fit in the welding bin indices.
+  double centers[3] = { 0.0, 1e14, -1e14 };
+  double radii[3] = { 0.5, 1e12, 1e12 };
+  for (int i = 0; i < 3; i++)
+    {
+    if (!TestIntersectionParallelTraversalAt( centers[i], radii[i] ))
+      {
+      cerr << "Spheres around x = " << centers[i] << " failed" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionPolylines.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the polylines emitted with OutputPolylines on are made of
+// the segments emitted with it off, that the split outputs do not
+// change, and that the LoopId, Closed and ArcLength cell data describe
+// the two closed curves along which a sphere cuts a pair of spheres.
+
+#include <vtkCellData.h>
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+#include <set>
+
+//-----------------------------------------------------------------------------
+// Returns the lines of input with the segments collapsed to a point
+// left out, as the polylines leave them out.
+static vtkSmartPointer<vtkPolyData>
+TestIntersectionPolylinesSegments(vtkPolyData *input)
+{
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType npts, *pts;
+  vtkCellArray *inLines = input->GetLines();
+  for (inLines->InitTraversal(); inLines->GetNextCell( npts, pts ); )
+    {
+    if (npts != 2 || pts[0] != pts[1])
+      {
+      lines->InsertNextCell( npts, pts );
+      }
+    }
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints( input->GetPoints() );
+  output->SetLines( lines );
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionPolylines(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> pair = vtkBooleanTestAppend
+    ( vtkBooleanTestSphere( -0.6, 0.0, 0.0, 0.4, 24 ),
+      vtkBooleanTestSphere( 0.6, 0.02, 0.0, 0.4, 24 ) );
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.0, 0.0, 0.03, 0.5, 30 );
+
+  vtkSmartPointer<vtkPolyData> outputs[2][3];
+  for (int polylines = 0; polylines < 2; polylines++)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    intersection->SetOutputPolylines( polylines );
+    for (int i = 0; i < 3; i++)
+      {
+      outputs[polylines][i] = vtkSmartPointer<vtkPolyData>::New();
+      }
+    if (!intersection->ComputeIntersection( pair, sphere,
+                                            outputs[polylines][0],
+                                            outputs[polylines][1],
+                                            outputs[polylines][2] ))
+      {
+      cerr << "Intersection failed" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  if (!vtkBooleanTestSameSegments
+      ( TestIntersectionPolylinesSegments( outputs[0][0] ), outputs[1][0],
+        1e-9 ))
+    {
+    cerr << "The polylines are not made of the same segments" << endl;
+    return EXIT_FAILURE;
+    }
+  for (int i = 1; i < 3; i++)
+    {
+    if (!vtkBooleanTestSamePolyData( outputs[0][i], outputs[1][i], 0.0 ))
+      {
+      cerr << "Split mesh " << i - 1 << " depends on OutputPolylines"
+           << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkPolyData *lines = outputs[1][0];
+  vtkCellData *cellData = lines->GetCellData();
+  vtkDataArray *loopIds = cellData->GetArray( "LoopId" );
+  vtkDataArray *closed = cellData->GetArray( "Closed" );
+  vtkDataArray *arcLengths = cellData->GetArray( "ArcLength" );
+  if (loopIds == NULL || closed == NULL || arcLengths == NULL ||
+      cellData->GetArray( "Input0CellID" ) != NULL)
+    {
+    cerr << "Wrong cell data on the polylines" << endl;
+    return EXIT_FAILURE;
+    }
+
+  std::set<vtkIdType> loops;
+  vtkIdType npts, *pts;
+  vtkIdType cellId = 0;
+  vtkCellArray *cells = lines->GetLines();
+  for (cells->InitTraversal(); cells->GetNextCell( npts, pts ); cellId++)
+    {
+    double arcLength = 0.0;
+    for (vtkIdType j = 0; j + 1 < npts; j++)
+      {
+      arcLength += sqrt( vtkMath::Distance2BetweenPoints
+                         ( lines->GetPoint( pts[j] ),
+                           lines->GetPoint( pts[j+1] ) ) );
+      }
+    bool isClosed = npts > 2 && pts[0] == pts[npts-1];
+    if (fabs( arcLength - arcLengths->GetTuple1( cellId ) ) > 1e-12 ||
+        (closed->GetTuple1( cellId ) != 0) != isClosed || !isClosed)
+      {
+      cerr << "Polyline " << cellId << " has wrong Closed or ArcLength data"
+           << endl;
+      return EXIT_FAILURE;
+      }
+    loops.insert( static_cast<vtkIdType>( loopIds->GetTuple1( cellId ) ) );
+    }
+  if (lines->GetNumberOfLines() != 2 || loops.size() != 2)
+    {
+    cerr << "Expected two closed curves, got " << lines->GetNumberOfLines()
+         << " polylines in " << loops.size() << " loops" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
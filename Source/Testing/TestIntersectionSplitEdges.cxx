@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionSplitEdges.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the split meshes cover the same area as the inputs and
+// that every segment of the intersection lines is an edge of both
+// split meshes, so that no cell crossed by a line, and no line found
+// for a cell, is missed by the maps from cells to lines and from
+// points to edges.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+#include <set>
+#include <utility>
+
+//-----------------------------------------------------------------------------
+// Returns whether each segment of lines joins two points of split that
+// are joined by an edge of a polygon of split.
+static bool TestIntersectionSplitEdgesEmbedded(vtkPolyData *lines,
+                                               vtkPolyData *split,
+                                               vtkIdType firstSplitPtId)
+{
+  // The points of the lines are among the points added by the split.
+  std::vector<vtkIdType> splitIds( lines->GetNumberOfPoints(), -1 );
+  for (vtkIdType i = 0; i < lines->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    lines->GetPoint( i, x );
+    for (vtkIdType j = firstSplitPtId;
+         j < split->GetNumberOfPoints() && splitIds[i] < 0; j++)
+      {
+      if (vtkMath::Distance2BetweenPoints( x, split->GetPoint( j ) ) <= 1e-12)
+        {
+        splitIds[i] = j;
+        }
+      }
+    if (splitIds[i] < 0)
+      {
+      cerr << "Line point " << i << " is not in the split mesh" << endl;
+      return false;
+      }
+    }
+
+  std::set< std::pair<vtkIdType, vtkIdType> > edges;
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = split->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); )
+    {
+    for (vtkIdType j = 0; j < npts; j++)
+      {
+      vtkIdType a = pts[j], b = pts[(j + 1) % npts];
+      edges.insert( std::make_pair( std::min( a, b ), std::max( a, b ) ) );
+      }
+    }
+
+  vtkCellArray *cells = lines->GetLines();
+  vtkIdType lineId = 0;
+  for (cells->InitTraversal(); cells->GetNextCell( npts, pts ); lineId++)
+    {
+    for (vtkIdType j = 0; j + 1 < npts; j++)
+      {
+      vtkIdType a = splitIds[pts[j]], b = splitIds[pts[j+1]];
+      if (a != b &&
+          !edges.count( std::make_pair( std::min( a, b ), std::max( a, b ) ) ))
+        {
+        cerr << "Segment " << j << " of line " << lineId
+             << " is not an edge of the split mesh" << endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionSplitEdges(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> inputs[2];
+  inputs[0] = vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 36 );
+  inputs[1] = vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.45, 30 );
+
+  vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+    vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+  vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  outputs[0] = vtkSmartPointer<vtkPolyData>::New();
+  outputs[1] = vtkSmartPointer<vtkPolyData>::New();
+  if (!intersection->ComputeIntersection( inputs[0], inputs[1], lines,
+                                          outputs[0], outputs[1] ) ||
+      lines->GetNumberOfLines() == 0)
+    {
+    cerr << "Intersection failed" << endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 0; i < 2; i++)
+    {
+    double inputArea = vtkBooleanTestArea( inputs[i] );
+    double splitArea = vtkBooleanTestArea( outputs[i] );
+    if (fabs( inputArea - splitArea ) > 1e-9 * inputArea)
+      {
+      cerr << "Split mesh " << i << " has area " << splitArea
+           << " instead of " << inputArea << endl;
+      return EXIT_FAILURE;
+      }
+    if (!TestIntersectionSplitEdgesEmbedded
+        ( lines, outputs[i], intersection->GetFirstSplitPointId( i ) ))
+      {
+      cerr << "The lines are not embedded in split mesh " << i << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
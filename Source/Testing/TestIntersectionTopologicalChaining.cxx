@@ -0,0 +1,102 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionTopologicalChaining.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that joining the segments by the mesh features their
+// endpoints lie on gives the same intersection lines as joining them
+// by distance, without duplicate points, also where the lines pass
+// through vertices of one of the meshes.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Returns whether two points of lines are within tolerance.
+static bool TestIntersectionTopologicalChainingHasDuplicates(
+  vtkPolyData *lines, double tolerance)
+{
+  for (vtkIdType i = 0; i < lines->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    lines->GetPoint( i, x );
+    for (vtkIdType j = i + 1; j < lines->GetNumberOfPoints(); j++)
+      {
+      if (vtkMath::Distance2BetweenPoints( x, lines->GetPoint( j ) ) <=
+          tolerance * tolerance)
+        {
+        cerr << "Points " << i << " and " << j << " coincide" << endl;
+        return true;
+        }
+      }
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+int TestIntersectionTopologicalChaining(int, char *[])
+{
+  // The equator of the sphere lies on the bottom face of the box, so
+  // the second intersection passes through the vertices of the sphere
+  // on the equator, between endpoints on its edges.
+  const double bounds[6] = { -1.0, 1.0, -1.0, 1.0, 0.0, 1.0 };
+  vtkSmartPointer<vtkPolyData> inputs[2][2];
+  inputs[0][0] = vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 36 );
+  inputs[0][1] = vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.5, 30 );
+  inputs[1][0] = vtkBooleanTestSphere( 0.0, 0.0, 0.0, 0.5, 17 );
+  inputs[1][1] = vtkBooleanTestBox( bounds, 3 );
+
+  for (int pair = 0; pair < 2; pair++)
+    {
+    vtkSmartPointer<vtkPolyData> lines[2];
+    for (int chaining = 0; chaining < 2; chaining++)
+      {
+      vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+        vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+      intersection->SetTopologicalChaining( chaining );
+
+      lines[chaining] = vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> output0 =
+        vtkSmartPointer<vtkPolyData>::New();
+      vtkSmartPointer<vtkPolyData> output1 =
+        vtkSmartPointer<vtkPolyData>::New();
+      if (!intersection->ComputeIntersection( inputs[pair][0],
+                                              inputs[pair][1],
+                                              lines[chaining], output0,
+                                              output1 ))
+        {
+        cerr << "Intersection " << pair << " failed with chaining "
+             << chaining << endl;
+        return EXIT_FAILURE;
+        }
+      if (TestIntersectionTopologicalChainingHasDuplicates( lines[chaining],
+                                                            1e-6 ))
+        {
+        cerr << "Intersection " << pair << " has duplicate points with "
+             << "chaining " << chaining << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    if (lines[0]->GetNumberOfLines() == 0 ||
+        lines[0]->GetNumberOfPoints() != lines[1]->GetNumberOfPoints() ||
+        !vtkBooleanTestSameSegments( lines[0], lines[1], 1e-6 ))
+      {
+      cerr << "Chained intersection " << pair << " differs from the one "
+           << "merged by distance" << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionTransformCache.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Drags a sphere across another by changing the transform of the
+// second input of filters that cache their inputs, and checks that
+// every step gives the same intersection lines and boolean surface as
+// uncached filters run on the second input transformed beforehand.
+
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkIntersectionPolyDataFilter.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestIntersectionTransformCache(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> part =
+    vtkBooleanTestSphere( 0.0, 0.0, 0.0, 0.5, 30 );
+  vtkSmartPointer<vtkPolyData> cutter =
+    vtkBooleanTestSphere( 0.0, 0.0, 0.0, 0.3, 20 );
+
+  vtkSmartPointer<vtkTransform> transform =
+    vtkSmartPointer<vtkTransform>::New();
+  vtkSmartPointer<vtkIntersectionPolyDataFilter> cachedIntersection =
+    vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+  cachedIntersection->CacheInputsOn();
+  cachedIntersection->SetTransform( transform );
+  cachedIntersection->SetInput( 0, part );
+  cachedIntersection->SetInput( 1, cutter );
+  vtkSmartPointer<vtkBooleanOperationPolyDataFilter> cachedBoolean =
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+  cachedBoolean->SetOperationToDifference();
+  cachedBoolean->CacheInputsOn();
+  cachedBoolean->SetTransform( transform );
+  cachedBoolean->SetInput( 0, part );
+  cachedBoolean->SetInput( 1, cutter );
+
+  for (int step = 0; step < 5; step++)
+    {
+    transform->Identity();
+    transform->Translate( -0.4 + 0.2 * step, 0.3, 0.1 );
+    transform->RotateZ( 7.0 * step );
+    cachedIntersection->Update();
+    cachedBoolean->Update();
+
+    vtkSmartPointer<vtkTransformPolyDataFilter> moved =
+      vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    moved->SetInput( cutter );
+    moved->SetTransform( transform );
+    moved->Update();
+
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    intersection->SetInput( 0, part );
+    intersection->SetInput( 1, moved->GetOutput() );
+    intersection->Update();
+    if (intersection->GetOutput( 0 )->GetNumberOfLines() == 0 ||
+        !vtkBooleanTestSameSegments( intersection->GetOutput( 0 ),
+                                     cachedIntersection->GetOutput( 0 ),
+                                     1e-6 ))
+      {
+      cerr << "The intersection lines differ at step " << step << endl;
+      return EXIT_FAILURE;
+      }
+    for (int i = 1; i < 3; i++)
+      {
+      if (!vtkBooleanTestSameSurface( intersection->GetOutput( i ),
+                                      cachedIntersection->GetOutput( i ),
+                                      1e-9 ))
+        {
+        cerr << "Split mesh " << i - 1 << " differs at step " << step
+             << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    vtkSmartPointer<vtkBooleanOperationPolyDataFilter> boolean =
+      vtkSmartPointer<vtkBooleanOperationPolyDataFilter>::New();
+    boolean->SetOperationToDifference();
+    boolean->SetInput( 0, part );
+    boolean->SetInput( 1, moved->GetOutput() );
+    boolean->Update();
+    if (!vtkBooleanTestSameSurface( boolean->GetOutput(),
+                                    cachedBoolean->GetOutput(), 1e-9 ))
+      {
+      cerr << "The difference differs at step " << step << endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
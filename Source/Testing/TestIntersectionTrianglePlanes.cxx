@@ -0,0 +1,72 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestIntersectionTrianglePlanes.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that precomputing the triangle planes gives the same
+// intersection lines and split meshes as computing them for each pair
+// of triangles, with one thread and with several.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestIntersectionTrianglePlanes(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> sphere0 =
+    vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 40 );
+  vtkSmartPointer<vtkPolyData> sphere1 =
+    vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.5, 34 );
+
+  for (int numThreads = 1; numThreads <= 4; numThreads *= 4)
+    {
+    vtkSmartPointer<vtkPolyData> outputs[2][3];
+    for (int precompute = 0; precompute < 2; precompute++)
+      {
+      vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+        vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+      intersection->SetNumberOfThreads( numThreads );
+      intersection->SetPrecomputeTrianglePlanes( precompute );
+
+      for (int i = 0; i < 3; i++)
+        {
+        outputs[precompute][i] = vtkSmartPointer<vtkPolyData>::New();
+        }
+      if (!intersection->ComputeIntersection( sphere0, sphere1,
+                                              outputs[precompute][0],
+                                              outputs[precompute][1],
+                                              outputs[precompute][2] ))
+        {
+        cerr << "Intersection failed with " << numThreads << " threads"
+             << endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    if (outputs[0][0]->GetNumberOfLines() == 0)
+      {
+      cerr << "The spheres do not intersect" << endl;
+      return EXIT_FAILURE;
+      }
+    for (int i = 0; i < 3; i++)
+      {
+      if (!vtkBooleanTestSamePolyData( outputs[0][i], outputs[1][i], 0.0 ))
+        {
+        cerr << "Output " << i << " with precomputed planes differs with "
+             << numThreads << " threads" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
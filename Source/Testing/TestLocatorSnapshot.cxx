@@ -0,0 +1,173 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestLocatorSnapshot.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that an OBB tree read back from a locator snapshot gives the
+// same intersection as the tree built by the filter, and that
+// snapshots with a corrupt cell count or depth, or cut short, are
+// rejected.
+
+#include <vtkIntersectionPolyDataFilter.h>
+#include <vtkPolyDataLocatorCache.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+//-----------------------------------------------------------------------------
+static std::vector<char> TestLocatorSnapshotRead(const char *fileName)
+{
+  std::ifstream file( fileName, std::ios::in | std::ios::binary );
+  return std::vector<char>( std::istreambuf_iterator<char>( file ),
+                            std::istreambuf_iterator<char>() );
+}
+
+//-----------------------------------------------------------------------------
+static void TestLocatorSnapshotWrite(const char *fileName,
+                                     const std::vector<char> &bytes)
+{
+  std::ofstream file( fileName, std::ios::out | std::ios::binary );
+  file.write( &bytes[0], bytes.size() );
+}
+
+//-----------------------------------------------------------------------------
+int TestLocatorSnapshot(int, char *[])
+{
+  const char *fileName = "TestLocatorSnapshot.obb";
+
+  vtkSmartPointer<vtkPolyData> sphere0 =
+    vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 36 );
+  vtkSmartPointer<vtkPolyData> sphere1 =
+    vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.5, 30 );
+
+  vtkObject *built = vtkIntersectionPolyDataFilter::BuildLocatorCacheEntry
+    ( sphere0 );
+  int written = vtkIntersectionPolyDataFilter::WriteLocatorSnapshot
+    ( built, fileName );
+  built->Delete();
+  if (!written)
+    {
+    cerr << "Cannot write the snapshot" << endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkObject *read = vtkIntersectionPolyDataFilter::ReadLocatorSnapshot
+    ( sphere0, fileName );
+  if (read == NULL)
+    {
+    cerr << "Cannot read the snapshot back" << endl;
+    std::remove( fileName );
+    return EXIT_FAILURE;
+    }
+  vtkSmartPointer<vtkPolyDataLocatorCache> cache =
+    vtkSmartPointer<vtkPolyDataLocatorCache>::New();
+  cache->AddEntry( sphere0,
+                   vtkIntersectionPolyDataFilter::BuildLocatorCacheEntry,
+                   read, false );
+  read->Delete();
+
+  vtkSmartPointer<vtkPolyData> outputs[2][3];
+  for (int useCache = 0; useCache < 2; useCache++)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    if (useCache)
+      {
+      intersection->SetLocatorCache( cache );
+      }
+    for (int i = 0; i < 3; i++)
+      {
+      outputs[useCache][i] = vtkSmartPointer<vtkPolyData>::New();
+      }
+    if (!intersection->ComputeIntersection( sphere0, sphere1,
+                                            outputs[useCache][0],
+                                            outputs[useCache][1],
+                                            outputs[useCache][2] ))
+      {
+      cerr << "Intersection failed" << endl;
+      std::remove( fileName );
+      return EXIT_FAILURE;
+      }
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    if (!vtkBooleanTestSamePolyData( outputs[0][i], outputs[1][i], 0.0 ))
+      {
+      cerr << "Output " << i << " differs with the snapshot tree" << endl;
+      std::remove( fileName );
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The cell count of the root follows the header, the deepest level,
+  // the corner and axes of the root and its children flag.
+  std::vector<char> bytes = TestLocatorSnapshotRead( fileName );
+  size_t countOffset = 8 + 3*sizeof(int) + 2*sizeof(vtkIdType) +
+    sizeof(vtkTypeUInt64) + sizeof(int) + 12*sizeof(double) + 1;
+  vtkIdType hugeCount =
+    static_cast<vtkIdType>(1) << (8*sizeof(vtkIdType) - 2);
+  std::vector<char> corrupt = bytes;
+  memcpy( &corrupt[countOffset], &hugeCount, sizeof(vtkIdType) );
+  TestLocatorSnapshotWrite( fileName, corrupt );
+  read = vtkIntersectionPolyDataFilter::ReadLocatorSnapshot( sphere0,
+                                                             fileName );
+  if (read != NULL)
+    {
+    cerr << "A snapshot with a huge cell count was accepted" << endl;
+    read->Delete();
+    std::remove( fileName );
+    return EXIT_FAILURE;
+    }
+
+  // The deepest level precedes the root; a stated depth that differs
+  // from that of the nodes would let the node stacks overflow.
+  size_t levelOffset = 8 + 3*sizeof(int) + 2*sizeof(vtkIdType) +
+    sizeof(vtkTypeUInt64);
+  int deepestLevel;
+  memcpy( &deepestLevel, &bytes[levelOffset], sizeof(int) );
+  for (int delta = -1; delta <= 1; delta += 2)
+    {
+    int wrongLevel = deepestLevel + delta;
+    corrupt = bytes;
+    memcpy( &corrupt[levelOffset], &wrongLevel, sizeof(int) );
+    TestLocatorSnapshotWrite( fileName, corrupt );
+    read = vtkIntersectionPolyDataFilter::ReadLocatorSnapshot( sphere0,
+                                                               fileName );
+    if (read != NULL)
+      {
+      cerr << "A snapshot stating a depth of " << wrongLevel
+           << " instead of " << deepestLevel << " was accepted" << endl;
+      read->Delete();
+      std::remove( fileName );
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::vector<char> truncated( bytes.begin(),
+                               bytes.begin() + bytes.size() / 2 );
+  TestLocatorSnapshotWrite( fileName, truncated );
+  read = vtkIntersectionPolyDataFilter::ReadLocatorSnapshot( sphere0,
+                                                             fileName );
+  std::remove( fileName );
+  if (read != NULL)
+    {
+    cerr << "A truncated snapshot was accepted" << endl;
+    read->Delete();
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
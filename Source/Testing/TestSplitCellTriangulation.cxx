@@ -0,0 +1,121 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSplitCellTriangulation.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks the triangulation of the cut cells, both by the small polygon
+// triangulator, for the cells of two fine spheres, and by the
+// vtkDelaunay2D fallback, for the cells of a coarse box crossed by long
+// loops. Every triangulation of a cut cell has the same number of
+// triangles, so each split mesh of a closed convex input must be
+// closed, with 2V - 4 triangles for V points, keep the area of the
+// input and have no triangle that is flipped or degenerate.
+
+#include <vtkIntersectionPolyDataFilter.h>
+#include <vtkTriangle.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+//-----------------------------------------------------------------------------
+// Checks the split mesh of the convex input around center.
+static bool TestSplitCellTriangulationCheck(vtkPolyData *input,
+                                            vtkPolyData *split,
+                                            const double center[3])
+{
+  vtkIdType numPoints = split->GetNumberOfPoints();
+  if (split->GetNumberOfPolys() != 2 * numPoints - 4)
+    {
+    cerr << split->GetNumberOfPolys() << " triangles for " << numPoints
+         << " points" << endl;
+    return false;
+    }
+
+  vtkIdType npts, *pts;
+  vtkCellArray *polys = split->GetPolys();
+  vtkIdType cellId = 0;
+  for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); cellId++)
+    {
+    double x[3][3], normal[3], centroid[3];
+    if (npts != 3)
+      {
+      cerr << "Cell " << cellId << " is not a triangle" << endl;
+      return false;
+      }
+    for (int j = 0; j < 3; j++)
+      {
+      split->GetPoint( pts[j], x[j] );
+      }
+    vtkTriangle::ComputeNormalDirection( x[0], x[1], x[2], normal );
+    for (int k = 0; k < 3; k++)
+      {
+      centroid[k] = (x[0][k] + x[1][k] + x[2][k]) / 3.0 - center[k];
+      }
+    if (vtkMath::Dot( normal, centroid ) <= 0.0)
+      {
+      cerr << "Triangle " << cellId << " is flipped or degenerate" << endl;
+      return false;
+      }
+    }
+
+  double inputArea = vtkBooleanTestArea( input );
+  double splitArea = vtkBooleanTestArea( split );
+  if (fabs( inputArea - splitArea ) > 1e-9 * inputArea)
+    {
+    cerr << "Area " << splitArea << " instead of " << inputArea << endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TestSplitCellTriangulation(int, char *[])
+{
+  const double bounds[6] = { -0.4, 0.4, -0.4, 0.4, -0.4, 0.4 };
+  double centers[2][2][3] = {
+    { { -0.15, 0.0, 0.0 }, { 0.15, 0.05, 0.02 } },
+    { { 0.0, 0.0, 0.0 }, { 0.05, 0.02, 0.01 } } };
+  vtkSmartPointer<vtkPolyData> inputs[2][2];
+  inputs[0][0] = vtkBooleanTestSphere( -0.15, 0.0, 0.0, 0.5, 36 );
+  inputs[0][1] = vtkBooleanTestSphere( 0.15, 0.05, 0.02, 0.45, 30 );
+  inputs[1][0] = vtkBooleanTestBox( bounds, 1 );
+  inputs[1][1] = vtkBooleanTestSphere( 0.05, 0.02, 0.01, 0.5, 96 );
+
+  for (int pair = 0; pair < 2; pair++)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    vtkSmartPointer<vtkPolyData> lines = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    outputs[0] = vtkSmartPointer<vtkPolyData>::New();
+    outputs[1] = vtkSmartPointer<vtkPolyData>::New();
+    if (!intersection->ComputeIntersection( inputs[pair][0], inputs[pair][1],
+                                            lines, outputs[0], outputs[1] ) ||
+        lines->GetNumberOfLines() == 0)
+      {
+      cerr << "Intersection " << pair << " failed" << endl;
+      return EXIT_FAILURE;
+      }
+
+    for (int i = 0; i < 2; i++)
+      {
+      if (!TestSplitCellTriangulationCheck( inputs[pair][i], outputs[i],
+                                            centers[pair][i] ))
+        {
+        cerr << "Split mesh " << i << " of intersection " << pair
+             << " is not a valid triangulation" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSplitMeshParallel.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that splitting the cut cells with several threads gives the
+// same meshes as splitting them serially. A fine sphere cuts a box
+// made of two triangles per face, so the box cells are crossed by
+// long intersection loops and go through the vtkDelaunay2D fallback.
+
+#include <vtkIntersectionPolyDataFilter.h>
+
+#include "vtkBooleanTestUtilities.h"
+
+int TestSplitMeshParallel(int, char *[])
+{
+  const double bounds[6] = { -0.4, 0.4, -0.4, 0.4, -0.4, 0.4 };
+  vtkSmartPointer<vtkPolyData> box = vtkBooleanTestBox( bounds, 1 );
+  vtkSmartPointer<vtkPolyData> sphere =
+    vtkBooleanTestSphere( 0.05, 0.02, 0.01, 0.5, 96 );
+
+  vtkSmartPointer<vtkPolyData> serial[3];
+  for (int numThreads = 1; numThreads <= 4; numThreads *= 2)
+    {
+    vtkSmartPointer<vtkIntersectionPolyDataFilter> intersection =
+      vtkSmartPointer<vtkIntersectionPolyDataFilter>::New();
+    intersection->SetNumberOfThreads( numThreads );
+
+    vtkSmartPointer<vtkPolyData> outputs[3];
+    for (int i = 0; i < 3; i++)
+      {
+      outputs[i] = vtkSmartPointer<vtkPolyData>::New();
+      }
+    if (!intersection->ComputeIntersection( box, sphere, outputs[0],
+                                            outputs[1], outputs[2] ))
+      {
+      cerr << "Intersection failed with " << numThreads << " threads" << endl;
+      return EXIT_FAILURE;
+      }
+
+    if (numThreads == 1)
+      {
+      // Each box triangle is cut into many more cells than the
+      // small polygon triangulator handles.
+      if (outputs[1]->GetNumberOfPolys() < 12 + 2*64)
+        {
+        cerr << "The box cells were not split" << endl;
+        return EXIT_FAILURE;
+        }
+      for (int i = 0; i < 3; i++)
+        {
+        serial[i] = outputs[i];
+        }
+      continue;
+      }
+
+    for (int i = 0; i < 3; i++)
+      {
+      if (!vtkBooleanTestSamePolyData( serial[i], outputs[i], 0.0 ))
+        {
+        cerr << "Output " << i << " with " << numThreads
+             << " threads differs from the serial one" << endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTriangleTriangleIntersectionBatch.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that the batched triangle-triangle test gives bit-identical
+// results to one call of TriangleTriangleIntersection() per candidate,
+// including for candidates that share a vertex or the plane of the
+// first triangle.
+
+#include <vtkIntersectionPolyDataFilter.h>
+#include <vtkMath.h>
+
+#include <algorithm>
+#include <vector>
+
+int TestTriangleTriangleIntersectionBatch(int, char *[])
+{
+  vtkMath::RandomSeed( 8775070 );
+
+  int numIntersections = 0;
+  for (int trial = 0; trial < 2000; trial++)
+    {
+    double tri[3][3];
+    for (int j = 0; j < 3; j++)
+      {
+      for (int k = 0; k < 3; k++)
+        {
+        tri[j][k] = vtkMath::Random( -1.0, 1.0 );
+        }
+      }
+
+    // Odd counts leave candidates for the scalar tail of the batch.
+    int numCandidates = 1 + trial % 11;
+    std::vector<double> candidates( 9*numCandidates );
+    for (int i = 0; i < numCandidates; i++)
+      {
+      double candidate[3][3];
+      for (int j = 0; j < 3; j++)
+        {
+        for (int k = 0; k < 3; k++)
+          {
+          candidate[j][k] = vtkMath::Random( -1.0, 1.0 );
+          }
+        }
+      if (i % 4 == 1)
+        {
+        // Shares a vertex with the first triangle.
+        std::copy( tri[0], tri[0] + 3, candidate[0] );
+        }
+      else if (i % 4 == 2)
+        {
+        // Lies in the plane of the first triangle.
+        for (int j = 0; j < 3; j++)
+          {
+          double u = vtkMath::Random( -0.5, 1.0 );
+          double v = vtkMath::Random( -0.5, 1.0 );
+          for (int k = 0; k < 3; k++)
+            {
+            candidate[j][k] = tri[0][k] + u * (tri[1][k] - tri[0][k]) +
+              v * (tri[2][k] - tri[0][k]);
+            }
+          }
+        }
+      for (int j = 0; j < 3; j++)
+        {
+        for (int k = 0; k < 3; k++)
+          {
+          candidates[(3*j + k)*numCandidates + i] = candidate[j][k];
+          }
+        }
+      }
+
+    std::vector<int> intersects( numCandidates ), coplanar( numCandidates );
+    std::vector<double> pts1( 3*numCandidates ), pts2( 3*numCandidates );
+    vtkIntersectionPolyDataFilter::TriangleTriangleIntersectionBatch
+      ( tri[0], tri[1], tri[2], numCandidates, &candidates[0],
+        &intersects[0], &coplanar[0], &pts1[0], &pts2[0] );
+
+    for (int i = 0; i < numCandidates; i++)
+      {
+      double candidate[3][3];
+      for (int j = 0; j < 3; j++)
+        {
+        for (int k = 0; k < 3; k++)
+          {
+          candidate[j][k] = candidates[(3*j + k)*numCandidates + i];
+          }
+        }
+
+      int expectedCoplanar = 0;
+      double expected1[3], expected2[3];
+      int expected = vtkIntersectionPolyDataFilter::TriangleTriangleIntersection
+        ( tri[0], tri[1], tri[2], candidate[0], candidate[1], candidate[2],
+          expectedCoplanar, expected1, expected2 );
+
+      bool same = expected == intersects[i] &&
+        expectedCoplanar == coplanar[i];
+      for (int k = 0; same && expected && k < 3; k++)
+        {
+        same = expected1[k] == pts1[3*i + k] && expected2[k] == pts2[3*i + k];
+        }
+      if (!same)
+        {
+        cerr << "Candidate " << i << " of trial " << trial
+             << " differs from TriangleTriangleIntersection()" << endl;
+        return EXIT_FAILURE;
+        }
+      numIntersections += expected;
+      }
+    }
+
+  if (numIntersections == 0)
+    {
+    cerr << "No intersecting candidates were tested" << endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,407 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBooleanTestUtilities.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Helpers shared by the tests: input meshes and comparisons of the
+// output of an option or of the threaded path against the output of
+// the default, serial path.
+
+#ifndef __vtkBooleanTestUtilities_h
+#define __vtkBooleanTestUtilities_h
+
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTriangle.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Returns a triangulated sphere.
+inline vtkSmartPointer<vtkPolyData> vtkBooleanTestSphere(double x, double y,
+                                                         double z,
+                                                         double radius,
+                                                         int resolution)
+{
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetCenter( x, y, z );
+  sphere->SetRadius( radius );
+  sphere->SetThetaResolution( resolution );
+  sphere->SetPhiResolution( resolution );
+  sphere->Update();
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy( sphere->GetOutput() );
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+// Returns a closed triangulated box with the given bounds, with its
+// normals pointing outwards. If faceResolution is larger than one,
+// each face is a grid of faceResolution x faceResolution squares.
+inline vtkSmartPointer<vtkPolyData> vtkBooleanTestBox(const double bounds[6],
+                                                      int faceResolution)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  int n = faceResolution < 1 ? 1 : faceResolution;
+
+  // Each face is given by the axis of its normal, its side and two
+  // in-plane axes ordered so that their cross product points outwards.
+  for (int axis = 0; axis < 3; axis++)
+    {
+    for (int side = 0; side < 2; side++)
+      {
+      int u = (axis + (side ? 1 : 2)) % 3;
+      int v = (axis + (side ? 2 : 1)) % 3;
+      vtkIdType offset = points->GetNumberOfPoints();
+      for (int j = 0; j <= n; j++)
+        {
+        for (int i = 0; i <= n; i++)
+          {
+          double x[3];
+          x[axis] = bounds[2*axis + side];
+          x[u] = bounds[2*u] + (bounds[2*u+1] - bounds[2*u]) * i / n;
+          x[v] = bounds[2*v] + (bounds[2*v+1] - bounds[2*v]) * j / n;
+          points->InsertNextPoint( x );
+          }
+        }
+      for (int j = 0; j < n; j++)
+        {
+        for (int i = 0; i < n; i++)
+          {
+          vtkIdType p = offset + j*(n+1) + i;
+          vtkIdType tri0[3] = {p, p + 1, p + n + 2};
+          vtkIdType tri1[3] = {p, p + n + 2, p + n + 1};
+          polys->InsertNextCell( 3, tri0 );
+          polys->InsertNextCell( 3, tri1 );
+          }
+        }
+      }
+    }
+
+  // Merge the points shared by the faces, so that the box is closed.
+  vtkSmartPointer<vtkPoints> merged = vtkSmartPointer<vtkPoints>::New();
+  std::vector<vtkIdType> pointMap( points->GetNumberOfPoints() );
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    points->GetPoint( i, x );
+    pointMap[i] = -1;
+    for (vtkIdType j = 0; j < merged->GetNumberOfPoints() && pointMap[i] < 0;
+         j++)
+      {
+      double y[3];
+      merged->GetPoint( j, y );
+      if (x[0] == y[0] && x[1] == y[1] && x[2] == y[2])
+        {
+        pointMap[i] = j;
+        }
+      }
+    if (pointMap[i] < 0)
+      {
+      pointMap[i] = merged->InsertNextPoint( x );
+      }
+    }
+
+  vtkSmartPointer<vtkCellArray> mergedPolys =
+    vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType npts, *pts;
+  for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); )
+    {
+    vtkIdType tri[3] = {pointMap[pts[0]], pointMap[pts[1]], pointMap[pts[2]]};
+    mergedPolys->InsertNextCell( 3, tri );
+    }
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints( merged );
+  output->SetPolys( mergedPolys );
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+// Returns whether a and b have the same points, within tolerance, and
+// the same cells in the same order.
+inline bool vtkBooleanTestSamePolyData(vtkPolyData *a, vtkPolyData *b,
+                                       double tolerance)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells())
+    {
+    cerr << "Sizes differ: " << a->GetNumberOfPoints() << " points, "
+         << a->GetNumberOfCells() << " cells vs. "
+         << b->GetNumberOfPoints() << " points, "
+         << b->GetNumberOfCells() << " cells" << endl;
+    return false;
+    }
+
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); i++)
+    {
+    double x[3], y[3];
+    a->GetPoint( i, x );
+    b->GetPoint( i, y );
+    if (sqrt( vtkMath::Distance2BetweenPoints( x, y ) ) > tolerance)
+      {
+      cerr << "Point " << i << " differs" << endl;
+      return false;
+      }
+    }
+
+  for (vtkIdType i = 0; i < a->GetNumberOfCells(); i++)
+    {
+    vtkIdType nptsA, *ptsA, nptsB, *ptsB;
+    a->GetCellPoints( i, nptsA, ptsA );
+    b->GetCellPoints( i, nptsB, ptsB );
+    if (a->GetCellType( i ) != b->GetCellType( i ) || nptsA != nptsB ||
+        !std::equal( ptsA, ptsA + nptsA, ptsB ))
+      {
+      cerr << "Cell " << i << " differs" << endl;
+      return false;
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the segments of the lines of input, each with its endpoints
+// sorted, in sorted order. Coordinates are rounded to multiples of
+// tolerance so that the order does not depend on round-off.
+inline std::vector< std::vector<double> >
+vtkBooleanTestSortedSegments(vtkPolyData *input, double tolerance)
+{
+  std::vector< std::vector<double> > segments;
+  vtkCellArray *lines = input->GetLines();
+  vtkIdType npts, *pts;
+  for (lines->InitTraversal(); lines->GetNextCell( npts, pts ); )
+    {
+    for (vtkIdType i = 0; i + 1 < npts; i++)
+      {
+      std::vector<double> ends[2];
+      for (int j = 0; j < 2; j++)
+        {
+        double x[3];
+        input->GetPoint( pts[i+j], x );
+        for (int k = 0; k < 3; k++)
+          {
+          ends[j].push_back( floor( x[k] / tolerance + 0.5 ) * tolerance );
+          }
+        }
+      if (ends[1] < ends[0])
+        {
+        ends[0].swap( ends[1] );
+        }
+      ends[0].insert( ends[0].end(), ends[1].begin(), ends[1].end() );
+      segments.push_back( ends[0] );
+      }
+    }
+  std::sort( segments.begin(), segments.end() );
+  return segments;
+}
+
+//-----------------------------------------------------------------------------
+// Returns whether the lines of a and b are made of the same segments,
+// regardless of their order and of how they are joined into cells.
+inline bool vtkBooleanTestSameSegments(vtkPolyData *a, vtkPolyData *b,
+                                       double tolerance)
+{
+  std::vector< std::vector<double> > segmentsA =
+    vtkBooleanTestSortedSegments( a, tolerance );
+  std::vector< std::vector<double> > segmentsB =
+    vtkBooleanTestSortedSegments( b, tolerance );
+  if (segmentsA.size() != segmentsB.size())
+    {
+    cerr << "Number of segments differs: " << segmentsA.size() << " vs. "
+         << segmentsB.size() << endl;
+    return false;
+    }
+
+  for (size_t i = 0; i < segmentsA.size(); i++)
+    {
+    for (int k = 0; k < 6; k++)
+      {
+      if (fabs( segmentsA[i][k] - segmentsB[i][k] ) > 2.0 * tolerance)
+        {
+        cerr << "Segment " << i << " differs" << endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the total area of the polygons of input.
+inline double vtkBooleanTestArea(vtkPolyData *input)
+{
+  double area = 0.0;
+  vtkCellArray *polys = input->GetPolys();
+  vtkIdType npts, *pts;
+  for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); )
+    {
+    double x0[3], x1[3], x2[3];
+    input->GetPoint( pts[0], x0 );
+    for (vtkIdType i = 1; i + 1 < npts; i++)
+      {
+      input->GetPoint( pts[i], x1 );
+      input->GetPoint( pts[i+1], x2 );
+      area += vtkTriangle::TriangleArea( x0, x1, x2 );
+      }
+    }
+  return area;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the signed volume enclosed by the polygons of input, which
+// is positive if their normals point outwards.
+inline double vtkBooleanTestVolume(vtkPolyData *input)
+{
+  double volume = 0.0;
+  vtkCellArray *polys = input->GetPolys();
+  vtkIdType npts, *pts;
+  for (polys->InitTraversal(); polys->GetNextCell( npts, pts ); )
+    {
+    double x0[3], x1[3], x2[3], n[3];
+    input->GetPoint( pts[0], x0 );
+    for (vtkIdType i = 1; i + 1 < npts; i++)
+      {
+      input->GetPoint( pts[i], x1 );
+      input->GetPoint( pts[i+1], x2 );
+      vtkMath::Cross( x1, x2, n );
+      volume += vtkMath::Dot( x0, n ) / 6.0;
+      }
+    }
+  return volume;
+}
+
+//-----------------------------------------------------------------------------
+// Returns whether a and b have the same number of polygons and, within
+// tolerance, the same area and enclosed volume. Used where the same
+// surface may come out with its cells in another order.
+inline bool vtkBooleanTestSameSurface(vtkPolyData *a, vtkPolyData *b,
+                                      double tolerance)
+{
+  double areaA = vtkBooleanTestArea( a );
+  double areaB = vtkBooleanTestArea( b );
+  double volumeA = vtkBooleanTestVolume( a );
+  double volumeB = vtkBooleanTestVolume( b );
+  if (a->GetNumberOfPolys() != b->GetNumberOfPolys() ||
+      fabs( areaA - areaB ) > tolerance ||
+      fabs( volumeA - volumeB ) > tolerance)
+    {
+    cerr << "Surfaces differ: " << a->GetNumberOfPolys() << " polygons, area "
+         << areaA << ", volume " << volumeA << " vs. "
+         << b->GetNumberOfPolys() << " polygons, area " << areaB
+         << ", volume " << volumeB << endl;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the polygons of a and b in one mesh, without merging points.
+inline vtkSmartPointer<vtkPolyData> vtkBooleanTestAppend(vtkPolyData *a,
+                                                         vtkPolyData *b)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+
+  vtkPolyData *inputs[2] = { a, b };
+  for (int i = 0; i < 2; i++)
+    {
+    vtkIdType offset = points->GetNumberOfPoints();
+    for (vtkIdType ptId = 0; ptId < inputs[i]->GetNumberOfPoints(); ptId++)
+      {
+      points->InsertNextPoint( inputs[i]->GetPoint( ptId ) );
+      }
+    vtkIdType npts, *pts;
+    vtkCellArray *inPolys = inputs[i]->GetPolys();
+    for (inPolys->InitTraversal(); inPolys->GetNextCell( npts, pts ); )
+      {
+      polys->InsertNextCell( npts );
+      for (vtkIdType j = 0; j < npts; j++)
+        {
+        polys->InsertCellPoint( pts[j] + offset );
+        }
+      }
+    }
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints( points );
+  output->SetPolys( polys );
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+// Returns numPts points drawn uniformly from the box [-size, size]^3,
+// always the same ones for a given seed.
+inline vtkSmartPointer<vtkPoints> vtkBooleanTestRandomPoints(vtkIdType numPts,
+                                                             double size,
+                                                             long seed)
+{
+  vtkMath::RandomSeed( seed );
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints( numPts );
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    double x[3];
+    for (int j = 0; j < 3; j++)
+      {
+      x[j] = vtkMath::Random( -size, size );
+      }
+    points->SetPoint( i, x );
+    }
+  return points;
+}
+
+//-----------------------------------------------------------------------------
+// Returns whether the arrays a and b have the same tuples, within
+// tolerance.
+inline bool vtkBooleanTestSameArray(vtkDataArray *a, vtkDataArray *b,
+                                    double tolerance)
+{
+  if (a == NULL || b == NULL ||
+      a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents())
+    {
+    cerr << "Arrays differ in size" << endl;
+    return false;
+    }
+
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); i++)
+    {
+    for (int j = 0; j < a->GetNumberOfComponents(); j++)
+      {
+      if (fabs( a->GetComponent( i, j ) - b->GetComponent( i, j ) ) >
+          tolerance)
+        {
+        cerr << "Tuple " << i << " differs: " << a->GetComponent( i, j )
+             << " vs. " << b->GetComponent( i, j ) << endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+#endif
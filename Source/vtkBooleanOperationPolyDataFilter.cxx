@@ -15,6 +15,7 @@
 #include "vtkBooleanOperationPolyDataFilter.h"
 
 #include "vtkCellArray.h"
+#include "vtkCellLocator.h"
 #include "vtkCellData.h"
 #include "vtkDataArray.h"
 #include "vtkDataSetAttributes.h"
@@ -23,17 +24,28 @@
 #include "vtkFloatArray.h"
 #include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkImplicitPolyData.h"
+#include "vtkImplicitWindingNumber.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkIntArray.h"
 #include "vtkIntersectionPolyDataFilter.h"
+#include "vtkLinearTransform.h"
 #include "vtkObjectFactory.h"
+#include "vtkMath.h"
 #include "vtkPointData.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkPolyDataLocatorCache.h"
+#include "vtkPolygon.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkSmartPointer.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkBooleanOperationPolyDataFilter);
 
 //-----------------------------------------------------------------------------
@@ -43,6 +55,11 @@ vtkBooleanOperationPolyDataFilter::vtkBooleanOperationPolyDataFilter() :
   this->Tolerance = 1e-6;
   this->Operation = UNION;
   this->ReorientDifferenceCells = 1;
+  this->ClassificationMode = CLASSIFY_BY_DISTANCE;
+  this->WindingNumberThreshold = 0.5;
+  this->NumberOfThreads = 1;
+  this->CacheInputs = 0;
+  this->IntersectCoplanarTriangles = 0;
 
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(2);
@@ -58,6 +75,53 @@ vtkBooleanOperationPolyDataFilter::~vtkBooleanOperationPolyDataFilter()
   this->PolyDataDistance->Delete();
 }
 
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::SetTransform(vtkLinearTransform *transform)
+{
+  if ( this->PolyDataIntersection->GetTransform() != transform )
+    {
+    this->PolyDataIntersection->SetTransform(transform);
+    this->Modified();
+    }
+}
+
+//-----------------------------------------------------------------------------
+vtkLinearTransform* vtkBooleanOperationPolyDataFilter::GetTransform()
+{
+  return this->PolyDataIntersection->GetTransform();
+}
+
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::SetLocatorCache(vtkPolyDataLocatorCache *cache)
+{
+  if ( this->PolyDataIntersection->GetLocatorCache() != cache )
+    {
+    this->PolyDataIntersection->SetLocatorCache(cache);
+    this->Modified();
+    }
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache* vtkBooleanOperationPolyDataFilter::GetLocatorCache()
+{
+  return this->PolyDataIntersection->GetLocatorCache();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkBooleanOperationPolyDataFilter::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+
+  vtkLinearTransform *transform = this->PolyDataIntersection->GetTransform();
+  if ( transform != NULL )
+    {
+    unsigned long transformMTime = transform->GetMTime();
+    mTime = (transformMTime > mTime ? transformMTime : mTime);
+    }
+
+  return mTime;
+}
+
 //-----------------------------------------------------------------------------
 void vtkBooleanOperationPolyDataFilter::SortPolyData(vtkPolyData* input,
                                        vtkIdList* interList,
@@ -83,6 +147,351 @@ void vtkBooleanOperationPolyDataFilter::SortPolyData(vtkPolyData* input,
     }
 }
 
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::SortPolyDataByRegion(vtkPolyData* input,
+                                                vtkPolyData* other,
+                                                vtkIdType firstSplitPtId,
+                                                vtkIdList* interList,
+                                                vtkIdList* unionList)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkIdType npts, *pts;
+
+  // Cells with a point on the intersection lines form the band around
+  // the cut. Their distances are computed exactly.
+  std::vector< vtkIdType > bandIndex(numCells, -1);
+  vtkSmartPointer< vtkDoubleArray > centers =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  centers->SetNumberOfComponents(3);
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    input->GetCellPoints(cid, npts, pts);
+    bool inBand = false;
+    double center[3] = {0.0, 0.0, 0.0};
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      double x[3];
+      input->GetPoint(pts[i], x);
+      center[0] += x[0];
+      center[1] += x[1];
+      center[2] += x[2];
+      inBand = inBand || pts[i] >= firstSplitPtId;
+      }
+
+    if (inBand && npts > 0)
+      {
+      center[0] /= npts;
+      center[1] /= npts;
+      center[2] /= npts;
+      bandIndex[cid] = centers->GetNumberOfTuples();
+      centers->InsertNextTuple(center);
+      }
+    }
+
+  vtkSmartPointer< vtkImplicitPolyData > imp =
+    vtkSmartPointer< vtkImplicitPolyData >::New();
+  imp->SetNumberOfThreads(this->NumberOfThreads);
+  imp->SetInput(other);
+
+  vtkSmartPointer< vtkDoubleArray > bandDist =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  imp->FunctionValue(centers, bandDist);
+
+  // Flood fill the regions bounded by the intersection lines. An edge
+  // with both end points on the lines is treated as part of a line;
+  // an edge that merely spans two such points splits a region in two,
+  // which costs an extra evaluation but does not change the result.
+  std::vector< vtkIdType > region(numCells, -1);
+  std::vector< double > regionDist;
+  std::vector< vtkIdType > stack;
+  vtkSmartPointer< vtkIdList > neighbors = vtkSmartPointer< vtkIdList >::New();
+
+  // Regions away from the cut need a single test at the center of
+  // their seed cell. The seeds are evaluated together afterwards.
+  std::vector< vtkIdType > seedRegions;
+  vtkSmartPointer< vtkDoubleArray > seedCenters =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  seedCenters->SetNumberOfComponents(3);
+  vtkSmartPointer< vtkGenericCell > cell =
+    vtkSmartPointer< vtkGenericCell >::New();
+  std::vector< double > weights(std::max(input->GetMaxCellSize(), 1));
+
+  for (vtkIdType seed = 0; seed < numCells; seed++)
+    {
+    if (region[seed] >= 0)
+      {
+      continue;
+      }
+
+    vtkIdType regionId = static_cast<vtkIdType>(regionDist.size());
+    double dist = 0.0;
+    bool haveDist = false;
+    region[seed] = regionId;
+    stack.push_back(seed);
+    while (!stack.empty())
+      {
+      vtkIdType cid = stack.back();
+      stack.pop_back();
+
+      // Use the band cell farthest from the other surface to decide
+      // the side of the region.
+      if (bandIndex[cid] >= 0)
+        {
+        double d = bandDist->GetValue(bandIndex[cid]);
+        if (!haveDist || fabs(d) > fabs(dist))
+          {
+          dist = d;
+          haveDist = true;
+          }
+        }
+
+      input->GetCellPoints(cid, npts, pts);
+      for (vtkIdType i = 0; i < npts; i++)
+        {
+        vtkIdType p0 = pts[i];
+        vtkIdType p1 = pts[(i+1) % npts];
+        if (p0 >= firstSplitPtId && p1 >= firstSplitPtId)
+          {
+          continue;
+          }
+
+        input->GetCellEdgeNeighbors(cid, p0, p1, neighbors);
+        for (vtkIdType j = 0; j < neighbors->GetNumberOfIds(); j++)
+          {
+          vtkIdType nbr = neighbors->GetId(j);
+          if (region[nbr] < 0)
+            {
+            region[nbr] = regionId;
+            stack.push_back(nbr);
+            }
+          }
+        }
+      }
+
+    if (!haveDist)
+      {
+      input->GetCell(seed, cell);
+      int subId;
+      double pcoords[3], x[3];
+      cell->GetParametricCenter(pcoords);
+      cell->EvaluateLocation(subId, pcoords, x, &weights[0]);
+      seedCenters->InsertNextTuple(x);
+      seedRegions.push_back(regionId);
+      }
+    regionDist.push_back(dist);
+    }
+
+  if (!seedRegions.empty())
+    {
+    vtkSmartPointer< vtkDoubleArray > seedDist =
+      vtkSmartPointer< vtkDoubleArray >::New();
+    imp->FunctionValue(seedCenters, seedDist);
+    for (size_t i = 0; i < seedRegions.size(); i++)
+      {
+      regionDist[seedRegions[i]] = seedDist->GetValue(i);
+      }
+    }
+
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    double dist = bandIndex[cid] >= 0 ?
+      bandDist->GetValue(bandIndex[cid]) : regionDist[region[cid]];
+    if ( dist > this->Tolerance )
+      {
+      unionList->InsertNextId( cid );
+      }
+    else
+      {
+      interList->InsertNextId( cid );
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::SortPolyDataByWindingNumber(vtkPolyData* input,
+                                                       vtkPolyData* other,
+                                                       vtkIdList* interList,
+                                                       vtkIdList* unionList)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+
+  vtkSmartPointer< vtkDoubleArray > centers =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  centers->SetNumberOfComponents(3);
+  centers->SetNumberOfTuples(numCells);
+  vtkSmartPointer< vtkGenericCell > cell =
+    vtkSmartPointer< vtkGenericCell >::New();
+  std::vector< double > weights(std::max(input->GetMaxCellSize(), 1));
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    input->GetCell(cid, cell);
+    int subId;
+    double pcoords[3], x[3];
+    cell->GetParametricCenter(pcoords);
+    cell->EvaluateLocation(subId, pcoords, x, &weights[0]);
+    centers->SetTuple(cid, x);
+    }
+
+  // The function is 0.5 minus the winding number.
+  vtkSmartPointer< vtkImplicitWindingNumber > imp =
+    vtkSmartPointer< vtkImplicitWindingNumber >::New();
+  imp->SetNumberOfThreads(this->NumberOfThreads);
+  imp->SetInput(other);
+  vtkSmartPointer< vtkDoubleArray > values =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  imp->FunctionValue(centers, values);
+
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    if ( 0.5 - values->GetValue(cid) < this->WindingNumberThreshold )
+      {
+      unionList->InsertNextId( cid );
+      }
+    else
+      {
+      interList->InsertNextId( cid );
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Sets orientation[cid] to 1 for the cells of input that lie on a cell
+// of other with the same orientation, to -1 for those that lie on one
+// with the opposite orientation, and to 0 for the others. locator must
+// be built over other. Returns whether any cell lies on other.
+static bool vtkBooleanOperationFindCoplanarCells(vtkPolyData *input,
+                                                 vtkPolyData *other,
+                                                 vtkCellLocator *locator,
+                                                 double tolerance,
+                                                 std::vector< signed char > &orientation)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  orientation.assign(numCells, 0);
+  if ( numCells == 0 || other->GetNumberOfCells() == 0 )
+    {
+    return false;
+    }
+
+  double bounds[6];
+  other->GetBounds(bounds);
+  for (int k = 0; k < 6; k++)
+    {
+    bounds[k] += (k % 2 ? tolerance : -tolerance);
+    }
+
+  vtkSmartPointer< vtkGenericCell > cell =
+    vtkSmartPointer< vtkGenericCell >::New();
+  bool coplanar = false;
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    vtkIdType npts, *pts;
+    input->GetCellPoints(cid, npts, pts);
+    if ( npts < 3 )
+      {
+      continue;
+      }
+
+    double center[3] = {0.0, 0.0, 0.0};
+    for (vtkIdType p = 0; p < npts; p++)
+      {
+      double x[3];
+      input->GetPoint(pts[p], x);
+      for (int k = 0; k < 3; k++)
+        {
+        center[k] += x[k] / npts;
+        }
+      }
+    if ( center[0] < bounds[0] || center[0] > bounds[1] ||
+         center[1] < bounds[2] || center[1] > bounds[3] ||
+         center[2] < bounds[4] || center[2] > bounds[5] )
+      {
+      continue;
+      }
+
+    double closest[3], dist2;
+    vtkIdType otherId;
+    int subId;
+    locator->FindClosestPoint(center, closest, cell, otherId, subId, dist2);
+    if ( otherId < 0 || dist2 > tolerance * tolerance )
+      {
+      continue;
+      }
+
+    vtkIdType otherNpts, *otherPts;
+    other->GetCellPoints(otherId, otherNpts, otherPts);
+    double normal[3], otherNormal[3];
+    vtkPolygon::ComputeNormal(input->GetPoints(), static_cast<int>(npts),
+                              pts, normal);
+    vtkPolygon::ComputeNormal(other->GetPoints(),
+                              static_cast<int>(otherNpts), otherPts,
+                              otherNormal);
+    double cosine = vtkMath::Dot(normal, otherNormal);
+    if ( fabs(cosine) >= 1.0 - 1e-6 )
+      {
+      orientation[cid] = cosine > 0.0 ? 1 : -1;
+      coplanar = true;
+      }
+    }
+
+  return coplanar;
+}
+
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::SortCoplanarCells(vtkPolyData* input,
+                                                       vtkPolyData* other,
+                                                       int inputIndex,
+                                                       vtkIdList* interList,
+                                                       vtkIdList* unionList)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  if ( numCells == 0 || other->GetNumberOfCells() == 0 )
+    {
+    return;
+    }
+
+  vtkSmartPointer< vtkCellLocator > locator =
+    vtkSmartPointer< vtkCellLocator >::New();
+  locator->SetDataSet(other);
+  locator->BuildLocator();
+
+  std::vector< signed char > orientation;
+  if ( !vtkBooleanOperationFindCoplanarCells(input, other, locator,
+                                             this->Tolerance, orientation) )
+    {
+    return;
+    }
+
+  // The list each operation copies the cells of this input from.
+  bool copiesUnion = this->Operation == UNION ||
+    ( this->Operation == DIFFERENCE && inputIndex == 0 );
+  bool keepSame = inputIndex == 0 && this->Operation != DIFFERENCE;
+  bool keepOpposite = inputIndex == 0 && this->Operation == DIFFERENCE;
+
+  std::vector< char > inUnion(numCells, 0);
+  for (vtkIdType i = 0; i < unionList->GetNumberOfIds(); i++)
+    {
+    inUnion[unionList->GetId(i)] = 1;
+    }
+  interList->Reset();
+  unionList->Reset();
+  for (vtkIdType cid = 0; cid < numCells; cid++)
+    {
+    bool toUnion = inUnion[cid] != 0;
+    if ( orientation[cid] != 0 )
+      {
+      bool keep = orientation[cid] > 0 ? keepSame : keepOpposite;
+      toUnion = keep == copiesUnion;
+      }
+    if ( toUnion )
+      {
+      unionList->InsertNextId(cid);
+      }
+    else
+      {
+      interList->InsertNextId(cid);
+      }
+    }
+}
 
 //-----------------------------------------------------------------------------
 int vtkBooleanOperationPolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(request),
@@ -114,29 +523,69 @@ int vtkBooleanOperationPolyDataFilter::RequestData(vtkInformation*        vtkNot
     return 0;
     }
 
-  // Get intersected versions
-  this->PolyDataIntersection->SetInputConnection
-    (0, this->GetInputConnection(0, 0));
-  this->PolyDataIntersection->SetInputConnection
-    (1, this->GetInputConnection(1, 0));
-  this->PolyDataIntersection->SplitFirstOutputOn();
-  this->PolyDataIntersection->SplitSecondOutputOn();
-  this->PolyDataIntersection->Update();
+  int numOperands = 1 + inputVector[1]->GetNumberOfInformationObjects();
+  if ( numOperands > 2 )
+    {
+    std::vector< vtkPolyData* > operands(numOperands);
+    operands[0] = input0;
+    for (int i = 1; i < numOperands; i++)
+      {
+      vtkInformation *inInfo = inputVector[1]->GetInformationObject(i-1);
+      operands[i] =
+        vtkPolyData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+      if ( !operands[i] )
+        {
+        return 0;
+        }
+      }
+
+    return this->ComputeMultipleOperands(&operands[0], numOperands,
+                                         outputSurface, outputIntersection);
+    }
+
+  return this->ComputeBoolean(input0, input1, outputSurface,
+                              outputIntersection);
+}
 
-  outputIntersection->CopyStructure(this->PolyDataIntersection->GetOutput());
-  outputIntersection->GetPointData()->PassData(this->PolyDataIntersection->GetOutput()->GetPointData());
-  outputIntersection->GetCellData()->PassData(this->PolyDataIntersection->GetOutput()->GetCellData());
+//-----------------------------------------------------------------------------
+int vtkBooleanOperationPolyDataFilter::ComputeBoolean(vtkPolyData *input0,
+                                                      vtkPolyData *input1,
+                                                      vtkPolyData *outputSurface,
+                                                      vtkPolyData *outputIntersection)
+{
+  if (!input0 || !input1 || !outputSurface || !outputIntersection)
+    {
+    return 0;
+    }
 
-  // Compute distances
-  this->PolyDataDistance->SetInputConnection
-    (0, this->PolyDataIntersection->GetOutputPort( 1 ));
-  this->PolyDataDistance->SetInputConnection
-    (1, this->PolyDataIntersection->GetOutputPort( 2 ));
-  this->PolyDataDistance->ComputeSecondDistanceOn();
-  this->PolyDataDistance->Update();
+  // Intersect, split and classify on one working mesh per input,
+  // calling the internal filters directly instead of running them as
+  // a pipeline. The intersection lines are written straight to the
+  // second output and the distances are added to the split meshes in
+  // place.
+  vtkSmartPointer< vtkPolyData > pd0 = vtkSmartPointer< vtkPolyData >::New();
+  vtkSmartPointer< vtkPolyData > pd1 = vtkSmartPointer< vtkPolyData >::New();
+
+  this->PolyDataIntersection->SplitFirstOutputOn();
+  this->PolyDataIntersection->SplitSecondOutputOn();
+  this->PolyDataIntersection->SetNumberOfThreads(this->NumberOfThreads);
+  this->PolyDataIntersection->SetCacheInputs(this->CacheInputs);
+  this->PolyDataIntersection->SetIntersectCoplanarTriangles(
+    this->IntersectCoplanarTriangles);
+  if ( !this->PolyDataIntersection->ComputeIntersection
+       (input0, input1, outputIntersection, pd0, pd1) )
+    {
+    return 0;
+    }
 
-  vtkPolyData* pd0 = this->PolyDataDistance->GetOutput();
-  vtkPolyData* pd1 = this->PolyDataDistance->GetSecondDistanceOutput();
+  if ( this->ClassificationMode == CLASSIFY_BY_DISTANCE )
+    {
+    // Compute distances
+    this->PolyDataDistance->SetNumberOfThreads(this->NumberOfThreads);
+    this->PolyDataDistance->SignedDistanceOn();
+    this->PolyDataDistance->NegateDistanceOff();
+    this->PolyDataDistance->GetPolyDataDistances(pd0, pd1, pd1, pd0);
+    }
 
   pd0->BuildCells();
   pd0->BuildLinks();
@@ -157,7 +606,24 @@ int vtkBooleanOperationPolyDataFilter::RequestData(vtkInformation*        vtkNot
   vtkSmartPointer< vtkIdList > interList = vtkSmartPointer< vtkIdList >::New();
   vtkSmartPointer< vtkIdList > unionList = vtkSmartPointer< vtkIdList >::New();
 
-  this->SortPolyData(pd0, interList, unionList);
+  if ( this->ClassificationMode == CLASSIFY_BY_WINDING_NUMBER )
+    {
+    this->SortPolyDataByWindingNumber(pd0, pd1, interList, unionList);
+    }
+  else if ( this->ClassificationMode == CLASSIFY_BY_REGION_GROWING )
+    {
+    this->SortPolyDataByRegion
+      (pd0, pd1, this->PolyDataIntersection->GetFirstSplitPointId(0),
+       interList, unionList);
+    }
+  else
+    {
+    this->SortPolyData(pd0, interList, unionList);
+    }
+  if ( this->IntersectCoplanarTriangles )
+    {
+    this->SortCoplanarCells(pd0, pd1, 0, interList, unionList);
+    }
 
   outputSurface->Allocate(pd0);
   outputSurface->GetPointData()->CopyAllocate(pointFields);
@@ -198,7 +664,24 @@ int vtkBooleanOperationPolyDataFilter::RequestData(vtkInformation*        vtkNot
   interList->Reset();
   unionList->Reset();
 
-  this->SortPolyData(pd1, interList, unionList);
+  if ( this->ClassificationMode == CLASSIFY_BY_WINDING_NUMBER )
+    {
+    this->SortPolyDataByWindingNumber(pd1, pd0, interList, unionList);
+    }
+  else if ( this->ClassificationMode == CLASSIFY_BY_REGION_GROWING )
+    {
+    this->SortPolyDataByRegion
+      (pd1, pd0, this->PolyDataIntersection->GetFirstSplitPointId(1),
+       interList, unionList);
+    }
+  else
+    {
+    this->SortPolyData(pd1, interList, unionList);
+    }
+  if ( this->IntersectCoplanarTriangles )
+    {
+    this->SortCoplanarCells(pd1, pd0, 1, interList, unionList);
+    }
 
   if ( this->Operation == UNION )
     {
@@ -238,118 +721,921 @@ int vtkBooleanOperationPolyDataFilter::RequestData(vtkInformation*        vtkNot
 }
 
 //-----------------------------------------------------------------------------
-void vtkBooleanOperationPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
+// Orders surfaces by the lower x bound of their bounding boxes.
+class vtkBooleanOperationBoundsLess
 {
-  this->Superclass::PrintSelf(os,indent);
-}
+public:
+  vtkBooleanOperationBoundsLess(const std::vector< double > &bounds) :
+    Bounds(bounds) {}
+
+  bool operator()(int a, int b) const
+  {
+    return this->Bounds[6*a] < this->Bounds[6*b];
+  }
+
+  const std::vector< double > &Bounds;
+};
 
 //-----------------------------------------------------------------------------
-int vtkBooleanOperationPolyDataFilter::FillInputPortInformation(int port, vtkInformation *info)
+// A segment of the intersection lines of two surfaces, given by its
+// welded point IDs, with the surfaces it lies on and the cell of each
+// that contains it.
+typedef struct _BooleanOperationSegment {
+  vtkIdType PointIds[2];
+  int       Surfaces[2];
+  vtkIdType CellIds[2];
+} BooleanOperationSegmentType;
+
+//-----------------------------------------------------------------------------
+// Returns whether the segments (a0, a1) and (b0, b1) pass within
+// tolerance of each other and, if so, the point halfway between their
+// closest points in x. Parallel segments are not considered crossing.
+static bool vtkBooleanOperationSegmentsCross(const double a0[3],
+                                             const double a1[3],
+                                             const double b0[3],
+                                             const double b1[3],
+                                             double tolerance, double x[3])
 {
-  if (!this->Superclass::FillInputPortInformation(port, info)) return 0;
-  if (port == 0)
+  double u[3], v[3], w[3];
+  for (int k = 0; k < 3; k++)
     {
-    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
+    u[k] = a1[k] - a0[k];
+    v[k] = b1[k] - b0[k];
+    w[k] = a0[k] - b0[k];
     }
-  else if (port == 1)
+  double uu = vtkMath::Dot(u, u);
+  double uv = vtkMath::Dot(u, v);
+  double vv = vtkMath::Dot(v, v);
+  double uw = vtkMath::Dot(u, w);
+  double vw = vtkMath::Dot(v, w);
+  double denom = uu*vv - uv*uv;
+  if ( uu <= 0.0 || vv <= 0.0 || denom <= 1e-12*uu*vv )
     {
-    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
-    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 0);
+    return false;
     }
-  return 1;
-}
-
-//-----------------------------------------------------------------------------
-void vtkBooleanOperationPolyDataFilter
-::CopyCells(vtkPolyData* in, vtkPolyData* out, int idx,
-            vtkDataSetAttributes::FieldList & pointFieldList,
-            vtkDataSetAttributes::FieldList & cellFieldList,
-            vtkIdList* cellIds, bool reverseCells)
-{
-  // Largely copied from vtkPolyData::CopyCells, but modified to
-  // use the special form of CopyData that uses a field list to
-  // determine which data values to copy over.
-
-  vtkPointData* outPD = out->GetPointData();
-  vtkCellData*  outCD = out->GetCellData();
 
-  vtkFloatArray *outNormals = NULL;
-  if ( reverseCells )
+  double s = (uv*vw - vv*uw) / denom;
+  double t = (uu*vw - uv*uw) / denom;
+  if ( s < 0.0 || s > 1.0 || t < 0.0 || t > 1.0 )
     {
-    outNormals = vtkFloatArray::SafeDownCast( outPD->GetArray("Normals") );
+    return false;
     }
 
-  vtkIdType numPts = in->GetNumberOfPoints();
-
-  if ( out->GetPoints() == NULL)
+  double pa[3], pb[3];
+  for (int k = 0; k < 3; k++)
     {
-    vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
-    out->SetPoints( points );
+    pa[k] = a0[k] + s*u[k];
+    pb[k] = b0[k] + t*v[k];
+    x[k] = 0.5*(pa[k] + pb[k]);
     }
+  return vtkMath::Distance2BetweenPoints(pa, pb) <= tolerance*tolerance;
+}
 
-  vtkPoints *newPoints = out->GetPoints();
+//-----------------------------------------------------------------------------
+// Orders the points of a segment by their distance to its first point.
+class vtkBooleanOperationDistanceLess
+{
+public:
+  vtkBooleanOperationDistanceLess(vtkPoints *points, vtkIdType origin) :
+    Points(points)
+  {
+    points->GetPoint(origin, this->Origin);
+  }
 
-  vtkSmartPointer< vtkIdList > pointMap = vtkSmartPointer< vtkIdList >::New();
-  pointMap->SetNumberOfIds( numPts );
-  for ( vtkIdType i = 0; i < numPts; i++ )
-    {
-    pointMap->SetId(i, -1);
-    }
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    return vtkMath::Distance2BetweenPoints(this->Points->GetPoint(a),
+                                           this->Origin) <
+      vtkMath::Distance2BetweenPoints(this->Points->GetPoint(b),
+                                      this->Origin);
+  }
 
-  // Filter the cells
-  vtkSmartPointer< vtkGenericCell > cell =
-    vtkSmartPointer< vtkGenericCell> ::New();
-  vtkSmartPointer< vtkIdList > newCellPts =
-    vtkSmartPointer< vtkIdList >::New();
-  for ( vtkIdType cellId = 0; cellId < cellIds->GetNumberOfIds(); cellId++ )
-    {
-    in->GetCell( cellIds->GetId( cellId ), cell );
-    vtkIdList *cellPts = cell->GetPointIds();
-    vtkIdType numCellPts = cell->GetNumberOfPoints();
+  vtkPoints *Points;
+  double     Origin[3];
+};
 
-    for ( vtkIdType i = 0; i < numCellPts; i++ )
+//-----------------------------------------------------------------------------
+// Segments of different pairs that lie in the same cell of a surface
+// cross where three surfaces meet, or end on each other. Splits them
+// at those points, which are welded into points by merger, so that
+// each surface is split along lines that meet at shared vertices
+// instead of crossing or forming T-junctions.
+static void vtkBooleanOperationSplitCrossingSegments(
+  int numSurfaces, std::vector< BooleanOperationSegmentType > &segments,
+  vtkPoints *points, vtkPointLocator *merger, double tolerance)
+{
+  size_t numSegments = segments.size();
+  std::vector< std::vector< vtkIdType > > splitIds(numSegments);
+  bool crossed = false;
+  for (int surface = 0; surface < numSurfaces; surface++)
+    {
+    // The segments on this surface, sorted by the cell containing them.
+    std::vector< std::pair< vtkIdType, size_t > > cellSegments;
+    for (size_t i = 0; i < numSegments; i++)
       {
-      vtkIdType ptId = cellPts->GetId( i );
-      vtkIdType newId = pointMap->GetId( ptId );
-      if ( newId < 0 )
+      for (int side = 0; side < 2; side++)
         {
-        double x[3];
-        in->GetPoint( ptId, x );
-        newId = newPoints->InsertNextPoint( x );
-        pointMap->SetId( ptId, newId );
-        outPD->CopyData( pointFieldList, in->GetPointData(), idx, ptId, newId );
-
-        if ( reverseCells && outNormals )
+        if ( segments[i].Surfaces[side] == surface )
           {
-          float normal[3];
-          outNormals->GetTupleValue( newId, normal );
-          normal[0] *= -1.0;
-          normal[1] *= -1.0;
-          normal[2] *= -1.0;
-          outNormals->SetTupleValue( newId, normal );
+          cellSegments.push_back
+            (std::make_pair(segments[i].CellIds[side], i));
           }
-
         }
-      newCellPts->InsertId( i, newId );
       }
-    if ( reverseCells )
+    std::sort(cellSegments.begin(), cellSegments.end());
+
+    for (size_t begin = 0, end = 0; begin < cellSegments.size(); begin = end)
       {
-      for (vtkIdType i = 0; i < newCellPts->GetNumberOfIds() / 2; i++)
+      for (end = begin; end < cellSegments.size() &&
+             cellSegments[end].first == cellSegments[begin].first; end++)
         {
-        vtkIdType i1 = i;
-        vtkIdType i2 = newCellPts->GetNumberOfIds()-i-1;
+        }
+
+      for (size_t m = begin; m < end; m++)
+        {
+        BooleanOperationSegmentType &a = segments[cellSegments[m].second];
+        int partnerA = a.Surfaces[0] + a.Surfaces[1] - surface;
+        for (size_t n = m + 1; n < end; n++)
+          {
+          BooleanOperationSegmentType &b = segments[cellSegments[n].second];
+          if ( b.Surfaces[0] + b.Surfaces[1] - surface == partnerA )
+            {
+            continue;
+            }
 
-        vtkIdType id = newCellPts->GetId( i1 );
-        newCellPts->SetId( i1, newCellPts->GetId( i2 ) );
-        newCellPts->SetId( i2, id );
+          double a0[3], a1[3], b0[3], b1[3], x[3];
+          points->GetPoint(a.PointIds[0], a0);
+          points->GetPoint(a.PointIds[1], a1);
+          points->GetPoint(b.PointIds[0], b0);
+          points->GetPoint(b.PointIds[1], b1);
+          if ( !vtkBooleanOperationSegmentsCross(a0, a1, b0, b1, tolerance,
+                                                 x) )
+            {
+            continue;
+            }
+
+          vtkIdType ptId;
+          merger->InsertUniquePoint(x, ptId);
+          if ( ptId != a.PointIds[0] && ptId != a.PointIds[1] )
+            {
+            splitIds[cellSegments[m].second].push_back(ptId);
+            crossed = true;
+            }
+          if ( ptId != b.PointIds[0] && ptId != b.PointIds[1] )
+            {
+            splitIds[cellSegments[n].second].push_back(ptId);
+            crossed = true;
+            }
+          }
         }
       }
+    }
 
-    vtkIdType newCellId = out->InsertNextCell( cell->GetCellType(), newCellPts );
-    outCD->CopyData( cellFieldList, in->GetCellData(), idx,
-                     cellIds->GetId( cellId ), newCellId );
-
-    newCellPts->Reset();
-    } // for all cells
+  if ( !crossed )
+    {
+    return;
+    }
+
+  // Replace each split segment by the pieces between its split
+  // points, in order along it. The pieces lie in the same cells.
+  std::vector< BooleanOperationSegmentType > pieces;
+  pieces.reserve(numSegments);
+  for (size_t i = 0; i < numSegments; i++)
+    {
+    std::vector< vtkIdType > &ids = splitIds[i];
+    if ( ids.empty() )
+      {
+      pieces.push_back(segments[i]);
+      continue;
+      }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::sort(ids.begin(), ids.end(),
+              vtkBooleanOperationDistanceLess(points,
+                                              segments[i].PointIds[0]));
+    ids.push_back(segments[i].PointIds[1]);
+
+    BooleanOperationSegmentType piece = segments[i];
+    for (size_t k = 0; k < ids.size(); k++)
+      {
+      piece.PointIds[1] = ids[k];
+      pieces.push_back(piece);
+      piece.PointIds[0] = ids[k];
+      }
+    }
+  segments.swap(pieces);
+}
+
+//-----------------------------------------------------------------------------
+int vtkBooleanOperationPolyDataFilter::ComputeMultipleOperands(vtkPolyData **operands,
+                                                  int numOperands,
+                                                  vtkPolyData *outputSurface,
+                                                  vtkPolyData *outputIntersection)
+{
+  if ( this->GetTransform() != NULL )
+    {
+    vtkErrorMacro(<< "Transform is not supported with more than two surfaces");
+    return 0;
+    }
+  if ( this->ClassificationMode == CLASSIFY_BY_REGION_GROWING )
+    {
+    vtkErrorMacro(<< "Region growing classification is not supported with "
+                  << "more than two surfaces");
+    return 0;
+    }
+
+  // Broad phase: sweep the bounding boxes along x. The boxes that the
+  // sweep has not left behind yet are tested against each new box on
+  // the other two axes. Empty surfaces overlap nothing.
+  std::vector< double > bounds(6*numOperands);
+  std::vector< int > order;
+  for (int i = 0; i < numOperands; i++)
+    {
+    operands[i]->GetBounds(&bounds[6*i]);
+    for (int k = 0; k < 6; k++)
+      {
+      bounds[6*i+k] += (k % 2 ? this->Tolerance : -this->Tolerance);
+      }
+    if ( operands[i]->GetNumberOfCells() > 0 )
+      {
+      order.push_back(i);
+      }
+    }
+  std::sort(order.begin(), order.end(), vtkBooleanOperationBoundsLess(bounds));
+
+  std::vector< std::vector< int > > neighbors(numOperands);
+  std::vector< int > active;
+  for (size_t k = 0; k < order.size(); k++)
+    {
+    int i = order[k];
+    const double *bi = &bounds[6*i];
+    size_t numActive = 0;
+    for (size_t a = 0; a < active.size(); a++)
+      {
+      int j = active[a];
+      const double *bj = &bounds[6*j];
+      if ( bj[1] < bi[0] )
+        {
+        continue;
+        }
+      active[numActive++] = j;
+      if ( bj[2] <= bi[3] && bi[2] <= bj[3] &&
+           bj[4] <= bi[5] && bi[4] <= bj[5] )
+        {
+        neighbors[i].push_back(j);
+        neighbors[j].push_back(i);
+        }
+      }
+    active.resize(numActive);
+    active.push_back(i);
+    }
+
+  // Surfaces that do not overlap the first one cannot remove anything
+  // from it. The intersection is empty as soon as two surfaces do not
+  // overlap.
+  std::vector< char > relevant(numOperands, 1);
+  if ( this->Operation == DIFFERENCE )
+    {
+    std::fill(relevant.begin(), relevant.end(), 0);
+    relevant[0] = 1;
+    for (size_t k = 0; k < neighbors[0].size(); k++)
+      {
+      relevant[neighbors[0][k]] = 1;
+      }
+    for (int i = 0; i < numOperands; i++)
+      {
+      std::vector< int > kept;
+      for (size_t k = 0; relevant[i] && k < neighbors[i].size(); k++)
+        {
+        if ( relevant[neighbors[i][k]] )
+          {
+          kept.push_back(neighbors[i][k]);
+          }
+        }
+      neighbors[i].swap(kept);
+      }
+    }
+  else if ( this->Operation == INTERSECTION )
+    {
+    for (int i = 0; i < numOperands; i++)
+      {
+      if ( static_cast<int>(neighbors[i].size()) != numOperands - 1 )
+        {
+        outputSurface->Initialize();
+        outputIntersection->Initialize();
+        return 1;
+        }
+      }
+    }
+
+  // Intersect each pair of overlapping surfaces once. Unless a locator
+  // cache is set, the OBB trees of the surfaces are pinned in a cache
+  // that lives for this execution only, so that each is built once.
+  vtkSmartPointer< vtkPolyDataLocatorCache > splitCache;
+  if ( this->GetLocatorCache() == NULL )
+    {
+    splitCache = vtkSmartPointer< vtkPolyDataLocatorCache >::New();
+    splitCache->SetMaximumNumberOfEntries(1);
+    for (int i = 0; i < numOperands; i++)
+      {
+      if ( relevant[i] && !neighbors[i].empty() )
+        {
+        splitCache->Pin(operands[i],
+                        vtkIntersectionPolyDataFilter::BuildLocatorCacheEntry);
+        }
+      }
+    this->PolyDataIntersection->SetLocatorCache(splitCache);
+    }
+
+  this->PolyDataIntersection->SplitFirstOutputOff();
+  this->PolyDataIntersection->SplitSecondOutputOff();
+  this->PolyDataIntersection->SetNumberOfThreads(this->NumberOfThreads);
+  this->PolyDataIntersection->SetCacheInputs(this->CacheInputs);
+  this->PolyDataIntersection->SetIntersectCoplanarTriangles(
+    this->IntersectCoplanarTriangles);
+
+  // The segment endpoints of all the pairs are welded into one set of
+  // points, so that the surfaces meeting along a seam are split at the
+  // same points.
+  double allBounds[6] = {VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+                         -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+  for (int i = 0; i < numOperands; i++)
+    {
+    for (int k = 0; k < 6; k += 2)
+      {
+      allBounds[k] = std::min(allBounds[k], bounds[6*i+k]);
+      allBounds[k+1] = std::max(allBounds[k+1], bounds[6*i+k+1]);
+      }
+    }
+  vtkSmartPointer< vtkPoints > linePoints = vtkSmartPointer< vtkPoints >::New();
+  linePoints->SetDataTypeToDouble();
+  vtkSmartPointer< vtkPointLocator > merger =
+    vtkSmartPointer< vtkPointLocator >::New();
+  merger->SetTolerance(this->Tolerance);
+  merger->InitPointInsertion(linePoints, allBounds);
+
+  std::vector< BooleanOperationSegmentType > segments;
+  bool intersected = true;
+  for (int i = 0; intersected && i < numOperands; i++)
+    {
+    for (size_t k = 0; intersected && k < neighbors[i].size(); k++)
+      {
+      int j = neighbors[i][k];
+      if ( j < i )
+        {
+        continue;
+        }
+
+      vtkSmartPointer< vtkPolyData > pairLines =
+        vtkSmartPointer< vtkPolyData >::New();
+      vtkSmartPointer< vtkPolyData > output0 =
+        vtkSmartPointer< vtkPolyData >::New();
+      vtkSmartPointer< vtkPolyData > output1 =
+        vtkSmartPointer< vtkPolyData >::New();
+      intersected = this->PolyDataIntersection->ComputeIntersection
+        (operands[i], operands[j], pairLines, output0, output1) != 0;
+      if ( !intersected )
+        {
+        break;
+        }
+
+      vtkIdTypeArray *cellIds0 = vtkIdTypeArray::SafeDownCast
+        (pairLines->GetCellData()->GetArray("Input0CellID"));
+      vtkIdTypeArray *cellIds1 = vtkIdTypeArray::SafeDownCast
+        (pairLines->GetCellData()->GetArray("Input1CellID"));
+      std::vector< vtkIdType > pointIds(pairLines->GetNumberOfPoints());
+      for (vtkIdType p = 0; p < pairLines->GetNumberOfPoints(); p++)
+        {
+        merger->InsertUniquePoint(pairLines->GetPoint(p), pointIds[p]);
+        }
+
+      vtkCellArray *pairCells = pairLines->GetLines();
+      vtkIdType npts, *pts;
+      vtkIdType lineId = 0;
+      for (pairCells->InitTraversal(); pairCells->GetNextCell(npts, pts);
+           lineId++)
+        {
+        BooleanOperationSegmentType segment;
+        if ( npts != 2 || pointIds[pts[0]] == pointIds[pts[1]] )
+          {
+          continue;
+          }
+        segment.PointIds[0] = pointIds[pts[0]];
+        segment.PointIds[1] = pointIds[pts[1]];
+        segment.Surfaces[0] = i;
+        segment.Surfaces[1] = j;
+        segment.CellIds[0] = cellIds0->GetValue(lineId);
+        segment.CellIds[1] = cellIds1->GetValue(lineId);
+        segments.push_back(segment);
+        }
+      }
+    }
+
+  this->PolyDataIntersection->SplitFirstOutputOn();
+  this->PolyDataIntersection->SplitSecondOutputOn();
+  if ( splitCache != NULL )
+    {
+    this->PolyDataIntersection->SetLocatorCache(NULL);
+    }
+  if ( !intersected )
+    {
+    return 0;
+    }
+
+  vtkBooleanOperationSplitCrossingSegments(numOperands, segments, linePoints,
+                                           merger, this->Tolerance);
+
+  vtkSmartPointer< vtkCellArray > lines = vtkSmartPointer< vtkCellArray >::New();
+  for (size_t s = 0; s < segments.size(); s++)
+    {
+    lines->InsertNextCell(2, segments[s].PointIds);
+    }
+  outputIntersection->Initialize();
+  outputIntersection->SetPoints(linePoints);
+  outputIntersection->SetLines(lines);
+
+  // Split each surface once along all the segments on it. The cells of
+  // a surface that is not split are built on a copy, so the input is
+  // left untouched.
+  std::vector< vtkSmartPointer< vtkPolyData > > meshes(numOperands);
+  std::vector< vtkIdType > localIds(linePoints->GetNumberOfPoints(), -1);
+  bool split = true;
+  for (int i = 0; split && i < numOperands; i++)
+    {
+    vtkSmartPointer< vtkPoints > meshPoints = vtkSmartPointer< vtkPoints >::New();
+    meshPoints->SetDataTypeToDouble();
+    vtkSmartPointer< vtkCellArray > meshCells =
+      vtkSmartPointer< vtkCellArray >::New();
+    vtkSmartPointer< vtkIdTypeArray > meshCellIds =
+      vtkSmartPointer< vtkIdTypeArray >::New();
+    std::vector< vtkIdType > usedIds;
+    for (size_t s = 0; s < segments.size(); s++)
+      {
+      for (int side = 0; side < 2; side++)
+        {
+        if ( segments[s].Surfaces[side] != i )
+          {
+          continue;
+          }
+        vtkIdType ids[2];
+        for (int e = 0; e < 2; e++)
+          {
+          vtkIdType ptId = segments[s].PointIds[e];
+          if ( localIds[ptId] < 0 )
+            {
+            localIds[ptId] =
+              meshPoints->InsertNextPoint(linePoints->GetPoint(ptId));
+            usedIds.push_back(ptId);
+            }
+          ids[e] = localIds[ptId];
+          }
+        meshCells->InsertNextCell(2, ids);
+        meshCellIds->InsertNextValue(segments[s].CellIds[side]);
+        }
+      }
+    for (size_t k = 0; k < usedIds.size(); k++)
+      {
+      localIds[usedIds[k]] = -1;
+      }
+
+    meshes[i] = vtkSmartPointer< vtkPolyData >::New();
+    if ( meshCells->GetNumberOfCells() == 0 )
+      {
+      meshes[i]->ShallowCopy(operands[i]);
+      continue;
+      }
+
+    vtkSmartPointer< vtkPolyData > meshLines =
+      vtkSmartPointer< vtkPolyData >::New();
+    meshLines->SetPoints(meshPoints);
+    meshLines->SetLines(meshCells);
+    split = this->PolyDataIntersection->SplitAlongLines
+      (operands[i], meshLines, meshCellIds, meshes[i]) != 0;
+    }
+  if ( !split )
+    {
+    return 0;
+    }
+
+  // Set up field lists of both points and cells that are shared by
+  // the surfaces that contribute to the output.
+  vtkDataSetAttributes::FieldList pointFields(numOperands);
+  vtkDataSetAttributes::FieldList cellFields(numOperands);
+  std::vector< int > fieldIndex(numOperands, -1);
+  int numFields = 0;
+  for (int i = 0; i < numOperands; i++)
+    {
+    if ( !relevant[i] )
+      {
+      continue;
+      }
+    meshes[i]->BuildCells();
+    if ( numFields == 0 )
+      {
+      pointFields.InitializeFieldList( meshes[i]->GetPointData() );
+      cellFields.InitializeFieldList( meshes[i]->GetCellData() );
+      }
+    else
+      {
+      pointFields.IntersectFieldList( meshes[i]->GetPointData() );
+      cellFields.IntersectFieldList( meshes[i]->GetCellData() );
+      }
+    fieldIndex[i] = numFields++;
+    }
+
+  outputSurface->Initialize();
+  outputSurface->Allocate(meshes[0]);
+  outputSurface->GetPointData()->CopyAllocate(pointFields);
+  outputSurface->GetCellData()->CopyAllocate(cellFields);
+
+  vtkSmartPointer< vtkIntArray > pointSourceLabel =
+    vtkSmartPointer< vtkIntArray >::New();
+  pointSourceLabel->SetName("PointSource");
+  vtkSmartPointer< vtkIntArray > cellSourceLabel =
+    vtkSmartPointer< vtkIntArray >::New();
+  cellSourceLabel->SetName("CellSource");
+
+  // Classify each cell center against all the surfaces overlapping its
+  // surface in one pass. A center outside the bounding box of a surface
+  // is outside of it without evaluation. The implicit function of each
+  // surface is built once, when first needed.
+  //
+  // With IntersectCoplanarTriangles on, a cell lying on a cell of
+  // another surface is classified the way SortCoplanarCells() sorts
+  // the two surfaces of the binary operation, so that a shared patch
+  // comes out once or not at all. Where the normals point the same
+  // way, the lower surface counts as outside the higher one and the
+  // higher as inside the lower for a union, and the reverse for an
+  // intersection or a difference with the first surface. Where they
+  // point opposite ways, the cells count as inside each other for a
+  // union and outside otherwise. The cutters of a difference are
+  // sorted among themselves as for a union.
+  std::vector< vtkSmartPointer< vtkImplicitFunction > > functions(numOperands);
+  std::vector< vtkSmartPointer< vtkCellLocator > > coplanarLocators(numOperands);
+  std::vector< signed char > orientation;
+  double insideValue =
+    this->ClassificationMode == CLASSIFY_BY_WINDING_NUMBER ?
+    0.5 - this->WindingNumberThreshold : this->Tolerance;
+  vtkSmartPointer< vtkIdList > cellIds = vtkSmartPointer< vtkIdList >::New();
+  for (int i = 0; i < numOperands; i++)
+    {
+    if ( !relevant[i] )
+      {
+      continue;
+      }
+
+    vtkPolyData *mesh = meshes[i];
+    vtkIdType numCells = mesh->GetNumberOfCells();
+    std::vector< double > centers(3*numCells, 0.0);
+    vtkIdType npts, *pts;
+    for (vtkIdType cid = 0; cid < numCells; cid++)
+      {
+      mesh->GetCellPoints(cid, npts, pts);
+      for (vtkIdType p = 0; p < npts; p++)
+        {
+        double x[3];
+        mesh->GetPoint(pts[p], x);
+        for (int k = 0; k < 3; k++)
+          {
+          centers[3*cid+k] += x[k] / npts;
+          }
+        }
+      }
+
+    std::vector< int > insideCount(numCells, 0);
+    std::vector< char > insideFirst(numCells, 0);
+    for (size_t n = 0; n < neighbors[i].size(); n++)
+      {
+      int j = neighbors[i][n];
+      const double *bj = &bounds[6*j];
+      std::vector< vtkIdType > candidates;
+      vtkSmartPointer< vtkDoubleArray > candidateCenters =
+        vtkSmartPointer< vtkDoubleArray >::New();
+      candidateCenters->SetNumberOfComponents(3);
+      for (vtkIdType cid = 0; cid < numCells; cid++)
+        {
+        const double *c = &centers[3*cid];
+        if ( c[0] >= bj[0] && c[0] <= bj[1] && c[1] >= bj[2] &&
+             c[1] <= bj[3] && c[2] >= bj[4] && c[2] <= bj[5] )
+          {
+          candidates.push_back(cid);
+          candidateCenters->InsertNextTuple(c);
+          }
+        }
+      if ( candidates.empty() )
+        {
+        continue;
+        }
+
+      if ( functions[j] == NULL )
+        {
+        if ( this->ClassificationMode == CLASSIFY_BY_WINDING_NUMBER )
+          {
+          vtkSmartPointer< vtkImplicitWindingNumber > imp =
+            vtkSmartPointer< vtkImplicitWindingNumber >::New();
+          imp->SetNumberOfThreads(this->NumberOfThreads);
+          imp->SetInput(operands[j]);
+          functions[j] = imp.GetPointer();
+          }
+        else
+          {
+          vtkSmartPointer< vtkImplicitPolyData > imp =
+            vtkSmartPointer< vtkImplicitPolyData >::New();
+          imp->SetNumberOfThreads(this->NumberOfThreads);
+          imp->SetLocatorCache(this->GetLocatorCache());
+          imp->SetInput(operands[j]);
+          functions[j] = imp.GetPointer();
+          }
+        }
+
+      vtkSmartPointer< vtkDoubleArray > values =
+        vtkSmartPointer< vtkDoubleArray >::New();
+      functions[j]->FunctionValue(candidateCenters, values);
+
+      bool coplanar = false;
+      if ( this->IntersectCoplanarTriangles )
+        {
+        if ( coplanarLocators[j] == NULL )
+          {
+          coplanarLocators[j] = vtkSmartPointer< vtkCellLocator >::New();
+          coplanarLocators[j]->SetDataSet(meshes[j]);
+          coplanarLocators[j]->BuildLocator();
+          }
+        coplanar = vtkBooleanOperationFindCoplanarCells
+          (mesh, meshes[j], coplanarLocators[j], this->Tolerance, orientation);
+        }
+      bool unionLike = this->Operation == UNION ||
+        ( this->Operation == DIFFERENCE && i > 0 && j > 0 );
+
+      for (size_t c = 0; c < candidates.size(); c++)
+        {
+        bool inside = values->GetValue(c) <= insideValue;
+        if ( coplanar && orientation[candidates[c]] != 0 )
+          {
+          inside = orientation[candidates[c]] > 0 ?
+            ( unionLike ? i > j : i < j ) : unionLike;
+          }
+        if ( inside )
+          {
+          insideCount[candidates[c]]++;
+          if ( j == 0 )
+            {
+            insideFirst[candidates[c]] = 1;
+            }
+          }
+        }
+      }
+
+    // Union keeps the cells outside all the other surfaces and
+    // intersection those inside all of them. Difference keeps the
+    // cells of the first surface outside all the others, and the cells
+    // of the others inside the first surface only.
+    cellIds->Reset();
+    for (vtkIdType cid = 0; cid < numCells; cid++)
+      {
+      bool keep;
+      if ( this->Operation == UNION )
+        {
+        keep = insideCount[cid] == 0;
+        }
+      else if ( this->Operation == INTERSECTION )
+        {
+        keep = insideCount[cid] == numOperands - 1;
+        }
+      else if ( i == 0 )
+        {
+        keep = insideCount[cid] == 0;
+        }
+      else
+        {
+        keep = insideFirst[cid] && insideCount[cid] == 1;
+        }
+      if ( keep )
+        {
+        cellIds->InsertNextId(cid);
+        }
+      }
+
+    this->CopyCells(mesh, outputSurface, fieldIndex[i], pointFields,
+                    cellFields, cellIds,
+                    (this->ReorientDifferenceCells == 1 &&
+                     this->Operation == DIFFERENCE && i > 0));
+
+    for (vtkIdType p = pointSourceLabel->GetNumberOfTuples();
+         p < outputSurface->GetNumberOfPoints(); p++)
+      {
+      pointSourceLabel->InsertValue(p, i);
+      }
+    for (vtkIdType c = cellSourceLabel->GetNumberOfTuples();
+         c < outputSurface->GetNumberOfCells(); c++)
+      {
+      cellSourceLabel->InsertValue(c, i);
+      }
+    }
+
+  outputSurface->GetPointData()->AddArray(pointSourceLabel);
+  outputSurface->GetCellData()->AddArray(cellSourceLabel);
+
+  outputSurface->Squeeze();
+  outputSurface->GetPointData()->Squeeze();
+  outputSurface->GetCellData()->Squeeze();
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "ClassificationMode: " << this->ClassificationMode << "\n";
+  os << indent << "WindingNumberThreshold: "
+     << this->WindingNumberThreshold << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "CacheInputs: " << this->CacheInputs << "\n";
+  os << indent << "IntersectCoplanarTriangles: "
+     << this->IntersectCoplanarTriangles << "\n";
+  os << indent << "Transform: " << this->GetTransform() << "\n";
+  os << indent << "LocatorCache: " << this->GetLocatorCache() << "\n";
+}
+
+//-----------------------------------------------------------------------------
+int vtkBooleanOperationPolyDataFilter::FillInputPortInformation(int port, vtkInformation *info)
+{
+  if (!this->Superclass::FillInputPortInformation(port, info)) return 0;
+  if (port == 0)
+    {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
+    }
+  else if (port == 1)
+    {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 0);
+    info->Set(vtkAlgorithm::INPUT_IS_REPEATABLE(), 1);
+    }
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+// Appends the tuples ids of the arrays of inData to the arrays of
+// outData, starting at tuple outStart. Arrays are paired through the
+// field list exactly as vtkDataSetAttributes::CopyData() pairs them,
+// so attribute arrays are matched by attribute type and other arrays
+// by name. Numeric arrays of the same type and number of components
+// are copied as raw bytes; any other pair is copied tuple by tuple.
+static void vtkBooleanOperationGatherTuples(vtkDataSetAttributes *inData,
+                                            vtkDataSetAttributes *outData,
+                                            vtkDataSetAttributes::FieldList &list,
+                                            int idx, vtkIdType outStart,
+                                            const std::vector< vtkIdType > &ids)
+{
+  vtkIdType numIds = static_cast<vtkIdType>(ids.size());
+  for (int i = 0; i < list.GetNumberOfFields(); i++)
+    {
+    int outIndex = list.GetFieldIndex(i);
+    int inIndex = list.GetDSAIndex(idx, i);
+    if ( outIndex < 0 || inIndex < 0 )
+      {
+      continue;
+      }
+    vtkAbstractArray *outArray = outData->GetAbstractArray(outIndex);
+    vtkAbstractArray *inArray = inData->GetAbstractArray(inIndex);
+    if ( outArray == NULL || inArray == NULL )
+      {
+      continue;
+      }
+
+    int numComps = outArray->GetNumberOfComponents();
+    if ( !inArray->IsNumeric() || !outArray->IsNumeric() ||
+         inArray->GetDataType() != outArray->GetDataType() ||
+         inArray->GetNumberOfComponents() != numComps )
+      {
+      for (vtkIdType j = 0; j < numIds; j++)
+        {
+        outArray->InsertTuple(outStart + j, ids[j], inArray);
+        }
+      continue;
+      }
+
+    size_t tupleSize = numComps * outArray->GetDataTypeSize();
+    const char *src = static_cast<const char*>(inArray->GetVoidPointer(0));
+    char *dst = static_cast<char*>
+      (outArray->WriteVoidPointer(outStart * numComps, numIds * numComps));
+    for (vtkIdType j = 0; j < numIds; j++)
+      {
+      memcpy(dst + j*tupleSize, src + ids[j]*tupleSize, tupleSize);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkBooleanOperationPolyDataFilter
+::CopyCells(vtkPolyData* in, vtkPolyData* out, int idx,
+            vtkDataSetAttributes::FieldList & pointFieldList,
+            vtkDataSetAttributes::FieldList & cellFieldList,
+            vtkIdList* cellIds, bool reverseCells)
+{
+  // Largely copied from vtkPolyData::CopyCells, but modified to copy
+  // the points and cells in two passes. The first pass numbers the
+  // points used by the selected cells in the order the cells use
+  // them, as vtkPolyData::CopyCells does; the second gathers the
+  // coordinates, point data and cell data of the selected points and
+  // cells in bulk. The field lists determine which data arrays are
+  // copied over.
+
+  vtkPointData* outPD = out->GetPointData();
+  vtkCellData*  outCD = out->GetCellData();
+  vtkIdType numPts = in->GetNumberOfPoints();
+  vtkIdType numCells = cellIds->GetNumberOfIds();
+
+  if ( out->GetPoints() == NULL)
+    {
+    vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+    points->SetDataType( in->GetPoints()->GetDataType() );
+    out->SetPoints( points );
+    }
+
+  vtkPoints *newPoints = out->GetPoints();
+  vtkIdType ptOffset = newPoints->GetNumberOfPoints();
+
+  // Pass 1: number the used points in the order they are first met.
+  std::vector< vtkIdType > pointMap( numPts, -1 );
+  std::vector< vtkIdType > usedPts;
+  vtkIdType numNewPts = 0;
+  vtkIdType npts, *pts;
+  for ( vtkIdType i = 0; i < numCells; i++ )
+    {
+    in->GetCellPoints( cellIds->GetId( i ), npts, pts );
+    for ( vtkIdType j = 0; j < npts; j++ )
+      {
+      if ( pointMap[pts[j]] < 0 )
+        {
+        pointMap[pts[j]] = ptOffset + numNewPts++;
+        usedPts.push_back( pts[j] );
+        }
+      }
+    }
+
+  // Pass 2: gather the points and their data.
+  vtkDataArray *inCoords = in->GetPoints()->GetData();
+  vtkDataArray *outCoords = newPoints->GetData();
+  if ( inCoords->GetDataType() == outCoords->GetDataType() )
+    {
+    size_t tupleSize = 3 * inCoords->GetDataTypeSize();
+    const char *src = static_cast<const char*>(inCoords->GetVoidPointer(0));
+    char *dst = static_cast<char*>
+      (outCoords->WriteVoidPointer(3*ptOffset, 3*numNewPts));
+    for ( vtkIdType i = 0; i < numNewPts; i++ )
+      {
+      memcpy(dst + i*tupleSize, src + usedPts[i]*tupleSize, tupleSize);
+      }
+    newPoints->Modified();
+    }
+  else
+    {
+    for ( vtkIdType i = 0; i < numNewPts; i++ )
+      {
+      newPoints->InsertPoint( ptOffset + i, in->GetPoint( usedPts[i] ) );
+      }
+    }
+
+  vtkBooleanOperationGatherTuples( in->GetPointData(), outPD, pointFieldList,
+                                   idx, ptOffset, usedPts );
+
+  vtkFloatArray *outNormals = NULL;
+  if ( reverseCells )
+    {
+    outNormals = vtkFloatArray::SafeDownCast( outPD->GetArray("Normals") );
+    }
+  if ( outNormals && outNormals->GetNumberOfComponents() == 3 )
+    {
+    float *normals = outNormals->GetPointer( 3*ptOffset );
+    for ( vtkIdType i = 0; i < 3*numNewPts; i++ )
+      {
+      normals[i] = -normals[i];
+      }
+    }
+
+  // Emit the cells with remapped, and possibly reversed, point ids.
+  std::vector< vtkIdType > newCellPts;
+  std::vector< vtkIdType > selectedCells( numCells );
+  vtkIdType cellOffset = out->GetNumberOfCells();
+  for ( vtkIdType i = 0; i < numCells; i++ )
+    {
+    vtkIdType cellId = cellIds->GetId( i );
+    selectedCells[i] = cellId;
+    in->GetCellPoints( cellId, npts, pts );
+    newCellPts.resize( npts );
+    for ( vtkIdType j = 0; j < npts; j++ )
+      {
+      newCellPts[reverseCells ? npts-j-1 : j] = pointMap[pts[j]];
+      }
+
+    out->InsertNextCell( in->GetCellType( cellId ), npts,
+                         npts > 0 ? &newCellPts[0] : NULL );
+    }
 
+  vtkBooleanOperationGatherTuples( in->GetCellData(), outCD, cellFieldList,
+                                   idx, cellOffset, selectedCells );
 }
@@ -23,6 +23,23 @@
 // contains a set of polylines that represent the intersection between
 // the two input surfaces.
 //
+// More than one surface may be connected to the second input port with
+// AddInputConnection(1, ...). The operation is then applied to all the
+// surfaces at once: the union or intersection of all of them, or the
+// first input minus all the others. The bounding boxes of the surfaces
+// are sorted and swept to find the pairs that may intersect, each such
+// pair is intersected once, each surface is split once along all the
+// intersection lines on it, and each of its cells is classified
+// against all the overlapping surfaces at once, so the cost does not
+// grow with the length of a chain of binary filters. The lines of all
+// the pairs share their points, and are split where they cross, so
+// the surfaces meeting along a seam are split at the same points.
+// The second output then holds the intersection lines of all the
+// pairs, without the "Input0CellID" and "Input1CellID" arrays, and the
+// "PointSource" and "CellSource" arrays hold the index of the surface,
+// the first input being 0. Transform and CLASSIFY_BY_REGION_GROWING
+// are not supported in this case.
+//
 // Written by Chris Weigle and Cory Quammen, The University of North
 // Carolina at Chapel Hill.
 
@@ -36,6 +53,8 @@
 class vtkIdList;
 class vtkDistancePolyDataFilter;
 class vtkIntersectionPolyDataFilter;
+class vtkLinearTransform;
+class vtkPolyDataLocatorCache;
 
 
 class vtkBooleanOperationPolyDataFilter : public vtkPolyDataAlgorithm
@@ -81,6 +100,110 @@ public:
   vtkSetMacro(Tolerance, double);
   vtkGetMacro(Tolerance, double);
 
+  enum ClassificationModes
+  {
+    CLASSIFY_BY_DISTANCE=0,
+    CLASSIFY_BY_REGION_GROWING,
+    CLASSIFY_BY_WINDING_NUMBER
+  };
+
+  // Description:
+  // Set/get how the cells of the split surfaces are classified as
+  // inside or outside the other surface. CLASSIFY_BY_DISTANCE
+  // evaluates the signed distance at every point and cell center of
+  // both surfaces. CLASSIFY_BY_REGION_GROWING evaluates the signed
+  // distance only at the centers of the cells touching the
+  // intersection lines, then labels the remaining cells by flood
+  // filling through edges that are not on the intersection lines,
+  // with at most one distance evaluation per region.
+  // CLASSIFY_BY_WINDING_NUMBER evaluates the generalized winding
+  // number of the other surface at every cell center with
+  // vtkImplicitWindingNumber, which needs no closest-point search and
+  // tolerates small holes in the surfaces. The last two modes do not
+  // add the "Distance" arrays to the output. CLASSIFY_BY_REGION_GROWING
+  // is an error with more than two surfaces. Defaults to
+  // CLASSIFY_BY_DISTANCE.
+  vtkSetClampMacro( ClassificationMode, int, CLASSIFY_BY_DISTANCE,
+                    CLASSIFY_BY_WINDING_NUMBER );
+  vtkGetMacro( ClassificationMode, int );
+  void SetClassificationModeToDistance()
+  { this->SetClassificationMode( CLASSIFY_BY_DISTANCE ); }
+  void SetClassificationModeToRegionGrowing()
+  { this->SetClassificationMode( CLASSIFY_BY_REGION_GROWING ); }
+  void SetClassificationModeToWindingNumber()
+  { this->SetClassificationMode( CLASSIFY_BY_WINDING_NUMBER ); }
+
+  // Description:
+  // Set/get the winding number from which a cell center is considered
+  // inside the other surface in CLASSIFY_BY_WINDING_NUMBER mode. The
+  // winding number is about 1 inside and 0 outside a closed surface;
+  // lower the threshold to treat cells seen through a hole as inside.
+  // Tolerance is not used in this mode. Defaults to 0.5.
+  vtkSetClampMacro( WindingNumberThreshold, double, 0.0, 1.0 );
+  vtkGetMacro( WindingNumberThreshold, double );
+
+  // Description:
+  // Set/get the number of threads used by the internal filters.
+  // Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Set/get a transform applied to the second input before the
+  // operation is performed. See
+  // vtkIntersectionPolyDataFilter::SetTransform(). Defaults to NULL.
+  void SetTransform(vtkLinearTransform *transform);
+  vtkLinearTransform* GetTransform();
+
+  // Description:
+  // If on, the OBB trees and cell links of the inputs are kept between
+  // executions and reused while the inputs do not change. Combined
+  // with Transform, moving the second input only requires a new
+  // transform. Defaults to off.
+  vtkSetMacro(CacheInputs, int);
+  vtkGetMacro(CacheInputs, int);
+  vtkBooleanMacro(CacheInputs, int);
+
+  // Description:
+  // If on, overlapping coplanar cells of the inputs are split along
+  // the boundary of their overlap. See
+  // vtkIntersectionPolyDataFilter::SetIntersectCoplanarTriangles().
+  // The cells of the overlap are then classified by the relative
+  // orientation of their normals instead of their distance, which is
+  // zero: one copy is kept where the normals agree for a union or an
+  // intersection, and where they are opposite for a difference. With
+  // more than two surfaces, each cell lying on a cell of another
+  // surface is classified against that surface the same way. Defaults
+  // to off.
+  vtkSetMacro(IntersectCoplanarTriangles, int);
+  vtkGetMacro(IntersectCoplanarTriangles, int);
+  vtkBooleanMacro(IntersectCoplanarTriangles, int);
+
+  // Description:
+  // Set/get a cache for the OBB trees built over the inputs. See
+  // vtkIntersectionPolyDataFilter::SetLocatorCache(). The cache is only
+  // used by the intersection stage; the distance stage works on the
+  // split meshes, which are new at every execution. Defaults to NULL.
+  void SetLocatorCache(vtkPolyDataLocatorCache *cache);
+  vtkPolyDataLocatorCache* GetLocatorCache();
+
+  // Description:
+  // Return the MTime also considering the Transform.
+  unsigned long GetMTime();
+
+  // Description:
+  // Computes the operation on input0 and input1 directly, without
+  // going through the pipeline. outputSurface and outputIntersection
+  // receive the contents of the two output ports. The inputs are not
+  // modified, but they are shallow copied, which changes the reference
+  // counts of their points, cells and arrays without a lock. Separate
+  // instances of this filter may only be run from several threads on
+  // inputs that share none of these, such as deep copies. Returns 1 on
+  // success, 0 otherwise.
+  int ComputeBoolean(vtkPolyData *input0, vtkPolyData *input1,
+                     vtkPolyData *outputSurface,
+                     vtkPolyData *outputIntersection);
+
 protected:
   vtkBooleanOperationPolyDataFilter();
   ~vtkBooleanOperationPolyDataFilter();
@@ -95,6 +218,44 @@ protected:
   void SortPolyData(vtkPolyData* input, vtkIdList* intersectionList,
                     vtkIdList* unionList);
 
+  // Description:
+  // Same as SortPolyData(), but classifies the cells against the
+  // surface other by region growing. Points of input with IDs of at
+  // least firstSplitPtId lie on the intersection lines, see
+  // vtkIntersectionPolyDataFilter::GetFirstSplitPointId().
+  void SortPolyDataByRegion(vtkPolyData* input, vtkPolyData* other,
+                            vtkIdType firstSplitPtId,
+                            vtkIdList* intersectionList,
+                            vtkIdList* unionList);
+
+  // Description:
+  // Same as SortPolyData(), but classifies the cells by the winding
+  // number of the surface other around their centers.
+  void SortPolyDataByWindingNumber(vtkPolyData* input, vtkPolyData* other,
+                                   vtkIdList* intersectionList,
+                                   vtkIdList* unionList);
+
+  // Description:
+  // Moves the cells of input that lie on a cell of other, with a
+  // parallel normal, between the lists. inputIndex is 0 for the first
+  // input and 1 for the second. Where the normals point the same way,
+  // the cells of the first input are kept by a union or an
+  // intersection and dropped by a difference. Where they point
+  // opposite ways, they are kept by a difference only. The cells of
+  // the second input are always dropped, so that each patch comes
+  // out at most once.
+  void SortCoplanarCells(vtkPolyData* input, vtkPolyData* other,
+                         int inputIndex, vtkIdList* intersectionList,
+                         vtkIdList* unionList);
+
+  // Description:
+  // Applies the operation to the numOperands surfaces in operands at
+  // once. Called by RequestData() when more than one surface is
+  // connected to the second input port.
+  int ComputeMultipleOperands(vtkPolyData **operands, int numOperands,
+                              vtkPolyData *outputSurface,
+                              vtkPolyData *outputIntersection);
+
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
   int FillInputPortInformation(int, vtkInformation*);
 
@@ -107,6 +268,25 @@ protected:
   // reversed in the difference surface.
   int ReorientDifferenceCells;
 
+  // Description:
+  // How cells are classified as inside or outside the other surface.
+  int ClassificationMode;
+  double WindingNumberThreshold;
+
+  // Description:
+  // Number of threads used by the internal filters.
+  int NumberOfThreads;
+
+  // Description:
+  // Whether the internal intersection filter keeps its acceleration
+  // structures between executions.
+  int CacheInputs;
+
+  // Description:
+  // Whether the internal intersection filter splits overlapping
+  // coplanar cells.
+  int IntersectCoplanarTriangles;
+
 private:
   vtkBooleanOperationPolyDataFilter(const vtkBooleanOperationPolyDataFilter&); // no implementation
   void operator=(const vtkBooleanOperationPolyDataFilter&); // no implementation
@@ -0,0 +1,879 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCSGTreePolyDataFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCSGTreePolyDataFilter.h"
+
+#include "vtkAppendPolyData.h"
+#include "vtkBooleanOperationPolyDataFilter.h"
+#include "vtkConditionVariable.h"
+#include "vtkIdList.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+vtkStandardNewMacro(vtkCSGTreePolyDataFilter);
+
+//-----------------------------------------------------------------------------
+// Nodes of the expression. Leaves have a surface, an Operation of -1
+// and no children.
+class vtkCSGTreePolyDataFilter::Expression
+{
+public:
+  class Node
+  {
+  public:
+    int                            Operation;
+    vtkSmartPointer< vtkPolyData > Surface;
+    std::vector< int >             Children;
+  };
+
+  std::vector< Node > Nodes;
+};
+
+
+//-----------------------------------------------------------------------------
+// One step of the evaluation. The result of a VALUE is known when the
+// schedule is planned; BOOLEAN and APPEND steps are run once all their
+// inputs are available.
+class vtkCSGTreeTask
+{
+public:
+  enum Kinds
+  {
+    VALUE=0,
+    BOOLEAN,
+    APPEND
+  };
+
+  vtkCSGTreeTask() : Kind(VALUE), Operation(0), Pending(0), Empty(false),
+                     Size(0.0) {}
+
+  int                            Kind;
+  int                            Operation;
+  std::vector< int >             Inputs;
+  std::vector< int >             Dependents;
+  int                            Pending;
+
+  // Bounding box of the result, padded by the tolerance. Empty results
+  // have no bounding box.
+  bool                           Empty;
+  double                         Bounds[6];
+  double                         Size;
+
+  vtkSmartPointer< vtkPolyData > Result;
+
+  // Copies of the inputs that are VALUE results, made before the tasks
+  // are run, parallel to Inputs. NULL for the other inputs.
+  std::vector< vtkSmartPointer< vtkPolyData > > Leaves;
+};
+
+//-----------------------------------------------------------------------------
+static bool vtkCSGTreeOverlap(const double a[6], const double b[6])
+{
+  return a[0] <= b[1] && b[0] <= a[1] && a[2] <= b[3] && b[2] <= a[3] &&
+         a[4] <= b[5] && b[4] <= a[5];
+}
+
+
+//-----------------------------------------------------------------------------
+// Rewritten expression and the state of its evaluation.
+class vtkCSGTreePolyDataFilter::Schedule
+{
+public:
+  Schedule(vtkCSGTreePolyDataFilter *filter) :
+    Failed(false), Filter(filter), NumberRemaining(0), NumberRunning(0),
+    NumberOfThreadsInUse(0)
+  {
+  }
+
+  int PlanNode(int nodeId);
+  int QueueTasks();
+  void CopyLeaves(bool threaded);
+  void Run();
+  static VTK_THREAD_RETURN_TYPE RunThread(void *arg);
+
+  std::vector< vtkCSGTreeTask > Tasks;
+  bool                          Failed;
+
+private:
+  int AddValue(vtkPolyData *surface);
+  int AddEmpty();
+  int AddTask(int kind, int operation, const std::vector< int > &inputs);
+
+  void FlattenNode(int nodeId, int operation, std::vector< int > &operands);
+  int PlanUnion(std::vector< int > operands);
+  int PlanIntersection(std::vector< int > operands);
+  int PlanDifference(int first, std::vector< int > cutters);
+  int Reduce(int operation, std::vector< int > operands);
+
+  vtkPolyData* GetInput(const vtkCSGTreeTask &task, size_t i);
+  bool Execute(int taskId, int numThreads);
+
+  vtkCSGTreePolyDataFilter  *Filter;
+
+  vtkSimpleMutexLock         Lock;
+  vtkSimpleConditionVariable Condition;
+  std::deque< int >          Ready;
+  int                        NumberRemaining;
+  int                        NumberRunning;
+  int                        NumberOfThreadsInUse;
+};
+
+//-----------------------------------------------------------------------------
+// Orders tasks by the size of their bounding boxes.
+class vtkCSGTreeSizeLess
+{
+public:
+  vtkCSGTreeSizeLess(const std::vector< vtkCSGTreeTask > &tasks) :
+    Tasks(tasks) {}
+
+  bool operator()(int a, int b) const
+  {
+    return this->Tasks[a].Size < this->Tasks[b].Size;
+  }
+
+  const std::vector< vtkCSGTreeTask > &Tasks;
+};
+
+//-----------------------------------------------------------------------------
+// Orders tasks by the lower x bound of their bounding boxes.
+class vtkCSGTreeBoundsLess
+{
+public:
+  vtkCSGTreeBoundsLess(const std::vector< vtkCSGTreeTask > &tasks) :
+    Tasks(tasks) {}
+
+  bool operator()(int a, int b) const
+  {
+    return this->Tasks[a].Bounds[0] < this->Tasks[b].Bounds[0];
+  }
+
+  const std::vector< vtkCSGTreeTask > &Tasks;
+};
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::AddValue(vtkPolyData *surface)
+{
+  vtkCSGTreeTask task;
+  task.Result = surface;
+  task.Empty = surface->GetNumberOfCells() == 0;
+  if ( !task.Empty )
+    {
+    double tol = this->Filter->Tolerance;
+    surface->GetBounds(task.Bounds);
+    for (int k = 0; k < 3; k++)
+      {
+      task.Bounds[2*k]   -= tol;
+      task.Bounds[2*k+1] += tol;
+      double d = task.Bounds[2*k+1] - task.Bounds[2*k];
+      task.Size += d*d;
+      }
+    }
+
+  this->Tasks.push_back(task);
+  return static_cast<int>(this->Tasks.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::AddEmpty()
+{
+  vtkSmartPointer< vtkPolyData > empty = vtkSmartPointer< vtkPolyData >::New();
+  return this->AddValue(empty);
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::AddTask(int kind, int operation,
+                                                const std::vector< int > &inputs)
+{
+  int taskId = static_cast<int>(this->Tasks.size());
+
+  vtkCSGTreeTask task;
+  task.Kind = kind;
+  task.Operation = operation;
+  task.Inputs = inputs;
+
+  // The bounds of an intersection are those shared by its inputs, the
+  // bounds of a difference those of its first input and the bounds of
+  // a union or an append those of all its inputs.
+  const double *first = this->Tasks[inputs[0]].Bounds;
+  std::copy(first, first + 6, task.Bounds);
+  for (size_t i = 1; i < inputs.size(); i++)
+    {
+    const double *b = this->Tasks[inputs[i]].Bounds;
+    for (int k = 0; k < 3; k++)
+      {
+      if ( kind == vtkCSGTreeTask::BOOLEAN &&
+           operation == vtkBooleanOperationPolyDataFilter::INTERSECTION )
+        {
+        task.Bounds[2*k]   = std::max(task.Bounds[2*k], b[2*k]);
+        task.Bounds[2*k+1] = std::min(task.Bounds[2*k+1], b[2*k+1]);
+        }
+      else if ( kind == vtkCSGTreeTask::APPEND ||
+                operation == vtkBooleanOperationPolyDataFilter::UNION )
+        {
+        task.Bounds[2*k]   = std::min(task.Bounds[2*k], b[2*k]);
+        task.Bounds[2*k+1] = std::max(task.Bounds[2*k+1], b[2*k+1]);
+        }
+      }
+    }
+  for (int k = 0; k < 3; k++)
+    {
+    double d = task.Bounds[2*k+1] - task.Bounds[2*k];
+    task.Size += d*d;
+    }
+
+  for (size_t i = 0; i < inputs.size(); i++)
+    {
+    if ( this->Tasks[inputs[i]].Kind != vtkCSGTreeTask::VALUE )
+      {
+      this->Tasks[inputs[i]].Dependents.push_back(taskId);
+      task.Pending++;
+      }
+    }
+
+  this->Tasks.push_back(task);
+  return taskId;
+}
+
+//-----------------------------------------------------------------------------
+// Plans the children of nodeId, descending into the children that
+// apply the same operation.
+void vtkCSGTreePolyDataFilter::Schedule::FlattenNode(int nodeId, int operation,
+                                                     std::vector< int > &operands)
+{
+  const Expression::Node &node = this->Filter->Tree->Nodes[nodeId];
+  for (size_t i = 0; i < node.Children.size(); i++)
+    {
+    int child = node.Children[i];
+    if ( this->Filter->Tree->Nodes[child].Operation == operation )
+      {
+      this->FlattenNode(child, operation, operands);
+      }
+    else
+      {
+      operands.push_back(this->PlanNode(child));
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::PlanNode(int nodeId)
+{
+  const Expression::Node &node = this->Filter->Tree->Nodes[nodeId];
+
+  std::vector< int > operands;
+  switch ( node.Operation )
+    {
+    case vtkBooleanOperationPolyDataFilter::UNION:
+      this->FlattenNode(nodeId, node.Operation, operands);
+      return this->PlanUnion(operands);
+
+    case vtkBooleanOperationPolyDataFilter::INTERSECTION:
+      this->FlattenNode(nodeId, node.Operation, operands);
+      return this->PlanIntersection(operands);
+
+    case vtkBooleanOperationPolyDataFilter::DIFFERENCE:
+      {
+      // (A - B) - C is A - B - C, and A - (B + C) is A - B - C too.
+      const Expression::Node *first = &node;
+      std::vector< const Expression::Node* > subtracted;
+      while ( first->Operation == vtkBooleanOperationPolyDataFilter::DIFFERENCE )
+        {
+        subtracted.push_back(first);
+        first = &this->Filter->Tree->Nodes[first->Children[0]];
+        }
+      int firstId = this->PlanNode(static_cast<int>
+                                   (first - &this->Filter->Tree->Nodes[0]));
+      for (size_t i = 0; i < subtracted.size(); i++)
+        {
+        const std::vector< int > &children = subtracted[i]->Children;
+        for (size_t k = 1; k < children.size(); k++)
+          {
+          if ( this->Filter->Tree->Nodes[children[k]].Operation ==
+               vtkBooleanOperationPolyDataFilter::UNION )
+            {
+            this->FlattenNode(children[k],
+                              vtkBooleanOperationPolyDataFilter::UNION,
+                              operands);
+            }
+          else
+            {
+            operands.push_back(this->PlanNode(children[k]));
+            }
+          }
+        }
+      return this->PlanDifference(firstId, operands);
+      }
+
+    default:
+      return this->AddValue(node.Surface);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::PlanUnion(std::vector< int > operands)
+{
+  std::vector< int > nonEmpty;
+  for (size_t i = 0; i < operands.size(); i++)
+    {
+    if ( !this->Tasks[operands[i]].Empty )
+      {
+      nonEmpty.push_back(operands[i]);
+      }
+    }
+  if ( nonEmpty.empty() )
+    {
+    return this->AddEmpty();
+    }
+
+  // Group the operands whose bounding boxes overlap, directly or
+  // through other operands, by sweeping the boxes along x. Groups are
+  // disjoint and are simply appended.
+  std::sort(nonEmpty.begin(), nonEmpty.end(), vtkCSGTreeBoundsLess(this->Tasks));
+  std::vector< int > group(nonEmpty.size());
+  for (size_t i = 0; i < nonEmpty.size(); i++)
+    {
+    group[i] = static_cast<int>(i);
+    }
+
+  std::vector< size_t > active;
+  for (size_t i = 0; i < nonEmpty.size(); i++)
+    {
+    const double *bi = this->Tasks[nonEmpty[i]].Bounds;
+    size_t numActive = 0;
+    for (size_t a = 0; a < active.size(); a++)
+      {
+      size_t j = active[a];
+      const double *bj = this->Tasks[nonEmpty[j]].Bounds;
+      if ( bj[1] < bi[0] )
+        {
+        continue;
+        }
+      active[numActive++] = j;
+      if ( vtkCSGTreeOverlap(bi, bj) )
+        {
+        int gi = group[i], gj = group[j];
+        while ( group[gi] != gi ) gi = group[gi];
+        while ( group[gj] != gj ) gj = group[gj];
+        group[std::max(gi, gj)] = std::min(gi, gj);
+        }
+      }
+    active.resize(numActive);
+    active.push_back(i);
+    }
+
+  std::vector< std::vector< int > > members(nonEmpty.size());
+  for (size_t i = 0; i < nonEmpty.size(); i++)
+    {
+    int g = group[i];
+    while ( group[g] != g ) g = group[g];
+    members[g].push_back(nonEmpty[i]);
+    }
+
+  std::vector< int > groups;
+  for (size_t i = 0; i < members.size(); i++)
+    {
+    if ( !members[i].empty() )
+      {
+      groups.push_back(this->Reduce(vtkBooleanOperationPolyDataFilter::UNION,
+                                    members[i]));
+      }
+    }
+  if ( groups.size() == 1 )
+    {
+    return groups[0];
+    }
+  return this->AddTask(vtkCSGTreeTask::APPEND, 0, groups);
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::PlanIntersection(std::vector< int > operands)
+{
+  // Boxes that overlap pairwise share a common box, so the
+  // intersection is empty as soon as the common box is.
+  double common[6];
+  std::copy(this->Tasks[operands[0]].Bounds,
+            this->Tasks[operands[0]].Bounds + 6, common);
+  for (size_t i = 0; i < operands.size(); i++)
+    {
+    const vtkCSGTreeTask &task = this->Tasks[operands[i]];
+    if ( task.Empty )
+      {
+      return this->AddEmpty();
+      }
+    for (int k = 0; k < 3; k++)
+      {
+      common[2*k]   = std::max(common[2*k], task.Bounds[2*k]);
+      common[2*k+1] = std::min(common[2*k+1], task.Bounds[2*k+1]);
+      if ( common[2*k] > common[2*k+1] )
+        {
+        return this->AddEmpty();
+        }
+      }
+    }
+
+  return this->Reduce(vtkBooleanOperationPolyDataFilter::INTERSECTION,
+                      operands);
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::Schedule::PlanDifference(int first,
+                                                       std::vector< int > cutters)
+{
+  if ( this->Tasks[first].Empty )
+    {
+    return first;
+    }
+
+  std::vector< int > overlapping;
+  for (size_t i = 0; i < cutters.size(); i++)
+    {
+    const vtkCSGTreeTask &cutter = this->Tasks[cutters[i]];
+    if ( !cutter.Empty &&
+         vtkCSGTreeOverlap(cutter.Bounds, this->Tasks[first].Bounds) )
+      {
+      overlapping.push_back(cutters[i]);
+      }
+    }
+  if ( overlapping.empty() )
+    {
+    return first;
+    }
+
+  std::vector< int > inputs(2);
+  inputs[0] = first;
+  inputs[1] = this->PlanUnion(overlapping);
+  return this->AddTask(vtkCSGTreeTask::BOOLEAN,
+                       vtkBooleanOperationPolyDataFilter::DIFFERENCE, inputs);
+}
+
+//-----------------------------------------------------------------------------
+// Combines the operands in balanced pairs. Sorting by size pairs
+// operands of similar size, so that no operand is intersected with a
+// much larger accumulated surface over and over.
+int vtkCSGTreePolyDataFilter::Schedule::Reduce(int operation,
+                                               std::vector< int > operands)
+{
+  std::sort(operands.begin(), operands.end(), vtkCSGTreeSizeLess(this->Tasks));
+
+  std::vector< int > inputs(2);
+  while ( operands.size() > 1 )
+    {
+    std::vector< int > next;
+    for (size_t i = 0; i + 1 < operands.size(); i += 2)
+      {
+      inputs[0] = operands[i];
+      inputs[1] = operands[i+1];
+      next.push_back(this->AddTask(vtkCSGTreeTask::BOOLEAN, operation, inputs));
+      }
+    if ( operands.size() % 2 )
+      {
+      next.push_back(operands.back());
+      }
+    operands.swap(next);
+    }
+
+  return operands[0];
+}
+
+//-----------------------------------------------------------------------------
+// Returns input i of task, using the copy of a VALUE result.
+vtkPolyData* vtkCSGTreePolyDataFilter::Schedule::GetInput(
+  const vtkCSGTreeTask &task, size_t i)
+{
+  if ( task.Leaves[i] != NULL )
+    {
+    return task.Leaves[i];
+    }
+  return this->Tasks[task.Inputs[i]].Result;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkCSGTreePolyDataFilter::Schedule::Execute(int taskId, int numThreads)
+{
+  vtkCSGTreeTask &task = this->Tasks[taskId];
+  vtkSmartPointer< vtkPolyData > result = vtkSmartPointer< vtkPolyData >::New();
+
+  if ( task.Kind == vtkCSGTreeTask::APPEND )
+    {
+    vtkSmartPointer< vtkAppendPolyData > append =
+      vtkSmartPointer< vtkAppendPolyData >::New();
+    for (size_t i = 0; i < task.Inputs.size(); i++)
+      {
+      append->AddInput(this->GetInput(task, i));
+      }
+    append->Update();
+    result->ShallowCopy(append->GetOutput());
+    task.Result = result;
+    return true;
+    }
+
+  vtkPolyData *input0 = this->GetInput(task, 0);
+  vtkPolyData *input1 = this->GetInput(task, 1);
+  bool empty0 = input0->GetNumberOfCells() == 0;
+  bool empty1 = input1->GetNumberOfCells() == 0;
+
+  // Operations on surfaces that turned out empty need no filter.
+  if ( empty0 || empty1 )
+    {
+    if ( task.Operation == vtkBooleanOperationPolyDataFilter::UNION )
+      {
+      task.Result = empty0 ? input1 : input0;
+      }
+    else if ( task.Operation == vtkBooleanOperationPolyDataFilter::INTERSECTION )
+      {
+      task.Result = result;
+      }
+    else
+      {
+      task.Result = input0;
+      }
+    return true;
+    }
+
+  vtkSmartPointer< vtkBooleanOperationPolyDataFilter > boolean =
+    vtkSmartPointer< vtkBooleanOperationPolyDataFilter >::New();
+  boolean->SetOperation(task.Operation);
+  boolean->SetTolerance(this->Filter->Tolerance);
+  boolean->SetReorientDifferenceCells(this->Filter->ReorientDifferenceCells);
+  boolean->SetClassificationMode(this->Filter->ClassificationMode);
+  boolean->SetNumberOfThreads(numThreads);
+
+  vtkSmartPointer< vtkPolyData > lines = vtkSmartPointer< vtkPolyData >::New();
+  if ( !boolean->ComputeBoolean(input0, input1, result, lines) )
+    {
+    return false;
+    }
+  task.Result = result;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Queues the tasks that can run right away and returns the number of
+// tasks to run.
+int vtkCSGTreePolyDataFilter::Schedule::QueueTasks()
+{
+  for (size_t i = 0; i < this->Tasks.size(); i++)
+    {
+    vtkCSGTreeTask &task = this->Tasks[i];
+    if ( task.Kind != vtkCSGTreeTask::VALUE )
+      {
+      this->NumberRemaining++;
+      if ( task.Pending == 0 )
+        {
+        this->Ready.push_back(static_cast<int>(i));
+        }
+      }
+    }
+
+  return this->NumberRemaining;
+}
+
+//-----------------------------------------------------------------------------
+// Gives each task its own copies of the VALUE results it reads, so that
+// the workers never change the reference counts of the leaves. The
+// copies are made here, before the workers start. When threaded, a
+// surface read by several tasks is deep copied for all but one of
+// them, since shallow copies made by the tasks would share its arrays.
+void vtkCSGTreePolyDataFilter::Schedule::CopyLeaves(bool threaded)
+{
+  std::map< vtkPolyData*, int > uses;
+  for (size_t i = 0; i < this->Tasks.size(); i++)
+    {
+    vtkCSGTreeTask &task = this->Tasks[i];
+    task.Leaves.resize(task.Inputs.size());
+    for (size_t j = 0; j < task.Inputs.size(); j++)
+      {
+      vtkCSGTreeTask &input = this->Tasks[task.Inputs[j]];
+      if ( input.Kind != vtkCSGTreeTask::VALUE )
+        {
+        continue;
+        }
+
+      vtkPolyData *surface = input.Result;
+      task.Leaves[j] = vtkSmartPointer< vtkPolyData >::New();
+      if ( threaded && uses[surface]++ > 0 )
+        {
+        task.Leaves[j]->DeepCopy(surface);
+        }
+      else
+        {
+        task.Leaves[j]->ShallowCopy(surface);
+        }
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Runs ready tasks until none remain. The threads that are not running
+// a task are handed to the internal filters of the task being started.
+void vtkCSGTreePolyDataFilter::Schedule::Run()
+{
+  this->Lock.Lock();
+  while ( true )
+    {
+    while ( this->Ready.empty() && this->NumberRemaining > 0 && !this->Failed )
+      {
+      this->Condition.Wait(this->Lock);
+      }
+    if ( this->NumberRemaining == 0 || this->Failed )
+      {
+      break;
+      }
+
+    // The threads not in use are shared between this task and the
+    // tasks that are ready to start after it.
+    int taskId = this->Ready.front();
+    this->Ready.pop_front();
+    this->NumberRunning++;
+    int numThreads = std::max(1,
+      (this->Filter->NumberOfThreads - this->NumberOfThreadsInUse) /
+      (static_cast<int>(this->Ready.size()) + 1));
+    this->NumberOfThreadsInUse += numThreads;
+    this->Lock.Unlock();
+
+    bool executed = this->Execute(taskId, numThreads);
+
+    this->Lock.Lock();
+    this->NumberRunning--;
+    this->NumberOfThreadsInUse -= numThreads;
+    this->NumberRemaining--;
+    if ( !executed )
+      {
+      this->Failed = true;
+      }
+
+    // Intermediate results are consumed by a single task.
+    vtkCSGTreeTask &task = this->Tasks[taskId];
+    for (size_t i = 0; i < task.Inputs.size(); i++)
+      {
+      vtkCSGTreeTask &input = this->Tasks[task.Inputs[i]];
+      if ( input.Kind != vtkCSGTreeTask::VALUE )
+        {
+        input.Result = NULL;
+        }
+      }
+    task.Leaves.clear();
+    for (size_t i = 0; i < task.Dependents.size(); i++)
+      {
+      if ( --this->Tasks[task.Dependents[i]].Pending == 0 )
+        {
+        this->Ready.push_back(task.Dependents[i]);
+        }
+      }
+    this->Condition.Broadcast();
+    }
+  this->Lock.Unlock();
+}
+
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkCSGTreePolyDataFilter::Schedule::RunThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  Schedule *schedule = static_cast<Schedule*>(threadInfo->UserData);
+  schedule->Run();
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+
+//-----------------------------------------------------------------------------
+vtkCSGTreePolyDataFilter::vtkCSGTreePolyDataFilter()
+{
+  this->Root = -1;
+  this->NumberOfThreads = 1;
+  this->Tolerance = 1e-6;
+  this->ReorientDifferenceCells = 1;
+  this->ClassificationMode =
+    vtkBooleanOperationPolyDataFilter::CLASSIFY_BY_DISTANCE;
+  this->Tree = new Expression;
+
+  this->SetNumberOfInputPorts(0);
+}
+
+//-----------------------------------------------------------------------------
+vtkCSGTreePolyDataFilter::~vtkCSGTreePolyDataFilter()
+{
+  delete this->Tree;
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::AddLeaf(vtkPolyData *surface)
+{
+  if ( surface == NULL )
+    {
+    vtkErrorMacro(<< "Cannot add a NULL surface");
+    return -1;
+    }
+
+  Expression::Node node;
+  node.Operation = -1;
+  node.Surface = surface;
+  this->Tree->Nodes.push_back(node);
+  this->Root = static_cast<int>(this->Tree->Nodes.size()) - 1;
+  this->Modified();
+
+  return this->Root;
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::AddOperation(int operation, int node0, int node1)
+{
+  vtkSmartPointer< vtkIdList > nodes = vtkSmartPointer< vtkIdList >::New();
+  nodes->InsertNextId(node0);
+  nodes->InsertNextId(node1);
+
+  return this->AddOperation(operation, nodes);
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::AddOperation(int operation, vtkIdList *nodes)
+{
+  if ( operation < vtkBooleanOperationPolyDataFilter::UNION ||
+       operation > vtkBooleanOperationPolyDataFilter::DIFFERENCE )
+    {
+    vtkErrorMacro(<< "Invalid operation " << operation);
+    return -1;
+    }
+  if ( nodes == NULL || nodes->GetNumberOfIds() == 0 )
+    {
+    vtkErrorMacro(<< "An operation needs at least one node");
+    return -1;
+    }
+
+  // Children must already exist, so the expression has no cycles.
+  Expression::Node node;
+  node.Operation = operation;
+  for (vtkIdType i = 0; i < nodes->GetNumberOfIds(); i++)
+    {
+    vtkIdType child = nodes->GetId(i);
+    if ( child < 0 || child >= static_cast<vtkIdType>(this->Tree->Nodes.size()) )
+      {
+      vtkErrorMacro(<< "Invalid node id " << child);
+      return -1;
+      }
+    node.Children.push_back(static_cast<int>(child));
+    }
+
+  this->Tree->Nodes.push_back(node);
+  this->Root = static_cast<int>(this->Tree->Nodes.size()) - 1;
+  this->Modified();
+
+  return this->Root;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCSGTreePolyDataFilter::RemoveAllNodes()
+{
+  this->Tree->Nodes.clear();
+  this->Root = -1;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::GetNumberOfNodes()
+{
+  return static_cast<int>(this->Tree->Nodes.size());
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkCSGTreePolyDataFilter::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+
+  for (size_t i = 0; i < this->Tree->Nodes.size(); i++)
+    {
+    vtkPolyData *surface = this->Tree->Nodes[i].Surface;
+    if ( surface != NULL )
+      {
+      unsigned long surfaceMTime = surface->GetMTime();
+      mTime = (surfaceMTime > mTime ? surfaceMTime : mTime);
+      }
+    }
+
+  return mTime;
+}
+
+//-----------------------------------------------------------------------------
+int vtkCSGTreePolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(request),
+                                          vtkInformationVector** vtkNotUsed(inputVector),
+                                          vtkInformationVector*  outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkPolyData* output =
+    vtkPolyData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  if ( !output )
+    {
+    return 0;
+    }
+
+  if ( this->Root < 0 ||
+       this->Root >= static_cast<int>(this->Tree->Nodes.size()) )
+    {
+    vtkErrorMacro(<< "No root node to evaluate");
+    return 0;
+    }
+
+  Schedule schedule(this);
+  int root = schedule.PlanNode(this->Root);
+
+  int numThreads = std::min(this->NumberOfThreads, schedule.QueueTasks());
+  schedule.CopyLeaves(numThreads > 1);
+  if ( numThreads > 1 )
+    {
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->SetNumberOfThreads(numThreads);
+    threader->SetSingleMethod(Schedule::RunThread, &schedule);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+  else
+    {
+    schedule.Run();
+    }
+
+  if ( schedule.Failed )
+    {
+    vtkErrorMacro(<< "A boolean operation failed");
+    return 0;
+    }
+
+  output->ShallowCopy(schedule.Tasks[root].Result);
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCSGTreePolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfNodes: " << this->Tree->Nodes.size() << "\n";
+  os << indent << "Root: " << this->Root << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "Tolerance: " << this->Tolerance << "\n";
+  os << indent << "ReorientDifferenceCells: "
+     << this->ReorientDifferenceCells << "\n";
+  os << indent << "ClassificationMode: " << this->ClassificationMode << "\n";
+}
@@ -0,0 +1,128 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkCSGTreePolyDataFilter.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkCSGTreePolyDataFilter
+// .SECTION Description
+//
+// Evaluates a constructive solid geometry (CSG) expression over
+// surfaces with vtkBooleanOperationPolyDataFilter. The leaves of the
+// expression are vtkPolyData surfaces added with AddLeaf() and its
+// inner nodes are boolean operations added with AddOperation(). The
+// node selected with SetRoot() is evaluated into the output.
+//
+// The expression is rewritten before it is evaluated. Nested unions
+// and nested intersections are flattened, and their operands are
+// combined in balanced pairs of similar bounding box size instead of
+// in the order given. Operands of a union whose bounding boxes overlap
+// no other operand are appended instead of intersected, an
+// intersection of operands with disjoint bounding boxes is empty, and
+// the operands of a difference that do not overlap the first operand
+// are dropped.
+//
+// The remaining operations are run by NumberOfThreads worker threads,
+// each as soon as its operands are available, on separate instances of
+// vtkBooleanOperationPolyDataFilter. The operations read copies of the
+// surfaces of the leaves made before the threads start; a surface used
+// by several operations is deep copied for all but one of them. The
+// intersection lines of the operations are not kept.
+
+#ifndef __vtkCSGTreePolyDataFilter_h
+#define __vtkCSGTreePolyDataFilter_h
+
+#include "vtkPolyDataAlgorithm.h"
+
+class vtkIdList;
+
+class vtkCSGTreePolyDataFilter : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkCSGTreePolyDataFilter *New();
+  vtkTypeMacro(vtkCSGTreePolyDataFilter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Adds a leaf holding surface to the expression and returns its node
+  // id.
+  int AddLeaf(vtkPolyData *surface);
+
+  // Description:
+  // Adds a node applying operation, one of the
+  // vtkBooleanOperationPolyDataFilter::OperationTypes, to the given
+  // nodes and returns its node id. A difference subtracts all the
+  // other nodes from the first one. Returns -1 if a node id is
+  // invalid.
+  int AddOperation(int operation, int node0, int node1);
+  int AddOperation(int operation, vtkIdList *nodes);
+
+  // Description:
+  // Removes all the nodes of the expression.
+  void RemoveAllNodes();
+
+  // Description:
+  // Returns the number of nodes of the expression.
+  int GetNumberOfNodes();
+
+  // Description:
+  // Set/get the node evaluated into the output. Defaults to the last
+  // node added.
+  vtkSetMacro(Root, int);
+  vtkGetMacro(Root, int);
+
+  // Description:
+  // Set/get the number of threads. Independent operations are run
+  // concurrently; the threads that are not busy with another operation
+  // are divided between the internal filters of the operations being
+  // started. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Set/get the Tolerance, ReorientDifferenceCells and
+  // ClassificationMode of the internal filters. See
+  // vtkBooleanOperationPolyDataFilter.
+  vtkSetMacro(Tolerance, double);
+  vtkGetMacro(Tolerance, double);
+  vtkSetMacro(ReorientDifferenceCells, int);
+  vtkGetMacro(ReorientDifferenceCells, int);
+  vtkBooleanMacro(ReorientDifferenceCells, int);
+  vtkSetMacro(ClassificationMode, int);
+  vtkGetMacro(ClassificationMode, int);
+
+  // Description:
+  // Return the MTime also considering the surfaces of the leaves.
+  unsigned long GetMTime();
+
+protected:
+  vtkCSGTreePolyDataFilter();
+  ~vtkCSGTreePolyDataFilter();
+
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
+
+  int    Root;
+  int    NumberOfThreads;
+  double Tolerance;
+  int    ReorientDifferenceCells;
+  int    ClassificationMode;
+
+private:
+  vtkCSGTreePolyDataFilter(const vtkCSGTreePolyDataFilter&); // no implementation
+  void operator=(const vtkCSGTreePolyDataFilter&);           // no implementation
+
+  class Expression;
+  class Schedule;
+
+  Expression *Tree;
+};
+
+#endif
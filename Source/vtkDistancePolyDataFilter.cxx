@@ -17,16 +17,24 @@
 #include "vtkCellData.h"
 #include "vtkDoubleArray.h"
 #include "vtkFieldData.h"
+#include "vtkGenericCell.h"
 #include "vtkImplicitPolyData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkPolyDataLocatorCache.h"
 #include "vtkPolygon.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTriangle.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkDistancePolyDataFilter);
 
 //-----------------------------------------------------------------------------
@@ -35,6 +43,8 @@ vtkDistancePolyDataFilter::vtkDistancePolyDataFilter() : vtkPolyDataAlgorithm()
   this->SignedDistance = 1;
   this->NegateDistance = 0;
   this->ComputeSecondDistance = 1;
+  this->NumberOfThreads = 1;
+  this->LocatorCache = NULL;
 
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(2);
@@ -47,8 +57,13 @@ vtkDistancePolyDataFilter::vtkDistancePolyDataFilter() : vtkPolyDataAlgorithm()
 //-----------------------------------------------------------------------------
 vtkDistancePolyDataFilter::~vtkDistancePolyDataFilter()
 {
+  this->SetLocatorCache(NULL);
 }
 
+//-----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkDistancePolyDataFilter, LocatorCache,
+                     vtkPolyDataLocatorCache);
+
 
 //-----------------------------------------------------------------------------
 int vtkDistancePolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(request),
@@ -72,7 +87,6 @@ int vtkDistancePolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(req
   output0->GetPointData()->PassData(input0->GetPointData());
   output0->GetCellData()->PassData(input0->GetCellData());
   output0->BuildCells();
-  this->GetPolyDataDistance(output0, input1);
 
   if (this->ComputeSecondDistance)
     {
@@ -80,80 +94,257 @@ int vtkDistancePolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(req
     output1->GetPointData()->PassData(input1->GetPointData());
     output1->GetCellData()->PassData(input1->GetCellData());
     output1->BuildCells();
-    this->GetPolyDataDistance(output1, input0);
+    this->GetPolyDataDistances(output0, input1, output1, input0);
+    }
+  else
+    {
+    this->GetPolyDataDistances(output0, input1, NULL, NULL);
     }
 
   return 1;
 }
 
 //-----------------------------------------------------------------------------
-void vtkDistancePolyDataFilter::GetPolyDataDistance(vtkPolyData* mesh, vtkPolyData* src)
-{
-  vtkDebugMacro(<<"Start vtkDistancePolyDataFilter::GetPolyDataDistance");
+// The distances to compute for one mesh.
+typedef struct _DistanceQuery {
+  vtkPolyData         *Mesh;
+  vtkImplicitPolyData *Implicit;
+  vtkDoubleArray      *Locations;
+  vtkDoubleArray      *PointArray;
+  vtkDoubleArray      *CellArray;
+} DistanceQueryType;
+
+// Work shared by the threads that gather the query locations. The
+// points and then the cells of each query are numbered consecutively,
+// and threads take chunks of that range until it is exhausted, so the
+// cell centers of both meshes are computed at the same time. The
+// locations are then evaluated in one batch per mesh.
+typedef struct _DistanceWork {
+  DistanceQueryType   Queries[2];
+  int                 NumberOfQueries;
+  vtkIdType           NumberOfItems;
+  vtkIdType           NextItem;
+  vtkSimpleMutexLock *Lock;
+  vtkGenericCell    **Cells;
+  int                 MaxCellSize;
+  int                 NumberOfThreads;
+} DistanceWorkType;
 
-  if (mesh->GetNumberOfPolys() == 0 || mesh->GetNumberOfPoints() == 0)
+//-----------------------------------------------------------------------------
+static void vtkDistancePolyDataFilterLocate(DistanceWorkType *work,
+                                            vtkIdType begin, vtkIdType end,
+                                            int threadId)
+{
+  std::vector< double > weights(work->MaxCellSize > 0 ? work->MaxCellSize : 1);
+  vtkIdType offset = 0;
+  for (int q = 0; q < work->NumberOfQueries && begin < end; q++)
     {
-    vtkErrorMacro(<<"No points/cells to operate on");
-    return;
+    DistanceQueryType &query = work->Queries[q];
+    vtkIdType numPts = query.Mesh->GetNumberOfPoints();
+    vtkIdType numCells = query.Mesh->GetNumberOfCells();
+
+    for ( ; begin < end && begin < offset + numPts + numCells; begin++)
+      {
+      vtkIdType id = begin - offset;
+      double *x = query.Locations->GetPointer( 3*id );
+      if (id < numPts)
+        {
+        // Location of a point.
+        query.Mesh->GetPoint( id, x );
+        }
+      else
+        {
+        // Location of a cell center.
+        vtkGenericCell *cell = work->Cells[threadId];
+        query.Mesh->GetCell( id - numPts, cell );
+        int subId;
+        double pcoords[3];
+
+        cell->GetParametricCenter( pcoords );
+        cell->EvaluateLocation( subId, pcoords, x, &weights[0] );
+        }
+      }
+    offset += numPts + numCells;
     }
+}
 
-  if (src->GetNumberOfPolys() == 0 || src->GetNumberOfPoints() == 0)
+//-----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkDistancePolyDataFilterThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  DistanceWorkType *work = static_cast<DistanceWorkType*>(threadInfo->UserData);
+  int threadId = threadInfo->ThreadID;
+  if (threadId >= work->NumberOfThreads)
     {
-    vtkErrorMacro(<<"No points/cells to difference from");
-    return;
+    return VTK_THREAD_RETURN_VALUE;
     }
 
-  vtkImplicitPolyData* imp = vtkImplicitPolyData::New();
-  imp->SetInput( src );
-
-  // Calculate distance from points.
-  int numPts = mesh->GetNumberOfPoints();
-
-  vtkDoubleArray* pointArray = vtkDoubleArray::New();
-  pointArray->SetName( "Distance" );
-  pointArray->SetNumberOfComponents( 1 );
-  pointArray->SetNumberOfTuples( numPts );
-
-  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+  const vtkIdType chunkSize = 256;
+  while (true)
     {
-    double pt[3];
-    mesh->GetPoint( ptId, pt );
-    double val = imp->EvaluateFunction( pt );
-    double dist = SignedDistance ? (NegateDistance ? -val : val) : fabs(val);
-    pointArray->SetValue( ptId, dist );
+    work->Lock->Lock();
+    vtkIdType begin = work->NextItem;
+    vtkIdType end = begin + chunkSize;
+    if (end > work->NumberOfItems)
+      {
+      end = work->NumberOfItems;
+      }
+    work->NextItem = end;
+    work->Lock->Unlock();
+
+    if (begin >= end)
+      {
+      break;
+      }
+    vtkDistancePolyDataFilterLocate(work, begin, end, threadId);
     }
 
-  mesh->GetPointData()->AddArray( pointArray );
-  pointArray->Delete();
-  mesh->GetPointData()->SetActiveScalars( "Distance" );
+  return VTK_THREAD_RETURN_VALUE;
+}
 
-  // Calculate distance from cell centers.
-  int numCells = mesh->GetNumberOfCells();
+//-----------------------------------------------------------------------------
+void vtkDistancePolyDataFilter::GetPolyDataDistance(vtkPolyData* mesh, vtkPolyData* src)
+{
+  this->GetPolyDataDistances(mesh, src, NULL, NULL);
+}
 
-  vtkDoubleArray* cellArray = vtkDoubleArray::New();
-  cellArray->SetName( "Distance" );
-  cellArray->SetNumberOfComponents( 1 );
-  cellArray->SetNumberOfTuples( numCells );
+//-----------------------------------------------------------------------------
+void vtkDistancePolyDataFilter::GetPolyDataDistances(vtkPolyData *mesh0,
+                                                     vtkPolyData *src0,
+                                                     vtkPolyData *mesh1,
+                                                     vtkPolyData *src1)
+{
+  vtkDebugMacro(<<"Start vtkDistancePolyDataFilter::GetPolyDataDistance");
+
+  DistanceWorkType work;
+  work.NumberOfQueries = 0;
+  work.NumberOfItems   = 0;
+  work.NextItem        = 0;
+  work.MaxCellSize     = 0;
+  work.NumberOfThreads = this->NumberOfThreads;
 
-  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+  vtkPolyData *meshes[2] = {mesh0, mesh1};
+  vtkPolyData *srcs[2] = {src0, src1};
+  for (int i = 0; i < 2; i++)
     {
-    vtkCell *cell = mesh->GetCell( cellId );
-    int subId;
-    double pcoords[3], x[3], weights[256];
+    vtkPolyData *mesh = meshes[i];
+    vtkPolyData *src = srcs[i];
+    if (mesh == NULL)
+      {
+      continue;
+      }
+
+    if (mesh->GetNumberOfPolys() == 0 || mesh->GetNumberOfPoints() == 0)
+      {
+      vtkErrorMacro(<<"No points/cells to operate on");
+      continue;
+      }
+
+    if (src->GetNumberOfPolys() == 0 || src->GetNumberOfPoints() == 0)
+      {
+      vtkErrorMacro(<<"No points/cells to difference from");
+      continue;
+      }
+
+    // The threads only read the mesh, so build its cells here.
+    if (mesh->NeedToBuildCells())
+      {
+      mesh->BuildCells();
+      }
+    work.MaxCellSize = std::max(work.MaxCellSize, mesh->GetMaxCellSize());
+
+    DistanceQueryType &query = work.Queries[work.NumberOfQueries++];
+    query.Mesh = mesh;
+    query.Implicit = vtkImplicitPolyData::New();
+    query.Implicit->SetNumberOfThreads( this->NumberOfThreads );
+    query.Implicit->SetLocatorCache( this->LocatorCache );
+    query.Implicit->SetInput( src );
+
+    query.Locations = vtkDoubleArray::New();
+    query.Locations->SetNumberOfComponents( 3 );
+    query.Locations->SetNumberOfTuples( mesh->GetNumberOfPoints() +
+                                        mesh->GetNumberOfCells() );
+
+    query.PointArray = vtkDoubleArray::New();
+    query.PointArray->SetName( "Distance" );
+    query.PointArray->SetNumberOfComponents( 1 );
+    query.PointArray->SetNumberOfTuples( mesh->GetNumberOfPoints() );
+
+    query.CellArray = vtkDoubleArray::New();
+    query.CellArray->SetName( "Distance" );
+    query.CellArray->SetNumberOfComponents( 1 );
+    query.CellArray->SetNumberOfTuples( mesh->GetNumberOfCells() );
+
+    work.NumberOfItems += mesh->GetNumberOfPoints() + mesh->GetNumberOfCells();
+    }
 
-    cell->GetParametricCenter( pcoords );
-    cell->EvaluateLocation( subId, pcoords, x, weights );
+  work.Cells = new vtkGenericCell*[this->NumberOfThreads];
+  for (int i = 0; i < this->NumberOfThreads; i++)
+    {
+    work.Cells[i] = vtkGenericCell::New();
+    }
 
-    double val = imp->EvaluateFunction( x );
-    double dist = SignedDistance ? (NegateDistance ? -val : val) : fabs(val);
-    cellArray->SetValue( cellId, dist );
+  if (this->NumberOfThreads > 1)
+    {
+    work.Lock = vtkSimpleMutexLock::New();
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->SetNumberOfThreads( this->NumberOfThreads );
+    threader->SetSingleMethod( vtkDistancePolyDataFilterThread, &work );
+    threader->SingleMethodExecute();
+    threader->Delete();
+    work.Lock->Delete();
+    }
+  else
+    {
+    vtkDistancePolyDataFilterLocate( &work, 0, work.NumberOfItems, 0 );
     }
 
-  mesh->GetCellData()->AddArray( cellArray );
-  cellArray->Delete();
-  mesh->GetCellData()->SetActiveScalars("Distance");
+  for (int i = 0; i < this->NumberOfThreads; i++)
+    {
+    work.Cells[i]->Delete();
+    }
+  delete [] work.Cells;
 
-  imp->Delete();
+  // Evaluate the points and cell centers of each mesh in one batch,
+  // which sorts them along a Morton curve and shares them among the
+  // threads.
+  vtkDoubleArray *values = vtkDoubleArray::New();
+  for (int q = 0; q < work.NumberOfQueries; q++)
+    {
+    DistanceQueryType &query = work.Queries[q];
+    query.Implicit->EvaluateFunctionAndGradient( query.Locations, values,
+                                                 NULL, NULL );
+    query.Locations->Delete();
+
+    vtkIdType numPts = query.Mesh->GetNumberOfPoints();
+    vtkIdType numItems = values->GetNumberOfTuples();
+    for (vtkIdType i = 0; i < numItems; i++)
+      {
+      double val = values->GetValue( i );
+      double dist = this->SignedDistance ?
+        (this->NegateDistance ? -val : val) : fabs(val);
+      if (i < numPts)
+        {
+        query.PointArray->SetValue( i, dist );
+        }
+      else
+        {
+        query.CellArray->SetValue( i - numPts, dist );
+        }
+      }
+
+    query.Mesh->GetPointData()->AddArray( query.PointArray );
+    query.PointArray->Delete();
+    query.Mesh->GetPointData()->SetActiveScalars( "Distance" );
+
+    query.Mesh->GetCellData()->AddArray( query.CellArray );
+    query.CellArray->Delete();
+    query.Mesh->GetCellData()->SetActiveScalars( "Distance" );
+
+    query.Implicit->Delete();
+    }
+  values->Delete();
 
   vtkDebugMacro(<<"End vtkDistancePolyDataFilter::GetPolyDataDistance");
 }
@@ -188,4 +379,6 @@ void vtkDistancePolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "SignedDistance: " << this->SignedDistance << "\n";
   os << indent << "NegateDistance: " << this->NegateDistance << "\n";
   os << indent << "ComputeSecondDistance: " << this->ComputeSecondDistance << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "LocatorCache: " << this->LocatorCache << "\n";
 }
@@ -34,6 +34,8 @@
 
 #include "vtkPolyDataAlgorithm.h"
 
+class vtkPolyDataLocatorCache;
+
 class vtkDistancePolyDataFilter : public vtkPolyDataAlgorithm {
 public:
   static vtkDistancePolyDataFilter *New();
@@ -61,11 +63,34 @@ public:
   vtkGetMacro(ComputeSecondDistance,int);
   vtkBooleanMacro(ComputeSecondDistance,int);
 
+  // Description:
+  // Set/get the number of threads used to evaluate the distances. With
+  // more than one thread, the cell centers of both outputs are computed
+  // concurrently, and the points and cell centers of each output are
+  // then evaluated in one batch shared among the threads; see
+  // vtkImplicitPolyData::EvaluateFunctionAndGradient(). Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Set/get a cache for the cell locators built over the inputs. See
+  // vtkImplicitPolyData::SetLocatorCache(). Defaults to NULL.
+  virtual void SetLocatorCache(vtkPolyDataLocatorCache*);
+  vtkGetObjectMacro(LocatorCache, vtkPolyDataLocatorCache);
+
   // Description:
   // Get the second output, which is a copy of the second input with an
   // additional distance scalar field.
   vtkPolyData* GetSecondDistanceOutput();
 
+  // Description:
+  // Computes the distance from mesh0 to src0 and, if mesh1 is not
+  // NULL, from mesh1 to src1, without going through the pipeline. The
+  // "Distance" point and cell arrays are added to the meshes in place
+  // and made the active scalars.
+  void GetPolyDataDistances(vtkPolyData *mesh0, vtkPolyData *src0,
+                            vtkPolyData *mesh1, vtkPolyData *src1);
+
 protected:
   vtkDistancePolyDataFilter();
   ~vtkDistancePolyDataFilter();
@@ -78,6 +103,9 @@ protected:
   int SignedDistance;
   int NegateDistance;
   int ComputeSecondDistance;
+  int NumberOfThreads;
+
+  vtkPolyDataLocatorCache *LocatorCache;
 
 private:
   vtkDistancePolyDataFilter(const vtkDistancePolyDataFilter&); // no implementation
@@ -14,23 +14,187 @@
 =========================================================================*/
 #include "vtkImplicitPolyData.h"
 
+#include "vtkAbstractTransform.h"
 #include "vtkCellData.h"
 #include "vtkCellLocator.h"
 #include "vtkDataArray.h"
 #include "vtkDataSetToImageFilter.h"
+#include "vtkDoubleArray.h"
 #include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkLine.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkOBBTree.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkPolyDataLocatorCache.h"
 #include "vtkPolygon.h"
+#include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 vtkStandardNewMacro(vtkImplicitPolyData);
 
+//-----------------------------------------------------------------------------
+// Objects a thread needs to evaluate the function.
+class vtkImplicitPolyData::ThreadScratch
+{
+public:
+  ThreadScratch()
+  {
+    this->Locator      = NULL;
+    this->Cell         = vtkGenericCell::New();
+  }
+
+  ~ThreadScratch()
+  {
+    this->Cell->Delete();
+  }
+
+  vtkCellLocator *Locator;
+  vtkGenericCell *Cell;
+};
+
+//-----------------------------------------------------------------------------
+// What SetInput() prepares for an input: the triangulated mesh, its
+// angle-weighted pseudonormals and the cell locators built over the
+// mesh. Evaluating the function only reads the mesh and the normals,
+// so one pool can serve any number of vtkImplicitPolyData objects at
+// once. A locator keeps per-query state, though, so each thread of
+// each object takes one of its own from the pool and gives it back
+// when done; the next object reuses it instead of building another.
+// This is also the entry vtkPolyDataLocatorCache keeps for an input.
+class vtkImplicitPolyDataLocatorPool : public vtkObject
+{
+public:
+  static vtkImplicitPolyDataLocatorPool *New();
+  vtkTypeMacro(vtkImplicitPolyDataLocatorPool, vtkObject);
+
+  // Returns a locator over Mesh built with the given tolerance, taking
+  // a free one if there is one and building it otherwise.
+  vtkCellLocator *AcquireLocator(double tolerance);
+
+  // Gives back a locator returned by AcquireLocator().
+  void ReleaseLocator(vtkCellLocator *locator);
+
+  vtkPolyData    *Mesh;
+  vtkDoubleArray *FaceNormals;
+  vtkDoubleArray *EdgeNormals;
+  vtkDoubleArray *VertexNormals;
+
+protected:
+  vtkImplicitPolyDataLocatorPool();
+  ~vtkImplicitPolyDataLocatorPool();
+
+  // Locators not in use. Lock also serializes the creation of the
+  // locators, which registers the shared mesh. They are built outside
+  // of it, so that the threads of a first evaluation build theirs at
+  // the same time.
+  std::vector< vtkCellLocator* > FreeLocators;
+  vtkSimpleMutexLock            *Lock;
+
+private:
+  vtkImplicitPolyDataLocatorPool(const vtkImplicitPolyDataLocatorPool&);  // Not implemented.
+  void operator=(const vtkImplicitPolyDataLocatorPool&);  // Not implemented.
+};
+
+vtkStandardNewMacro(vtkImplicitPolyDataLocatorPool);
+
+//-----------------------------------------------------------------------------
+vtkImplicitPolyDataLocatorPool::vtkImplicitPolyDataLocatorPool()
+{
+  this->Mesh = vtkPolyData::New();
+  this->FaceNormals = vtkDoubleArray::New();
+  this->EdgeNormals = vtkDoubleArray::New();
+  this->VertexNormals = vtkDoubleArray::New();
+  this->Lock = vtkSimpleMutexLock::New();
+}
+
+//-----------------------------------------------------------------------------
+vtkImplicitPolyDataLocatorPool::~vtkImplicitPolyDataLocatorPool()
+{
+  for (size_t i = 0; i < this->FreeLocators.size(); i++)
+    {
+    this->FreeLocators[i]->Delete();
+    }
+  this->Lock->Delete();
+  this->Mesh->Delete();
+  this->FaceNormals->Delete();
+  this->EdgeNormals->Delete();
+  this->VertexNormals->Delete();
+}
+
+//-----------------------------------------------------------------------------
+vtkCellLocator *vtkImplicitPolyDataLocatorPool::AcquireLocator(double tolerance)
+{
+  this->Lock->Lock();
+  vtkCellLocator *locator = NULL;
+  for (size_t i = 0; i < this->FreeLocators.size(); i++)
+    {
+    if ( this->FreeLocators[i]->GetTolerance() == tolerance )
+      {
+      locator = this->FreeLocators[i];
+      this->FreeLocators.erase(this->FreeLocators.begin() + i);
+      break;
+      }
+    }
+
+  if ( locator == NULL )
+    {
+    locator = vtkCellLocator::New();
+    locator->SetDataSet(this->Mesh);
+    locator->SetTolerance(tolerance);
+    locator->SetNumberOfCellsPerBucket(10);
+    locator->CacheCellBoundsOn();
+    locator->AutomaticOn();
+    this->Lock->Unlock();
+
+    // The build only reads the mesh, whose cells and bounds are ready.
+    locator->BuildLocator();
+    return locator;
+    }
+  this->Lock->Unlock();
+
+  return locator;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyDataLocatorPool::ReleaseLocator(vtkCellLocator *locator)
+{
+  this->Lock->Lock();
+  this->FreeLocators.push_back(locator);
+  this->Lock->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+// Unit normal of a triangle of the input, read from the cell normals
+// if there are any and computed from the points otherwise.
+static void vtkImplicitPolyDataFaceNormal(vtkPolyData *input,
+                                          vtkDataArray *cnorms,
+                                          vtkIdType cellId, double n[3])
+{
+  if ( cnorms )
+    {
+    cnorms->GetTuple(cellId, n);
+    return;
+    }
+
+  vtkIdType npts, *pts;
+  input->GetCellPoints(cellId, npts, pts);
+  double p0[3], p1[3], p2[3];
+  input->GetPoint(pts[0], p0);
+  input->GetPoint(pts[1], p1);
+  input->GetPoint(pts[2], p2);
+  vtkTriangle::ComputeNormal(p0, p1, p2, n);
+}
+
 //-----------------------------------------------------------------------------
 vtkImplicitPolyData::vtkImplicitPolyData()
 {
@@ -38,46 +202,245 @@ vtkImplicitPolyData::vtkImplicitPolyData()
   this->NoGradient[1] = 0.0;
   this->NoGradient[2] = 1.0;
 
-  this->TriangleFilter = NULL;
   this->Input = NULL;
-  this->Locator = NULL;
+  this->Pool = NULL;
   this->Tolerance = 1e-12;
+  this->NumberOfThreads = 1;
+  this->Scratch = NULL;
+  this->LocatorCache = NULL;
 }
 
 //-----------------------------------------------------------------------------
-void vtkImplicitPolyData::SetInput(vtkPolyData* input)
+void vtkImplicitPolyData::SetNumberOfThreads(int numThreads)
+{
+  numThreads = (numThreads < 1 ? 1 :
+                (numThreads > VTK_MAX_THREADS ? VTK_MAX_THREADS : numThreads));
+  if ( this->NumberOfThreads != numThreads )
+    {
+    this->ReleaseThreadScratch();
+    this->NumberOfThreads = numThreads;
+    this->BuildThreadScratch();
+    this->Modified();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Computes the angle-weighted pseudonormals of the faces, of the three
+// edges of each face and of the points of the triangulated input,
+// whose links must be built.
+static void vtkImplicitPolyDataBuildPseudonormals(vtkPolyData *input,
+                                                  vtkDoubleArray *faceArray,
+                                                  vtkDoubleArray *edgeArray,
+                                                  vtkDoubleArray *vertexArray)
 {
-  if ( this->Input != input )
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkIdType numPts = input->GetNumberOfPoints();
+
+  vtkDataArray* cnorms = 0;
+  if ( input->GetCellData() && input->GetCellData()->GetNormals() )
     {
-    // Use a vtkTriangleFilter on the polydata input.
-    // This is done to filter out lines and vertices to leave only
-    // polygons which are required by this algorithm for cell normals.
-    if ( this->TriangleFilter == NULL )
+    cnorms = input->GetCellData()->GetNormals();
+    }
+
+  faceArray->SetNumberOfComponents(3);
+  faceArray->SetNumberOfTuples(numCells);
+  edgeArray->SetNumberOfComponents(3);
+  edgeArray->SetNumberOfTuples(3*numCells);
+  vertexArray->SetNumberOfComponents(3);
+  vertexArray->SetNumberOfTuples(numPts);
+
+  double *faceNormals = faceArray->GetPointer(0);
+  double *edgeNormals = edgeArray->GetPointer(0);
+  double *vertexNormals = vertexArray->GetPointer(0);
+  std::fill(vertexNormals, vertexNormals + 3*numPts, 0.0);
+
+  // Face normals, and the vertex normals as sum(alpha_i * n_i) over
+  // the incident faces, where alpha_i is the angle of face i at the
+  // vertex.
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    double *norm = faceNormals + 3*cellId;
+    vtkImplicitPolyDataFaceNormal(input, cnorms, cellId, norm);
+
+    vtkIdType npts, *pts;
+    input->GetCellPoints(cellId, npts, pts);
+    double x[3][3];
+    for (int i = 0; i < 3; i++)
       {
-      this->TriangleFilter = vtkTriangleFilter::New();
-      this->TriangleFilter->PassVertsOff();
-      this->TriangleFilter->PassLinesOff();
+      input->GetPoint(pts[i], x[i]);
       }
-    this->TriangleFilter->SetInput( input );
-    this->TriangleFilter->Update();
 
-    this->Input = this->TriangleFilter->GetOutput();
+    for (int i = 0; i < 3; i++)
+      {
+      double pb[3], pc[3];
+      for (int j = 0; j < 3; j++)
+        {
+        pb[j] = x[(i+1) % 3][j] - x[i][j];
+        pc[j] = x[(i+2) % 3][j] - x[i][j];
+        }
+      vtkMath::Normalize(pb);
+      vtkMath::Normalize(pc);
+      double cosAlpha = vtkMath::Dot(pb, pc);
+      cosAlpha = (cosAlpha < -1.0 ? -1.0 : (cosAlpha > 1.0 ? 1.0 : cosAlpha));
+      double alpha = acos(cosAlpha);
+
+      double *vertexNormal = vertexNormals + 3*pts[i];
+      vertexNormal[0] += alpha * norm[0];
+      vertexNormal[1] += alpha * norm[1];
+      vertexNormal[2] += alpha * norm[2];
+      }
+    }
 
-    this->Input->BuildLinks();
-    this->NoValue = this->Input->GetLength();
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    vtkMath::Normalize(vertexNormals + 3*ptId);
+    }
+
+  // Edge normals, as the sum of the normals of the faces that share
+  // the edge. Edge i of a cell goes from its point i to point i+1.
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType npts, *pts;
+    input->GetCellPoints(cellId, npts, pts);
+    for (int i = 0; i < 3; i++)
+      {
+      vtkIdType a = pts[i];
+      vtkIdType b = pts[(i+1) % 3];
+      double *edgeNormal = edgeNormals + 3*(3*cellId + i);
+      edgeNormal[0] = edgeNormal[1] = edgeNormal[2] = 0.0;
+
+      unsigned short ncells;
+      vtkIdType *cells;
+      input->GetPointCells(a, ncells, cells);
+      for (unsigned short j = 0; j < ncells; j++)
+        {
+        vtkIdType nbrNpts, *nbrPts;
+        input->GetCellPoints(cells[j], nbrNpts, nbrPts);
+        if ( std::find(nbrPts, nbrPts + nbrNpts, b) != nbrPts + nbrNpts )
+          {
+          double *norm = faceNormals + 3*cells[j];
+          edgeNormal[0] += norm[0];
+          edgeNormal[1] += norm[1];
+          edgeNormal[2] += norm[2];
+          }
+        }
+      vtkMath::Normalize(edgeNormal);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::ReleaseThreadScratch()
+{
+  if ( this->Scratch == NULL )
+    {
+    return;
+    }
 
-    if (this->Locator != NULL)
+  for (int i = 0; i < this->NumberOfThreads; i++)
+    {
+    if ( this->Scratch[i].Locator != NULL )
       {
-      this->Locator->Delete();
+      this->Pool->ReleaseLocator(this->Scratch[i].Locator);
       }
-    this->Locator = vtkCellLocator::New();
-    this->Locator->SetDataSet(this->Input);
-    this->Locator->SetTolerance(this->Tolerance);
-    this->Locator->SetNumberOfCellsPerBucket(10);
-    this->Locator->CacheCellBoundsOn();
-    this->Locator->AutomaticOn();
-    this->Locator->BuildLocator();
     }
+  delete [] this->Scratch;
+  this->Scratch = NULL;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::BuildThreadScratch()
+{
+  if ( this->Pool == NULL )
+    {
+    return;
+    }
+
+  // Threads take their locator from the pool the first time they
+  // evaluate the function, see GetThreadLocator(), so threads that
+  // are never used cost nothing.
+  this->Scratch = new ThreadScratch[this->NumberOfThreads];
+}
+
+//-----------------------------------------------------------------------------
+vtkCellLocator *vtkImplicitPolyData::GetThreadLocator(int threadId)
+{
+  ThreadScratch *scratch = this->Scratch + threadId;
+  if ( scratch->Locator == NULL )
+    {
+    scratch->Locator = this->Pool->AcquireLocator(this->Tolerance);
+    }
+  return scratch->Locator;
+}
+
+//-----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkImplicitPolyData, LocatorCache,
+                     vtkPolyDataLocatorCache);
+
+//-----------------------------------------------------------------------------
+vtkObject* vtkImplicitPolyData::BuildLocatorCacheEntry(vtkPolyData *input)
+{
+  // Use a vtkTriangleFilter on the polydata input.
+  // This is done to filter out lines and vertices to leave only
+  // polygons which are required by this algorithm for cell normals.
+  vtkTriangleFilter *triangleFilter = vtkTriangleFilter::New();
+  triangleFilter->PassVertsOff();
+  triangleFilter->PassLinesOff();
+  triangleFilter->SetInput( input );
+  triangleFilter->Update();
+
+  vtkImplicitPolyDataLocatorPool *pool = vtkImplicitPolyDataLocatorPool::New();
+  pool->Mesh->ShallowCopy( triangleFilter->GetOutput() );
+  pool->Mesh->BuildLinks();
+  pool->Mesh->ComputeBounds();
+  triangleFilter->Delete();
+
+  vtkImplicitPolyDataBuildPseudonormals(pool->Mesh, pool->FaceNormals,
+                                        pool->EdgeNormals,
+                                        pool->VertexNormals);
+  return pool;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::SetPool(vtkImplicitPolyDataLocatorPool *pool)
+{
+  // The locators must go back to the pool they came from.
+  this->ReleaseThreadScratch();
+  if ( this->Pool != NULL )
+    {
+    this->Pool->Delete();
+    }
+
+  this->Pool = pool;
+  this->Input = NULL;
+  if ( pool != NULL )
+    {
+    this->Input = pool->Mesh;
+    this->NoValue = this->Input->GetLength();
+    }
+  this->BuildThreadScratch();
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::SetInput(vtkPolyData* input)
+{
+  if ( input == NULL )
+    {
+    this->SetPool(NULL);
+    return;
+    }
+
+  vtkObject *entry;
+  if ( this->LocatorCache != NULL )
+    {
+    entry = this->LocatorCache->AcquireEntry
+      (input, vtkImplicitPolyData::BuildLocatorCacheEntry);
+    }
+  else
+    {
+    entry = vtkImplicitPolyData::BuildLocatorCacheEntry(input);
+    }
+  this->SetPool(static_cast<vtkImplicitPolyDataLocatorPool*>(entry));
 }
 
 //-----------------------------------------------------------------------------
@@ -99,15 +462,8 @@ unsigned long vtkImplicitPolyData::GetMTime()
 //-----------------------------------------------------------------------------
 vtkImplicitPolyData::~vtkImplicitPolyData()
 {
-  if (this->TriangleFilter != NULL)
-    {
-    this->TriangleFilter->Delete();
-    }
-
-  if (this->Locator != NULL)
-    {
-    this->Locator->Delete();
-    }
+  this->SetPool(NULL);
+  this->SetLocatorCache(NULL);
 }
 
 //-----------------------------------------------------------------------------
@@ -123,10 +479,294 @@ void vtkImplicitPolyData::EvaluateGradient(double x[3], double n[3])
   SharedEvaluate(x, n);	// get normal, returned distance value not used
 }
 
+//-----------------------------------------------------------------------------
+double vtkImplicitPolyData::EvaluateFunction(double x[3], int threadId)
+{
+  double n[3];
+  return SharedEvaluate(x, n, threadId);
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::EvaluateGradient(double x[3], double n[3],
+                                           int threadId)
+{
+  SharedEvaluate(x, n, threadId);
+}
+
+//-----------------------------------------------------------------------------
+double vtkImplicitPolyData::EvaluateFunctionAndGradient(double x[3],
+                                                        double g[3],
+                                                        vtkIdType &closestCellId,
+                                                        int threadId)
+{
+  return SharedEvaluate(x, g, threadId, &closestCellId);
+}
+
+//-----------------------------------------------------------------------------
+// Spreads the lower 21 bits of v so that there are two zero bits
+// between consecutive bits.
+static vtkTypeUInt64 vtkImplicitPolyDataSpreadBits(vtkTypeUInt64 v)
+{
+  v &= 0x1fffff;
+  v = (v | (v << 32)) & 0x1f00000000ffffULL;
+  v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+  v = (v | (v << 8))  & 0x100f00f00f00f00fULL;
+  v = (v | (v << 4))  & 0x10c30c30c30c30c3ULL;
+  v = (v | (v << 2))  & 0x1249249249249249ULL;
+  return v;
+}
+
+//-----------------------------------------------------------------------------
+// Query batch shared by the threads of EvaluateFunctionAndGradient().
+typedef struct _ImplicitPolyDataBatch {
+  vtkImplicitPolyData *Function;
+  vtkDataArray        *Points;
+  double              *Distances;
+  double              *Gradients;
+  vtkIdType           *ClosestCellIds;
+
+  // Query indices in Morton order.
+  std::vector< std::pair< vtkTypeUInt64, vtkIdType > > Order;
+
+  // Next position in Order to hand out.
+  vtkIdType            NextQuery;
+  vtkSimpleMutexLock   Lock;
+  int                  NumberOfThreads;
+} ImplicitPolyDataBatchType;
+
+//-----------------------------------------------------------------------------
+static void vtkImplicitPolyDataEvaluateRange(ImplicitPolyDataBatchType *batch,
+                                             vtkIdType begin, vtkIdType end,
+                                             int threadId)
+{
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    vtkIdType ptId = batch->Order[i].second;
+    double x[3], g[3];
+    vtkIdType cellId;
+    batch->Points->GetTuple(ptId, x);
+    double value = batch->Function->EvaluateFunctionAndGradient
+      (x, g, cellId, threadId);
+
+    batch->Distances[ptId] = value;
+    if (batch->Gradients)
+      {
+      batch->Gradients[3*ptId]   = g[0];
+      batch->Gradients[3*ptId+1] = g[1];
+      batch->Gradients[3*ptId+2] = g[2];
+      }
+    if (batch->ClosestCellIds)
+      {
+      batch->ClosestCellIds[ptId] = cellId;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImplicitPolyDataEvaluateThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ImplicitPolyDataBatchType *batch =
+    static_cast<ImplicitPolyDataBatchType*>(threadInfo->UserData);
+  int threadId = threadInfo->ThreadID;
+  if (threadId >= batch->NumberOfThreads)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  const vtkIdType chunkSize = 256;
+  vtkIdType numQueries = static_cast<vtkIdType>(batch->Order.size());
+  while (true)
+    {
+    batch->Lock.Lock();
+    vtkIdType begin = batch->NextQuery;
+    vtkIdType end = std::min(begin + chunkSize, numQueries);
+    batch->NextQuery = end;
+    batch->Lock.Unlock();
+
+    if (begin >= end)
+      {
+      break;
+      }
+    vtkImplicitPolyDataEvaluateRange(batch, begin, end, threadId);
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::EvaluateFunctionAndGradient(vtkDataArray *points,
+                                                      vtkDoubleArray *distances,
+                                                      vtkDoubleArray *gradients,
+                                                      vtkIdTypeArray *closestCellIds)
+{
+  if (points == NULL || distances == NULL ||
+      points->GetNumberOfComponents() != 3)
+    {
+    vtkErrorMacro(<<"Need a 3-component point array and a distance array.");
+    return;
+    }
+
+  vtkIdType numPts = points->GetNumberOfTuples();
+  distances->SetNumberOfComponents(1);
+  distances->SetNumberOfTuples(numPts);
+  if (gradients)
+    {
+    gradients->SetNumberOfComponents(3);
+    gradients->SetNumberOfTuples(numPts);
+    }
+  if (closestCellIds)
+    {
+    closestCellIds->SetNumberOfComponents(1);
+    closestCellIds->SetNumberOfTuples(numPts);
+    }
+  if (numPts == 0)
+    {
+    return;
+    }
+
+  ImplicitPolyDataBatchType batch;
+  batch.Function       = this;
+  batch.Points         = points;
+  batch.Distances      = distances->GetPointer(0);
+  batch.Gradients      = gradients ? gradients->GetPointer(0) : NULL;
+  batch.ClosestCellIds = closestCellIds ? closestCellIds->GetPointer(0) : NULL;
+  batch.NextQuery      = 0;
+  batch.NumberOfThreads = this->NumberOfThreads;
+
+  // Sort the queries along a Morton curve over their bounding box.
+  double bounds[6] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                      VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    double x[3];
+    points->GetTuple(i, x);
+    for (int j = 0; j < 3; j++)
+      {
+      bounds[2*j]   = std::min(bounds[2*j], x[j]);
+      bounds[2*j+1] = std::max(bounds[2*j+1], x[j]);
+      }
+    }
+
+  double scale[3];
+  for (int j = 0; j < 3; j++)
+    {
+    double length = bounds[2*j+1] - bounds[2*j];
+    scale[j] = (length > 0.0 ? 2097151.0 / length : 0.0);
+    }
+
+  batch.Order.resize(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    double x[3];
+    points->GetTuple(i, x);
+    vtkTypeUInt64 key = 0;
+    for (int j = 0; j < 3; j++)
+      {
+      vtkTypeUInt64 cell =
+        static_cast<vtkTypeUInt64>((x[j] - bounds[2*j]) * scale[j]);
+      key |= vtkImplicitPolyDataSpreadBits(cell) << j;
+      }
+    batch.Order[i] = std::make_pair(key, i);
+    }
+  std::sort(batch.Order.begin(), batch.Order.end());
+
+  if (this->NumberOfThreads > 1)
+    {
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->SetNumberOfThreads(this->NumberOfThreads);
+    threader->SetSingleMethod(vtkImplicitPolyDataEvaluateThread, &batch);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+  else
+    {
+    vtkImplicitPolyDataEvaluateRange(&batch, 0, numPts, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::FunctionValue(vtkDataArray *input,
+                                        vtkDataArray *output)
+{
+  if (input == NULL || output == NULL)
+    {
+    vtkErrorMacro(<<"Need an input and an output array.");
+    return;
+    }
+
+  // Transform the points the way vtkImplicitFunction::FunctionValue()
+  // does for a single point.
+  vtkDataArray *points = input;
+  vtkDoubleArray *transformed = NULL;
+  if (this->Transform != NULL && input->GetNumberOfComponents() == 3)
+    {
+    this->Transform->Update();
+    vtkIdType numPts = input->GetNumberOfTuples();
+    transformed = vtkDoubleArray::New();
+    transformed->SetNumberOfComponents(3);
+    transformed->SetNumberOfTuples(numPts);
+    for (vtkIdType i = 0; i < numPts; i++)
+      {
+      double x[3];
+      input->GetTuple(i, x);
+      this->Transform->TransformPoint(x, transformed->GetPointer(3*i));
+      }
+    points = transformed;
+    }
+
+  // Evaluate straight into output if it holds doubles.
+  vtkDoubleArray *distances = vtkDoubleArray::SafeDownCast(output);
+  if (distances == NULL)
+    {
+    distances = vtkDoubleArray::New();
+    }
+  this->EvaluateFunctionAndGradient(points, distances, NULL, NULL);
+
+  if (distances != output)
+    {
+    vtkIdType numValues = distances->GetNumberOfTuples();
+    output->SetNumberOfComponents(1);
+    output->SetNumberOfTuples(numValues);
+    for (vtkIdType i = 0; i < numValues; i++)
+      {
+      output->SetComponent(i, 0, distances->GetValue(i));
+      }
+    distances->Delete();
+    }
+
+  if (transformed != NULL)
+    {
+    transformed->Delete();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitPolyData::EvaluateGradient(vtkDataArray *points,
+                                           vtkDoubleArray *gradients)
+{
+  vtkDoubleArray *distances = vtkDoubleArray::New();
+  this->EvaluateFunctionAndGradient(points, distances, gradients, NULL);
+  distances->Delete();
+}
+
 //-----------------------------------------------------------------------------
 double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3])
+{
+  return SharedEvaluate(x, n, 0);
+}
+
+//-----------------------------------------------------------------------------
+double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3],
+                                           int threadId,
+                                           vtkIdType *closestCellId)
 {
   double ret = this->NoValue;
+  if (closestCellId)
+    {
+    *closestCellId = -1;
+    }
   for( int i=0; i < 3; i++ )
     {
     n[i] = this->NoGradient[i];
@@ -144,15 +784,20 @@ double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3])
   int subId;
   double vlen2;
 
-  vtkDataArray* cnorms = 0;
-  if ( this->Input->GetCellData() && this->Input->GetCellData()->GetNormals() )
+  if (threadId < 0 || threadId >= this->NumberOfThreads)
     {
-    cnorms = this->Input->GetCellData()->GetNormals();
+    vtkErrorMacro(<<"Invalid thread ID " << threadId);
+    return ret;
     }
+  vtkCellLocator *locator = this->GetThreadLocator(threadId);
 
   // Get point id of closest point in data set.
-  vtkGenericCell* cell = vtkGenericCell::New();
-  this->Locator->FindClosestPoint(x, p, cell, cellId, subId, vlen2);
+  vtkGenericCell* cell = this->Scratch[threadId].Cell;
+  locator->FindClosestPoint(x, p, cell, cellId, subId, vlen2);
+  if (closestCellId)
+    {
+    *closestCellId = cellId;
+    }
 
   if (cellId != -1)	// point located
     {
@@ -168,76 +813,41 @@ double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3])
     double closestPoint[3];
     cell->EvaluatePosition(p, closestPoint, subId, pcoords, dist2, weights);
 
-    vtkIdList* idList = vtkIdList::New();
     int count = 0;
     for (int i = 0; i < 3; i++)
       {
       count += (fabs(weights[i]) < this->Tolerance ? 1 : 0);
       }
-    // if weights contains no 0s
-    if ( count == 0 || count == 1 )
+
+    // The pseudonormal at the closest point depends on whether it lies
+    // inside a face, on an edge or on a vertex. All three kinds were
+    // computed in SetInput().
+    if ( count == 0 )
       {
-      // Compute face normal.
-      // For count == 0, this is all we need.
-      // For count = 1, we'll add in the normals from adjacent faces.
-      if ( cnorms )
-        {
-        cnorms->GetTuple(cellId, awnorm);
-        }
-      else
-        {
-        vtkPolygon::ComputeNormal(cell->Points, awnorm);
-        }
+      this->Pool->FaceNormals->GetTupleValue(cellId, awnorm);
       }
 
     // if weights contains 1 0s
-    if ( count == 1 )
+    else if ( count == 1 )
       {
-      // ... edge ... get two adjacent faces, compute average normal
-      int a = -1, b = -1;
-      for ( int edge = 0; edge < 3; edge++ )
+      // ... edge ... the edge opposite the point with zero weight
+      int edge = -1;
+      for ( int i = 0; i < 3; i++ )
         {
-        if ( fabs(weights[edge]) < this->Tolerance )
+        if ( fabs(weights[i]) < this->Tolerance )
           {
-          a = cell->PointIds->GetId((edge + 1) % 3);
-          b = cell->PointIds->GetId((edge + 2) % 3);
+          edge = (i + 1) % 3;
           break;
           }
         }
-
-      if ( a == -1 )
-        {
-        vtkErrorMacro( << "Could not find edge when closest point is "
-                       << "expected to be on an edge." );
-        return this->NoValue;
-        }
-
-      this->Input->GetCellEdgeNeighbors(0, a, b, idList);
-      for (int i = 0; i < idList->GetNumberOfIds(); i++)
-        {
-        double norm[3];
-        if (cnorms)
-          {
-          cnorms->GetTuple(idList->GetId(i), norm);
-          }
-        else
-          {
-          vtkPolygon::ComputeNormal(this->Input->GetCell(idList->GetId(i))->GetPoints(), norm);
-          }
-        awnorm[0] += norm[0];
-        awnorm[1] += norm[1];
-        awnorm[2] += norm[2];
-        }
-      vtkMath::Normalize(awnorm);
+      this->Pool->EdgeNormals->GetTupleValue(3*cellId + edge, awnorm);
       }
 
     // If weights contains 2 0s
     else if ( count == 2 )
       {
-      // ... vertex ... this is the expensive case, get all adjacent
-      // faces and compute sum(a_i * n_i) Angle-Weighted Pseudo
-      // Normals, J. Andreas Baerentzen and Henrik Aanaes
-      int a = -1;
+      // ... vertex ...
+      vtkIdType a = -1;
       for (int i = 0; i < 3; i++)
         {
         if ( fabs( weights[i] ) > this->Tolerance )
@@ -253,42 +863,8 @@ double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3])
         return this->NoValue;
         }
 
-      this->Input->GetPointCells(a, idList);
-      for (int i = 0; i < idList->GetNumberOfIds(); i++)
-        {
-        double norm[3];
-        if ( cnorms )
-          {
-          cnorms->GetTuple(idList->GetId(i), norm);
-          }
-       else
-          {
-          vtkPolygon::ComputeNormal(this->Input->GetCell(idList->GetId(i))->GetPoints(), norm);
-          }
-
-        // Compute angle at point a
-        int b = this->Input->GetCell(idList->GetId(i))->GetPointId(0);
-        int c = this->Input->GetCell(idList->GetId(i))->GetPointId(1);
-        if (a == b)
-          b = this->Input->GetCell(idList->GetId(i))->GetPointId(2);
-        else if (a == c)
-          c = this->Input->GetCell(idList->GetId(i))->GetPointId(2);
-
-        double pa[3], pb[3], pc[3];
-        this->Input->GetPoint(a, pa);
-        this->Input->GetPoint(b, pb);
-        this->Input->GetPoint(c, pc);
-        for (int j = 0; j < 3; j++) { pb[j] -= pa[j]; pc[j] -= pa[j]; }
-        vtkMath::Normalize(pb);
-        vtkMath::Normalize(pc);
-        double alpha = acos(vtkMath::Dot(pb, pc));
-        awnorm[0] += alpha * norm[0];
-        awnorm[1] += alpha * norm[1];
-        awnorm[2] += alpha * norm[2];
-        }
-      vtkMath::Normalize(awnorm);
+      this->Pool->VertexNormals->GetTupleValue(a, awnorm);
       }
-    idList->Delete();
 
     // sign(dist) = dot(grad, cell normal)
     if (ret == 0)
@@ -308,7 +884,6 @@ double vtkImplicitPolyData::SharedEvaluate(double x[3], double n[3])
         }
       }
     }
-  cell->Delete();
 
   return ret;
 }
@@ -322,6 +897,8 @@ void vtkImplicitPolyData::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NoGradient: (" << this->NoGradient[0] << ", "
      << this->NoGradient[1] << ", " << this->NoGradient[2] << ")\n";
   os << indent << "Tolerance: " << this->Tolerance << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "LocatorCache: " << this->LocatorCache << "\n";
 
   if (this->Input)
     {
@@ -38,8 +38,12 @@
 
 
 class vtkCellLocator;
+class vtkDataArray;
+class vtkDoubleArray;
+class vtkIdTypeArray;
+class vtkImplicitPolyDataLocatorPool;
 class vtkPolyData;
-class vtkTriangleFilter;
+class vtkPolyDataLocatorCache;
 
 class vtkImplicitPolyData : public vtkImplicitFunction
 {
@@ -60,13 +64,88 @@ public:
   // Evaluate function gradient of nearest triangle to point x[3].
   void EvaluateGradient(double x[3], double g[3]);
 
+  // Description:
+  // Thread-safe versions of EvaluateFunction() and
+  // EvaluateGradient(). threadId must be less than NumberOfThreads,
+  // and no two threads may evaluate with the same threadId at the
+  // same time.
+  double EvaluateFunction(double x[3], int threadId);
+  void EvaluateGradient(double x[3], double g[3], int threadId);
+
+  // Description:
+  // Evaluates the function and its gradient at x in one pass and
+  // returns the ID of the closest cell in closestCellId, or -1 if
+  // there is none. Thread-safe in the same way as
+  // EvaluateFunction(x, threadId).
+  double EvaluateFunctionAndGradient(double x[3], double g[3],
+                                     vtkIdType &closestCellId, int threadId);
+
+  // Description:
+  // Evaluates the function at every tuple of the 3-component array
+  // points. distances receives one value per point. If not NULL,
+  // gradients receives the gradients and closestCellIds the IDs of
+  // the closest cells. The queries are visited in Morton order, so
+  // that consecutive queries touch the same locator buckets, and are
+  // shared among NumberOfThreads threads.
+  void EvaluateFunctionAndGradient(vtkDataArray *points,
+                                   vtkDoubleArray *distances,
+                                   vtkDoubleArray *gradients,
+                                   vtkIdTypeArray *closestCellIds);
+
+  // Description:
+  // Evaluates the function at every tuple of the 3-component array
+  // input, transformed by Transform if there is one, and stores the
+  // values in the 1-component array output. Overrides the
+  // vtkImplicitFunction version, which makes one virtual call per
+  // point, with the batched queries of EvaluateFunctionAndGradient().
+  virtual void FunctionValue(vtkDataArray *input, vtkDataArray *output);
+  double FunctionValue(const double x[3])
+    {return this->vtkImplicitFunction::FunctionValue(x);}
+
+  // Description:
+  // Batched version of EvaluateGradient(). See
+  // EvaluateFunctionAndGradient().
+  void EvaluateGradient(vtkDataArray *points, vtkDoubleArray *gradients);
+
+  // Description:
+  // Set/get the number of threads that may evaluate the function at
+  // the same time. The cell locator used to find the closest point
+  // keeps per-query state, so each thread gets its own locator and
+  // scratch cells. Each thread takes its locator the first time it
+  // evaluates the function. Defaults to 1.
+  void SetNumberOfThreads(int numThreads);
+  vtkGetMacro(NumberOfThreads, int);
+
   // Description:
   // Set the input vtkPolyData used for the implicit function
   // evaluation.  Passes input through an internal instance of
   // vtkTriangleFilter to remove vertices and lines, leaving only
-  // triangular polygons for evaluation as implicit planes.
+  // triangular polygons for evaluation as implicit planes. The
+  // angle-weighted pseudonormals of all faces, edges and points are
+  // computed here, so evaluation only needs to look them up. If there
+  // is a LocatorCache, the triangulated input and its pseudonormals
+  // are taken from it instead.
   void SetInput(vtkPolyData *input);
 
+  // Description:
+  // Set/get a cache from which SetInput() takes the triangulated input
+  // and its pseudonormals instead of building them. The cache entry
+  // also keeps the cell locators of the objects that used it: each
+  // thread takes one that is not in use, or builds one, and gives it
+  // back when the input or the number of threads changes, so several
+  // objects may evaluate the same cached input at once. Defaults to
+  // NULL.
+  virtual void SetLocatorCache(vtkPolyDataLocatorCache*);
+  vtkGetObjectMacro(LocatorCache, vtkPolyDataLocatorCache);
+
+  // Description:
+  // Builds the triangulated input and its pseudonormals as a
+  // vtkPolyDataLocatorCache entry, which then keeps the cell locators
+  // built over them. Pass it to
+  // vtkPolyDataLocatorCache::Prebuild() or Pin() to prepare an input
+  // ahead of time.
+  static vtkObject* BuildLocatorCacheEntry(vtkPolyData *input);
+
   // Description:
   // Set/get the function value to use if no input vtkPolyData
   // specified.
@@ -91,16 +170,40 @@ protected:
   double NoValue;
   double NoGradient[3];
   double Tolerance;
+  int    NumberOfThreads;
 
   double SharedEvaluate( double x[3], double n[3] );
+  double SharedEvaluate( double x[3], double n[3], int threadId,
+                         vtkIdType *closestCellId = NULL );
 
 private:
   vtkImplicitPolyData(const vtkImplicitPolyData&);  // Not implemented.
   void operator=(const vtkImplicitPolyData&);  // Not implemented.
 
-  vtkTriangleFilter *TriangleFilter;
+  void BuildThreadScratch();
+  void ReleaseThreadScratch();
+
+  // Description:
+  // Returns the locator of thread threadId, taking it from the pool
+  // if needed.
+  vtkCellLocator *GetThreadLocator(int threadId);
+
+  // Description:
+  // Takes over the reference to pool, whose mesh becomes the input.
+  void SetPool(vtkImplicitPolyDataLocatorPool *pool);
+
   vtkPolyData       *Input;
-  vtkCellLocator    *Locator;
+
+  vtkPolyDataLocatorCache *LocatorCache;
+
+  // The triangulated input, its angle-weighted pseudonormals and the
+  // locators built over it, possibly shared with other objects
+  // through the LocatorCache.
+  vtkImplicitPolyDataLocatorPool *Pool;
+
+  // Per-thread locators and scratch objects.
+  class ThreadScratch;
+  ThreadScratch      *Scratch;
 
 };
 
@@ -0,0 +1,530 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImplicitWindingNumber.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImplicitWindingNumber.h"
+
+#include "vtkAbstractTransform.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+#include "vtkTriangleFilter.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkImplicitWindingNumber);
+
+//-----------------------------------------------------------------------------
+// A cluster of triangles. Leaves refer to the triangles
+// [Begin, End) of Hierarchy::Points; inner nodes to their two
+// children.
+struct vtkWindingNumberNode
+{
+  // Area-weighted centroid of the triangles.
+  double    Center[3];
+
+  // Largest distance from Center to a triangle vertex.
+  double    Radius;
+
+  // Sum of the area-weighted normals of the triangles.
+  double    AreaNormal[3];
+
+  int       Children[2];
+  vtkIdType Begin;
+  vtkIdType End;
+};
+
+//-----------------------------------------------------------------------------
+class vtkImplicitWindingNumber::Hierarchy
+{
+public:
+  // Triangle vertex coordinates, 9 per triangle, in hierarchy order.
+  std::vector< double > Points;
+
+  // Triangle centroids, 3 per triangle, in input order. Only needed
+  // while building.
+  std::vector< double > Centroids;
+
+  std::vector< vtkWindingNumberNode > Nodes;
+
+  int Build(vtkIdType *order, vtkIdType begin, vtkIdType end,
+            int trianglesPerLeaf, const std::vector< double > &inPoints);
+};
+
+//-----------------------------------------------------------------------------
+// Orders triangle ids by one coordinate of their centroids.
+class vtkWindingNumberCentroidLess
+{
+public:
+  vtkWindingNumberCentroidLess(const double *centroids, int axis)
+    : Centroids(centroids), Axis(axis) {}
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    return this->Centroids[3*a + this->Axis] <
+      this->Centroids[3*b + this->Axis];
+  }
+
+  const double *Centroids;
+  int           Axis;
+};
+
+//-----------------------------------------------------------------------------
+int vtkImplicitWindingNumber::Hierarchy
+::Build(vtkIdType *order, vtkIdType begin, vtkIdType end,
+        int trianglesPerLeaf, const std::vector< double > &inPoints)
+{
+  int nodeId = static_cast<int>(this->Nodes.size());
+  this->Nodes.push_back(vtkWindingNumberNode());
+
+  // Dipole of the cluster.
+  double center[3] = {0.0, 0.0, 0.0};
+  double areaNormal[3] = {0.0, 0.0, 0.0};
+  double area = 0.0;
+  double cmin[3] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX};
+  double cmax[3] = {VTK_DOUBLE_MIN, VTK_DOUBLE_MIN, VTK_DOUBLE_MIN};
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    const double *tri = &inPoints[9*order[i]];
+    const double *c = &this->Centroids[3*order[i]];
+    double e1[3], e2[3], n[3];
+    for (int j = 0; j < 3; j++)
+      {
+      e1[j] = tri[3+j] - tri[j];
+      e2[j] = tri[6+j] - tri[j];
+      }
+    vtkMath::Cross(e1, e2, n);
+    double a = 0.5 * vtkMath::Norm(n);
+    for (int j = 0; j < 3; j++)
+      {
+      areaNormal[j] += 0.5 * n[j];
+      center[j] += a * c[j];
+      cmin[j] = std::min(cmin[j], c[j]);
+      cmax[j] = std::max(cmax[j], c[j]);
+      }
+    area += a;
+    }
+
+  for (int j = 0; j < 3; j++)
+    {
+    center[j] = (area > 0.0 ? center[j] / area : 0.5 * (cmin[j] + cmax[j]));
+    }
+
+  double radius2 = 0.0;
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    const double *tri = &inPoints[9*order[i]];
+    for (int k = 0; k < 3; k++)
+      {
+      radius2 = std::max(radius2,
+                         vtkMath::Distance2BetweenPoints(tri + 3*k, center));
+      }
+    }
+
+  vtkWindingNumberNode &node = this->Nodes[nodeId];
+  for (int j = 0; j < 3; j++)
+    {
+    node.Center[j] = center[j];
+    node.AreaNormal[j] = areaNormal[j];
+    }
+  node.Radius = sqrt(radius2);
+  node.Children[0] = node.Children[1] = -1;
+  node.Begin = begin;
+  node.End = end;
+
+  if (end - begin <= trianglesPerLeaf)
+    {
+    return nodeId;
+    }
+
+  // Split at the median centroid along the longest axis.
+  int axis = 0;
+  for (int j = 1; j < 3; j++)
+    {
+    if (cmax[j] - cmin[j] > cmax[axis] - cmin[axis])
+      {
+      axis = j;
+      }
+    }
+  vtkIdType mid = begin + (end - begin) / 2;
+  std::nth_element(order + begin, order + mid, order + end,
+                   vtkWindingNumberCentroidLess(&this->Centroids[0], axis));
+
+  int left = this->Build(order, begin, mid, trianglesPerLeaf, inPoints);
+  int right = this->Build(order, mid, end, trianglesPerLeaf, inPoints);
+
+  // The node vector may have been reallocated by the recursion.
+  this->Nodes[nodeId].Children[0] = left;
+  this->Nodes[nodeId].Children[1] = right;
+
+  return nodeId;
+}
+
+//-----------------------------------------------------------------------------
+// Signed solid angle subtended by the triangle (a, b, c), given
+// relative to the query point (Van Oosterom and Strackee).
+static double vtkWindingNumberSolidAngle(const double a[3], const double b[3],
+                                         const double c[3])
+{
+  double la = vtkMath::Norm(a);
+  double lb = vtkMath::Norm(b);
+  double lc = vtkMath::Norm(c);
+  double bc[3];
+  vtkMath::Cross(b, c, bc);
+  double numerator = vtkMath::Dot(a, bc);
+  double denominator = la*lb*lc + vtkMath::Dot(a, b)*lc +
+    vtkMath::Dot(b, c)*la + vtkMath::Dot(c, a)*lb;
+
+  return 2.0 * atan2(numerator, denominator);
+}
+
+//-----------------------------------------------------------------------------
+vtkImplicitWindingNumber::vtkImplicitWindingNumber()
+{
+  this->NoValue = 0.5;
+  this->Beta = 2.0;
+  this->NumberOfTrianglesPerLeaf = 8;
+  this->NumberOfThreads = 1;
+
+  this->TriangleFilter = NULL;
+  this->Input = NULL;
+  this->Tree = new Hierarchy;
+}
+
+//-----------------------------------------------------------------------------
+vtkImplicitWindingNumber::~vtkImplicitWindingNumber()
+{
+  if (this->TriangleFilter != NULL)
+    {
+    this->TriangleFilter->Delete();
+    }
+
+  delete this->Tree;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitWindingNumber::SetInput(vtkPolyData* input)
+{
+  if ( this->Input != input )
+    {
+    if ( this->TriangleFilter == NULL )
+      {
+      this->TriangleFilter = vtkTriangleFilter::New();
+      this->TriangleFilter->PassVertsOff();
+      this->TriangleFilter->PassLinesOff();
+      }
+    this->TriangleFilter->SetInput( input );
+    this->TriangleFilter->Update();
+
+    this->Input = this->TriangleFilter->GetOutput();
+    this->BuildHierarchy();
+    this->Modified();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitWindingNumber::BuildHierarchy()
+{
+  Hierarchy *tree = this->Tree;
+  tree->Points.clear();
+  tree->Centroids.clear();
+  tree->Nodes.clear();
+
+  vtkPolyData *input = this->Input;
+  vtkIdType numCells = input->GetNumberOfCells();
+
+  std::vector< double > inPoints;
+  inPoints.reserve(9*numCells);
+  tree->Centroids.reserve(3*numCells);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType npts, *pts;
+    input->GetCellPoints(cellId, npts, pts);
+    if (npts != 3)
+      {
+      continue;
+      }
+
+    double centroid[3] = {0.0, 0.0, 0.0};
+    for (int i = 0; i < 3; i++)
+      {
+      double x[3];
+      input->GetPoint(pts[i], x);
+      for (int j = 0; j < 3; j++)
+        {
+        inPoints.push_back(x[j]);
+        centroid[j] += x[j] / 3.0;
+        }
+      }
+    tree->Centroids.insert(tree->Centroids.end(), centroid, centroid + 3);
+    }
+
+  vtkIdType numTris = static_cast<vtkIdType>(inPoints.size() / 9);
+  if (numTris == 0)
+    {
+    return;
+    }
+
+  std::vector< vtkIdType > order(numTris);
+  for (vtkIdType i = 0; i < numTris; i++)
+    {
+    order[i] = i;
+    }
+  tree->Build(&order[0], 0, numTris, this->NumberOfTrianglesPerLeaf,
+              inPoints);
+
+  // Store the triangles in hierarchy order so that each leaf is
+  // contiguous.
+  tree->Points.resize(9*numTris);
+  for (vtkIdType i = 0; i < numTris; i++)
+    {
+    std::copy(&inPoints[9*order[i]], &inPoints[9*order[i]] + 9,
+              &tree->Points[9*i]);
+    }
+
+  std::vector< double >().swap(tree->Centroids);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkImplicitWindingNumber::GetMTime()
+{
+  unsigned long mTime=this->vtkImplicitFunction::GetMTime();
+  unsigned long InputMTime;
+
+  if ( this->Input != NULL )
+    {
+    this->Input->Update();
+    InputMTime = this->Input->GetMTime();
+    mTime = (InputMTime > mTime ? InputMTime : mTime);
+    }
+
+  return mTime;
+}
+
+//-----------------------------------------------------------------------------
+double vtkImplicitWindingNumber::GetWindingNumber(double x[3])
+{
+  const Hierarchy *tree = this->Tree;
+  if ( tree->Nodes.empty() )
+    {
+    return 0.5 - this->NoValue;
+    }
+
+  // The hierarchy is split at the median, so its depth is bounded by
+  // the number of bits in a triangle id.
+  int stack[2*8*sizeof(vtkIdType)];
+  int top = 0;
+  stack[top++] = 0;
+
+  double beta2 = this->Beta * this->Beta;
+  double omega = 0.0;
+  while (top > 0)
+    {
+    const vtkWindingNumberNode &node = tree->Nodes[stack[--top]];
+    double d[3] = {node.Center[0] - x[0],
+                   node.Center[1] - x[1],
+                   node.Center[2] - x[2]};
+    double r2 = vtkMath::Dot(d, d);
+
+    if (r2 > beta2 * node.Radius * node.Radius)
+      {
+      // Far away: the cluster acts as a single dipole.
+      omega += vtkMath::Dot(d, node.AreaNormal) / (r2 * sqrt(r2));
+      }
+    else if (node.Children[0] >= 0)
+      {
+      stack[top++] = node.Children[0];
+      stack[top++] = node.Children[1];
+      }
+    else
+      {
+      for (vtkIdType i = node.Begin; i < node.End; i++)
+        {
+        const double *tri = &tree->Points[9*i];
+        double a[3], b[3], c[3];
+        for (int j = 0; j < 3; j++)
+          {
+          a[j] = tri[j]   - x[j];
+          b[j] = tri[3+j] - x[j];
+          c[j] = tri[6+j] - x[j];
+          }
+        omega += vtkWindingNumberSolidAngle(a, b, c);
+        }
+      }
+    }
+
+  return omega / (4.0 * vtkMath::Pi());
+}
+
+//-----------------------------------------------------------------------------
+double vtkImplicitWindingNumber::EvaluateFunction(double x[3])
+{
+  return 0.5 - this->GetWindingNumber(x);
+}
+
+//-----------------------------------------------------------------------------
+// Query batch shared by the threads of FunctionValue().
+typedef struct _WindingNumberBatch {
+  vtkImplicitWindingNumber *Function;
+  vtkAbstractTransform     *Transform;
+  vtkDataArray             *Points;
+  double                   *Values;
+  vtkIdType                 NumberOfPoints;
+
+  // Next point to hand out.
+  vtkIdType                 NextPoint;
+  vtkSimpleMutexLock        Lock;
+  int                       NumberOfThreads;
+} WindingNumberBatchType;
+
+//-----------------------------------------------------------------------------
+static void vtkWindingNumberEvaluateRange(WindingNumberBatchType *batch,
+                                          vtkIdType begin, vtkIdType end)
+{
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    double x[3], y[3];
+    batch->Points->GetTuple(i, x);
+    if (batch->Transform)
+      {
+      batch->Transform->TransformPoint(x, y);
+      batch->Values[i] = batch->Function->EvaluateFunction(y);
+      }
+    else
+      {
+      batch->Values[i] = batch->Function->EvaluateFunction(x);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkWindingNumberEvaluateThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  WindingNumberBatchType *batch =
+    static_cast<WindingNumberBatchType*>(threadInfo->UserData);
+  if (threadInfo->ThreadID >= batch->NumberOfThreads)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  const vtkIdType chunkSize = 256;
+  while (true)
+    {
+    batch->Lock.Lock();
+    vtkIdType begin = batch->NextPoint;
+    vtkIdType end = std::min(begin + chunkSize, batch->NumberOfPoints);
+    batch->NextPoint = end;
+    batch->Lock.Unlock();
+
+    if (begin >= end)
+      {
+      break;
+      }
+    vtkWindingNumberEvaluateRange(batch, begin, end);
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitWindingNumber::FunctionValue(vtkDataArray *input,
+                                             vtkDataArray *output)
+{
+  if (input == NULL || output == NULL || input->GetNumberOfComponents() != 3)
+    {
+    vtkErrorMacro(<<"Need a 3-component point array and an output array.");
+    return;
+    }
+
+  vtkIdType numPts = input->GetNumberOfTuples();
+  std::vector< double > values(numPts);
+
+  WindingNumberBatchType batch;
+  batch.Function        = this;
+  batch.Transform       = this->Transform;
+  batch.Points          = input;
+  batch.Values          = numPts > 0 ? &values[0] : NULL;
+  batch.NumberOfPoints  = numPts;
+  batch.NextPoint       = 0;
+  batch.NumberOfThreads = this->NumberOfThreads;
+  if (batch.Transform)
+    {
+    batch.Transform->Update();
+    }
+
+  if (this->NumberOfThreads > 1 && numPts > 0)
+    {
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->SetNumberOfThreads(this->NumberOfThreads);
+    threader->SetSingleMethod(vtkWindingNumberEvaluateThread, &batch);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+  else
+    {
+    vtkWindingNumberEvaluateRange(&batch, 0, numPts);
+    }
+
+  output->SetNumberOfComponents(1);
+  output->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    output->SetComponent(i, 0, values[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitWindingNumber::EvaluateGradient(double x[3], double g[3])
+{
+  double h = 1e-6;
+  if ( this->Input != NULL && this->Input->GetLength() > 0.0 )
+    {
+    h *= this->Input->GetLength();
+    }
+
+  for (int j = 0; j < 3; j++)
+    {
+    double xp[3] = {x[0], x[1], x[2]};
+    double xm[3] = {x[0], x[1], x[2]};
+    xp[j] += h;
+    xm[j] -= h;
+    g[j] = (this->EvaluateFunction(xp) - this->EvaluateFunction(xm)) / (2.0*h);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImplicitWindingNumber::PrintSelf(ostream& os, vtkIndent indent)
+{
+  vtkImplicitFunction::PrintSelf(os,indent);
+
+  os << indent << "NoValue: " << this->NoValue << "\n";
+  os << indent << "Beta: " << this->Beta << "\n";
+  os << indent << "NumberOfTrianglesPerLeaf: "
+     << this->NumberOfTrianglesPerLeaf << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+
+  if (this->Input)
+    {
+    os << indent << "Input : " << this->Input << "\n";
+    }
+  else
+    {
+    os << indent << "Input : (none)\n";
+    }
+}
@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkImplicitWindingNumber.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkImplicitWindingNumber
+// .SECTION Description
+//
+// Implicit function that classifies a point x as inside or outside
+// an input vtkPolyData using the generalized winding number of the
+// surface around x. The winding number is 1 inside a closed,
+// outward-oriented surface and 0 outside of it, and degrades
+// gracefully near holes and other defects. The function value is 0.5
+// minus the winding number so that, as with vtkImplicitPolyData,
+// points inside have a negative value and points outside a positive
+// value.
+//
+// The triangles of the input are organized in a bounding volume
+// hierarchy. Clusters that are far from x relative to their size are
+// approximated by a single dipole (Barnes-Hut), so that a query costs
+// O(log n) instead of O(n). The solid angles of nearby triangles are
+// computed exactly with the formula of Van Oosterom and Strackee.
+//
+// Jacobson, A., Kavan, L. and Sorkine-Hornung, O. (2013). Robust
+// inside-outside segmentation using generalized winding numbers. ACM
+// Transactions on Graphics, 32(4).
+//
+// Barill, G., Dickson, N., Schmidt, R., Levin, D. I. W. and Jacobson,
+// A. (2018). Fast winding numbers for soups and clouds. ACM
+// Transactions on Graphics, 37(4).
+
+#ifndef __vtkImplicitWindingNumber_h
+#define __vtkImplicitWindingNumber_h
+
+#include "vtkImplicitFunction.h"
+
+
+class vtkDataArray;
+class vtkPolyData;
+class vtkTriangleFilter;
+
+class vtkImplicitWindingNumber : public vtkImplicitFunction
+{
+public:
+  static vtkImplicitWindingNumber *New();
+  vtkTypeMacro(vtkImplicitWindingNumber,vtkImplicitFunction);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Return the MTime also considering the Input dependency.
+  unsigned long GetMTime();
+
+  // Description:
+  // Evaluate 0.5 minus the winding number at x[3]. Evaluation only
+  // reads the hierarchy, so it may be called from several threads at
+  // once.
+  double EvaluateFunction(double x[3]);
+
+  // Description:
+  // Evaluates the function at every tuple of the 3-component array
+  // input, transformed by Transform if there is one, and stores the
+  // values in the 1-component array output. The points are shared
+  // among NumberOfThreads threads.
+  virtual void FunctionValue(vtkDataArray *input, vtkDataArray *output);
+  double FunctionValue(const double x[3])
+    {return this->vtkImplicitFunction::FunctionValue(x);}
+
+  // Description:
+  // Evaluate the gradient of the function at x[3] by central
+  // differences.
+  void EvaluateGradient(double x[3], double g[3]);
+
+  // Description:
+  // Compute the generalized winding number of the input around x[3].
+  double GetWindingNumber(double x[3]);
+
+  // Description:
+  // Set the input vtkPolyData. Passes input through an internal
+  // instance of vtkTriangleFilter to remove vertices and lines and
+  // builds the cluster hierarchy over the resulting triangles.
+  void SetInput(vtkPolyData *input);
+
+  // Description:
+  // Set/get the Barnes-Hut acceptance ratio. A cluster is approximated
+  // by its dipole when the distance from x to the cluster center is
+  // larger than Beta times the cluster radius. Larger values are
+  // more accurate and slower. Defaults to 2.
+  vtkSetClampMacro(Beta, double, 1.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Beta, double);
+
+  // Description:
+  // Set/get the maximum number of triangles in a leaf of the
+  // hierarchy. Takes effect at the next SetInput(). Defaults to 8.
+  vtkSetClampMacro(NumberOfTrianglesPerLeaf, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfTrianglesPerLeaf, int);
+
+  // Description:
+  // Set/get the number of threads used by the batched FunctionValue().
+  // Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Set/get the function value to use if no input vtkPolyData
+  // specified.
+  vtkSetMacro(NoValue, double);
+  vtkGetMacro(NoValue, double);
+
+protected:
+  vtkImplicitWindingNumber();
+  ~vtkImplicitWindingNumber();
+
+  double NoValue;
+  double Beta;
+  int    NumberOfTrianglesPerLeaf;
+  int    NumberOfThreads;
+
+private:
+  vtkImplicitWindingNumber(const vtkImplicitWindingNumber&);  // Not implemented.
+  void operator=(const vtkImplicitWindingNumber&);  // Not implemented.
+
+  void BuildHierarchy();
+
+  vtkTriangleFilter *TriangleFilter;
+  vtkPolyData       *Input;
+
+  // Triangle clusters and the triangle coordinates they refer to.
+  class Hierarchy;
+  Hierarchy         *Tree;
+
+};
+
+#endif
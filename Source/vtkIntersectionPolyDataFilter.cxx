@@ -16,30 +16,153 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkConditionVariable.h"
 #include "vtkDelaunay2D.h"
 #include "vtkDoubleArray.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkLine.h"
+#include "vtkLinearTransform.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkOBBTree.h"
 #include "vtkPlane.h"
 #include "vtkPointData.h"
 #include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyDataLocatorCache.h"
 #include "vtkSmartPointer.h"
 #include "vtkSortDataArray.h"
 #include "vtkTransform.h"
 #include "vtkTriangle.h"
-
+#include "vtkUnsignedCharArray.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <map>
 #include <queue>
+#include <set>
+#include <vector>
 
 //----------------------------------------------------------------------------
 // Helper typedefs and data structure.
-typedef std::multimap< vtkIdType, vtkIdType >    IntersectionMapType;
-typedef IntersectionMapType::iterator            IntersectionMapIteratorType;
+
+// Map from a dense range of non-negative keys to lists of values,
+// stored in compressed-sparse-row form. Pairs are appended while the
+// intersection search runs and compacted once by Build(). The values
+// of each key keep the order in which they were appended.
+template <class T>
+class vtkIntersectionCSRMap
+{
+public:
+  void Append(vtkIdType key, const T &value)
+  {
+    this->PendingKeys.push_back(key);
+    this->PendingValues.push_back(value);
+  }
+
+  // Sorts the appended pairs by key with a stable counting sort.
+  void Build()
+  {
+    size_t numPairs = this->PendingKeys.size();
+    vtkIdType numKeys = 0;
+    for (size_t i = 0; i < numPairs; i++)
+      {
+      numKeys = std::max(numKeys, this->PendingKeys[i] + 1);
+      }
+
+    this->Offsets.assign(numKeys + 1, 0);
+    for (size_t i = 0; i < numPairs; i++)
+      {
+      this->Offsets[this->PendingKeys[i] + 1]++;
+      }
+    for (vtkIdType key = 0; key < numKeys; key++)
+      {
+      this->Offsets[key + 1] += this->Offsets[key];
+      }
+
+    std::vector<vtkIdType> next(this->Offsets.begin(), this->Offsets.end() - 1);
+    this->Values.resize(numPairs);
+    for (size_t i = 0; i < numPairs; i++)
+      {
+      this->Values[next[this->PendingKeys[i]]++] = this->PendingValues[i];
+      }
+
+    std::vector<vtkIdType>().swap(this->PendingKeys);
+    std::vector<T>().swap(this->PendingValues);
+  }
+
+  // Removes each value for which same(earlier, value) is true for an
+  // earlier value of the same key. Must be called after Build().
+  template <class Same>
+  void RemoveDuplicates(Same same)
+  {
+    if (this->Offsets.empty())
+      {
+      return;
+      }
+
+    vtkIdType numKeys = static_cast<vtkIdType>(this->Offsets.size()) - 1;
+    vtkIdType numKept = 0;
+    for (vtkIdType key = 0; key < numKeys; key++)
+      {
+      vtkIdType begin = this->Offsets[key];
+      vtkIdType end = this->Offsets[key + 1];
+      this->Offsets[key] = numKept;
+      for (vtkIdType i = begin; i < end; i++)
+        {
+        bool duplicate = false;
+        for (vtkIdType j = this->Offsets[key]; j < numKept && !duplicate; j++)
+          {
+          duplicate = same(this->Values[j], this->Values[i]);
+          }
+        if (!duplicate)
+          {
+          this->Values[numKept++] = this->Values[i];
+          }
+        }
+      }
+    this->Offsets[numKeys] = numKept;
+    this->Values.resize(numKept);
+  }
+
+  vtkIdType GetNumberOfValues(vtkIdType key) const
+  {
+    if (key < 0 || key + 1 >= static_cast<vtkIdType>(this->Offsets.size()))
+      {
+      return 0;
+      }
+    return this->Offsets[key + 1] - this->Offsets[key];
+  }
+
+  // Returns the values of key. Only valid if GetNumberOfValues(key)
+  // is non-zero.
+  const T *GetValues(vtkIdType key) const
+  {
+    return &this->Values[this->Offsets[key]];
+  }
+
+private:
+  std::vector<vtkIdType> PendingKeys;
+  std::vector<T>         PendingValues;
+  std::vector<vtkIdType> Offsets;
+  std::vector<T>         Values;
+};
+
+// Map from cell ID to the intersection lines that cross it.
+typedef vtkIntersectionCSRMap< vtkIdType >         IntersectionMapType;
 
 //typedef std::pair< vtkIdType, vtkIdType >            CellEdgePairType;
 typedef struct _CellEdgeLine {
@@ -48,8 +171,750 @@ typedef struct _CellEdgeLine {
   vtkIdType LineId;
 } CellEdgeLineType;
 
-typedef std::multimap< vtkIdType, CellEdgeLineType > PointEdgeMapType;
-typedef PointEdgeMapType::iterator                   PointEdgeMapIteratorType;
+// Map from intersection point ID to the cell edges it lies on.
+typedef vtkIntersectionCSRMap< CellEdgeLineType >  PointEdgeMapType;
+
+// Compares the cell IDs of two point-edge map entries.
+struct vtkCellEdgeLineSameCell
+{
+  bool operator()(const CellEdgeLineType &a, const CellEdgeLineType &b) const
+  {
+    return a.CellId == b.CellId;
+  }
+};
+
+// A segment found by the narrow phase that has not been merged into
+// the intersection lines yet.
+// Edge[i] is the edge on which endpoint i lies: 0 to 2 for edge
+// (j, j+1) of the first cell, 3 to 5 for edge (j-3, j-2) of the second
+// one, or -1 if the endpoint is on a vertex or on an edge of both.
+// Coplanar is non-zero for a segment on the boundary of the overlap of
+// two coplanar cells; bit e of EdgeMask[i][j] is then set if endpoint
+// i lies on edge e of cell j.
+typedef struct _IntersectionSegment {
+  vtkIdType     CellId[2];
+  double        Pt[2][3];
+  int           Edge[2];
+  unsigned char Coplanar;
+  unsigned char EdgeMask[2][2];
+} IntersectionSegmentType;
+
+typedef std::vector< IntersectionSegmentType > IntersectionSegmentVectorType;
+
+//----------------------------------------------------------------------------
+// Vertex of the overlap of two coplanar triangles. Bit e of Mask[j] is
+// set if the vertex lies on edge e of triangle j.
+typedef struct _CoplanarVertex {
+  double        X[3];
+  unsigned char Mask[2];
+} CoplanarVertexType;
+
+//----------------------------------------------------------------------------
+static inline double vtkCoplanarOrient2D(const double a[3], const double b[3],
+                                         const double c[3], int ax, int ay)
+{
+  return (b[ax] - a[ax]) * (c[ay] - a[ay]) - (b[ay] - a[ay]) * (c[ax] - a[ax]);
+}
+
+//----------------------------------------------------------------------------
+// Clips the coplanar triangles tri0 and tri1 against each other in
+// the coordinate plane closest to theirs and appends the boundary of
+// their overlap to segments. Each boundary segment lies on an edge of
+// one of the triangles; the edges its endpoints lie on are recorded
+// in IntersectionSegmentType::EdgeMask. Returns the number of
+// segments appended.
+static int vtkCoplanarTriangleOverlap(double *tri0[3], double *tri1[3],
+                                      vtkIdType cellId0, vtkIdType cellId1,
+                                      IntersectionSegmentVectorType &segments)
+{
+  double u[3], v[3], n[3];
+  for (int k = 0; k < 3; k++)
+    {
+    u[k] = tri0[1][k] - tri0[0][k];
+    v[k] = tri0[2][k] - tri0[0][k];
+    }
+  vtkMath::Cross(u, v, n);
+  int drop = 0;
+  for (int k = 1; k < 3; k++)
+    {
+    if (fabs(n[k]) > fabs(n[drop]))
+      {
+      drop = k;
+      }
+    }
+  int ax = (drop + 1) % 3, ay = (drop + 2) % 3;
+
+  double area1 = vtkCoplanarOrient2D(tri1[0], tri1[1], tri1[2], ax, ay);
+  if (area1 == 0.0 || n[drop] == 0.0)
+    {
+    return 0;
+    }
+  double orientation = area1 > 0.0 ? 1.0 : -1.0;
+
+  // Sutherland-Hodgman clipping of tri0 by the edges of tri1.
+  std::vector< CoplanarVertexType > polygon(3), clipped;
+  for (int k = 0; k < 3; k++)
+    {
+    std::copy(tri0[k], tri0[k] + 3, polygon[k].X);
+    polygon[k].Mask[0] = static_cast<unsigned char>((1 << k) |
+                                                    (1 << ((k + 2) % 3)));
+    polygon[k].Mask[1] = 0;
+    }
+
+  std::vector< double > sides;
+  for (int j = 0; j < 3 && polygon.size() >= 3; j++)
+    {
+    const double *a = tri1[j];
+    const double *b = tri1[(j + 1) % 3];
+    unsigned char bit = static_cast<unsigned char>(1 << j);
+    size_t numVertices = polygon.size();
+    sides.resize(numVertices);
+    for (size_t i = 0; i < numVertices; i++)
+      {
+      sides[i] = orientation * vtkCoplanarOrient2D(a, b, polygon[i].X, ax, ay);
+      }
+
+    clipped.clear();
+    for (size_t i = 0; i < numVertices; i++)
+      {
+      const CoplanarVertexType &current = polygon[i];
+      const CoplanarVertexType &next = polygon[(i + 1) % numVertices];
+      double sc = sides[i], sn = sides[(i + 1) % numVertices];
+      if (sc >= 0.0)
+        {
+        clipped.push_back(current);
+        if (sc == 0.0)
+          {
+          clipped.back().Mask[1] |= bit;
+          }
+        }
+      if ((sc > 0.0 && sn < 0.0) || (sc < 0.0 && sn > 0.0))
+        {
+        double t = sc / (sc - sn);
+        CoplanarVertexType crossing;
+        for (int k = 0; k < 3; k++)
+          {
+          crossing.X[k] = current.X[k] + t * (next.X[k] - current.X[k]);
+          }
+        crossing.Mask[0] = current.Mask[0] & next.Mask[0];
+        crossing.Mask[1] = (current.Mask[1] & next.Mask[1]) | bit;
+        clipped.push_back(crossing);
+        }
+      }
+    polygon.swap(clipped);
+    }
+
+  size_t numVertices = polygon.size();
+  double area = 0.0;
+  for (size_t i = 0; i < numVertices; i++)
+    {
+    const double *x0 = polygon[i].X;
+    const double *x1 = polygon[(i + 1) % numVertices].X;
+    area += x0[ax] * x1[ay] - x1[ax] * x0[ay];
+    }
+  if (numVertices < 3 || area == 0.0)
+    {
+    return 0;
+    }
+
+  int numSegments = 0;
+  for (size_t i = 0; i < numVertices; i++)
+    {
+    const CoplanarVertexType &v0 = polygon[i];
+    const CoplanarVertexType &v1 = polygon[(i + 1) % numVertices];
+    if (v0.X[0] == v1.X[0] && v0.X[1] == v1.X[1] && v0.X[2] == v1.X[2])
+      {
+      continue;
+      }
+
+    IntersectionSegmentType segment;
+    segment.CellId[0] = cellId0;
+    segment.CellId[1] = cellId1;
+    std::copy(v0.X, v0.X + 3, segment.Pt[0]);
+    std::copy(v1.X, v1.X + 3, segment.Pt[1]);
+    segment.Edge[0] = segment.Edge[1] = -1;
+    segment.Coplanar = 1;
+    for (int j = 0; j < 2; j++)
+      {
+      segment.EdgeMask[0][j] = v0.Mask[j];
+      segment.EdgeMask[1][j] = v1.Mask[j];
+      }
+    segments.push_back(segment);
+    numSegments++;
+    }
+
+  return numSegments;
+}
+
+// Position of a node pair in the tree-vs-tree recursion, stored as a
+// linked list of child indices from the root pair. Child indices are
+// assigned so that sorting paths lexicographically reproduces the
+// order in which vtkOBBTree::IntersectWithOBBTree visits leaf pairs.
+typedef struct _TraversalPath {
+  const struct _TraversalPath *Parent;
+  unsigned int                 Depth;
+  unsigned char                Digit;
+} TraversalPathType;
+
+typedef struct _NodePairTask {
+  vtkOBBNode              *Node[2];
+  const TraversalPathType *Path;
+} NodePairTaskType;
+
+// Range of segments in a thread's buffer produced by one leaf pair.
+typedef struct _SegmentChunk {
+  const TraversalPathType *Path;
+  size_t                   Begin;
+  size_t                   End;
+} SegmentChunkType;
+
+// Same as the TriangleTriangleIntersection() and
+// TriangleTriangleIntersectionBatch() members, but also store the
+// edge on which each endpoint lies in edges, as in
+// IntersectionSegmentType::Edge, if edges is not NULL. The batched
+// version stores two values per candidate.
+static int vtkTriangleTriangleIntersectionEdges(double p1[3], double q1[3],
+                                                double r1[3], double n1[3],
+                                                double s1, double p2[3],
+                                                double q2[3], double r2[3],
+                                                double n2[3], double s2,
+                                                int &coplanar, double pt1[3],
+                                                double pt2[3], int *edges);
+static int vtkTriangleTriangleIntersectionBatchEdges(double p1[3], double q1[3],
+                                                     double r1[3],
+                                                     double *plane1,
+                                                     int numCandidates,
+                                                     double *candidatePts,
+                                                     double *candidatePlanes,
+                                                     int *intersects,
+                                                     int *coplanar,
+                                                     double *pts1,
+                                                     double *pts2,
+                                                     int *edges);
+
+// Computes the supporting plane of the triangle (p, q, r) as the unit
+// normal plane[0..2] and the offset plane[3], with the same arithmetic
+// as the vector lanes of the batched test.
+static void vtkIntersectionTrianglePlane(const double p[3], const double q[3],
+                                         const double r[3], double plane[4]);
+static int vtkTriangleTriangleIntersectionExact(double p1[3], double q1[3],
+                                                double r1[3], double p2[3],
+                                                double q2[3], double r2[3],
+                                                int &coplanar, double pt1[3],
+                                                double pt2[3], int *edges);
+
+//----------------------------------------------------------------------------
+// Hashed grid used to weld the segment endpoints of the parallel
+// traversal. Points are binned by their coordinates quantized to the
+// tolerance, so that any two points closer than the tolerance fall in
+// the same or in neighboring bins, whatever the extent of the
+// surfaces. The bins are spread over several hash tables, each guarded
+// by its own lock, so that many threads may insert at once.
+//
+// Points are identified by their rank, the position at which the
+// serial traversal produces them. Once all points are inserted, a
+// point is welded to the point of smallest rank within the tolerance.
+// The result does not depend on the order of insertion and matches
+// the serial weld, which keeps the first point inserted, unless the
+// points within the tolerance of each other form chains.
+class vtkIntersectionPointWelder
+{
+public:
+  vtkIntersectionPointWelder(const double *points, vtkIdType numPoints,
+                             double tolerance, int numTables)
+    : Points(points), Next(numPoints, -1), Tables(numTables)
+  {
+    this->Tolerance2 = tolerance * tolerance;
+    this->BinSize = tolerance > 0.0 ? tolerance : VTK_DBL_EPSILON;
+    this->Locks = new vtkSimpleMutexLock[numTables];
+  }
+
+  ~vtkIntersectionPointWelder()
+  {
+    delete [] this->Locks;
+  }
+
+  // Adds a point. Safe to call from several threads at once.
+  void Insert(vtkIdType rank)
+  {
+    BinType bin;
+    this->GetBinKey(this->Points + 3*rank, 0, 0, 0, bin.Key);
+    size_t hash = this->Hash(bin.Key);
+    size_t tableId = hash % this->Tables.size();
+    TableType &table = this->Tables[tableId];
+
+    this->Locks[tableId].Lock();
+    if (2 * (table.NumberOfBins + 1) > table.Bins.size())
+      {
+      this->Grow(table);
+      }
+    BinType &slot = table.Bins[this->FindSlot(table, bin.Key, hash)];
+    if (slot.Head < 0)
+      {
+      slot = bin;
+      table.NumberOfBins++;
+      }
+    this->Next[rank] = slot.Head;
+    slot.Head = rank;
+    this->Locks[tableId].Unlock();
+  }
+
+  // Returns the rank of the point that the point of the given rank is
+  // welded to. Safe to call from several threads once all points are
+  // inserted.
+  vtkIdType FindRepresentative(vtkIdType rank) const
+  {
+    const double *x = this->Points + 3*rank;
+    vtkIdType best = rank;
+    for (int i = -1; i <= 1; i++)
+      {
+      for (int j = -1; j <= 1; j++)
+        {
+        for (int k = -1; k <= 1; k++)
+          {
+          long long key[3];
+          this->GetBinKey(x, i, j, k, key);
+          size_t hash = this->Hash(key);
+          const TableType &table = this->Tables[hash % this->Tables.size()];
+          if (table.Bins.empty())
+            {
+            continue;
+            }
+          const BinType &slot = table.Bins[this->FindSlot(table, key, hash)];
+          for (vtkIdType q = slot.Head; q >= 0; q = this->Next[q])
+            {
+            if (q < best &&
+                vtkMath::Distance2BetweenPoints(x, this->Points + 3*q) <=
+                this->Tolerance2)
+              {
+              best = q;
+              }
+            }
+          }
+        }
+      }
+    return best;
+  }
+
+private:
+  struct BinType
+  {
+    BinType() : Head(-1) {}
+    long long Key[3];
+    vtkIdType Head;
+  };
+
+  // Open addressing table with linear probing. Its size is a power of
+  // two.
+  struct TableType
+  {
+    TableType() : NumberOfBins(0) {}
+    std::vector< BinType > Bins;
+    size_t                 NumberOfBins;
+  };
+
+  void GetBinKey(const double x[3], int di, int dj, int dk,
+                 long long key[3]) const
+  {
+    key[0] = this->Quantize(x[0]) + di;
+    key[1] = this->Quantize(x[1]) + dj;
+    key[2] = this->Quantize(x[2]) + dk;
+  }
+
+  // Returns the bin index of a coordinate. Converting a double outside
+  // the range of long long is undefined, so coordinates far from the
+  // origin for the tolerance are clamped, and share the end bins. The
+  // bounds leave room for the neighbor offsets. NaN falls in the lower
+  // end bin.
+  long long Quantize(double x) const
+  {
+    const double limit = 4611686018427387904.0; // 2^62
+    double q = floor(x / this->BinSize);
+    if (!(q > -limit))
+      {
+      return -static_cast<long long>(limit);
+      }
+    if (q >= limit)
+      {
+      return static_cast<long long>(limit);
+      }
+    return static_cast<long long>(q);
+  }
+
+  size_t Hash(const long long key[3]) const
+  {
+    unsigned long long h = static_cast<unsigned long long>(key[0]) * 73856093ULL;
+    h ^= static_cast<unsigned long long>(key[1]) * 19349669ULL;
+    h ^= static_cast<unsigned long long>(key[2]) * 83492791ULL;
+    return static_cast<size_t>(h ^ (h >> 29));
+  }
+
+  // Returns the index of the bin of key, or of the empty slot where it
+  // would go.
+  size_t FindSlot(const TableType &table, const long long key[3],
+                  size_t hash) const
+  {
+    size_t mask = table.Bins.size() - 1;
+    size_t i = (hash / this->Tables.size()) & mask;
+    while (table.Bins[i].Head >= 0 &&
+           (table.Bins[i].Key[0] != key[0] ||
+            table.Bins[i].Key[1] != key[1] ||
+            table.Bins[i].Key[2] != key[2]))
+      {
+      i = (i + 1) & mask;
+      }
+    return i;
+  }
+
+  void Grow(TableType &table)
+  {
+    std::vector< BinType > bins(table.Bins.empty() ? 64 : 2*table.Bins.size());
+    bins.swap(table.Bins);
+    for (size_t i = 0; i < bins.size(); i++)
+      {
+      if (bins[i].Head >= 0)
+        {
+        size_t slot =
+          this->FindSlot(table, bins[i].Key, this->Hash(bins[i].Key));
+        table.Bins[slot] = bins[i];
+        }
+      }
+  }
+
+  const double             *Points;
+  double                    Tolerance2;
+  double                    BinSize;
+  std::vector< vtkIdType >  Next;
+  std::vector< TableType >  Tables;
+  vtkSimpleMutexLock       *Locks;
+};
+
+//----------------------------------------------------------------------------
+// Hash table from the mesh feature an intersection point lies on to
+// the id of the point. The feature is the edge (Point0, Point1) of a
+// cell of mesh Mesh crossing cell Cell of the other mesh.
+class vtkIntersectionFeatureMap
+{
+public:
+  vtkIntersectionFeatureMap() : NumberOfKeys(0) {}
+
+  // Returns the point id stored for the feature. If there is none
+  // yet, the feature is added with a negative point id, which the
+  // caller must set before the next call.
+  vtkIdType& InsertKey(int mesh, vtkIdType point0, vtkIdType point1,
+                       vtkIdType cell)
+  {
+    if (2 * (this->NumberOfKeys + 1) > this->Slots.size())
+      {
+      this->Grow();
+      }
+
+    SlotType key;
+    key.Mesh   = mesh;
+    key.Point0 = std::min(point0, point1);
+    key.Point1 = std::max(point0, point1);
+    key.Cell   = cell;
+    SlotType &slot = this->Slots[this->FindSlot(key)];
+    if (slot.PointId < 0)
+      {
+      slot = key;
+      this->NumberOfKeys++;
+      }
+    return slot.PointId;
+  }
+
+private:
+  struct SlotType
+  {
+    SlotType() : PointId(-1) {}
+    int       Mesh;
+    vtkIdType Point0;
+    vtkIdType Point1;
+    vtkIdType Cell;
+    vtkIdType PointId;
+  };
+
+  // Open addressing with linear probing. The number of slots is a
+  // power of two.
+  size_t FindSlot(const SlotType &key) const
+  {
+    unsigned long long h = static_cast<unsigned long long>(key.Point0);
+    h = h * 1000003ULL ^ static_cast<unsigned long long>(key.Point1);
+    h = h * 1000003ULL ^ static_cast<unsigned long long>(key.Cell);
+    h = h * 2ULL + static_cast<unsigned long long>(key.Mesh);
+    h ^= h >> 31;
+
+    size_t mask = this->Slots.size() - 1;
+    size_t i = static_cast<size_t>(h) & mask;
+    while (this->Slots[i].PointId >= 0 &&
+           (this->Slots[i].Mesh != key.Mesh ||
+            this->Slots[i].Point0 != key.Point0 ||
+            this->Slots[i].Point1 != key.Point1 ||
+            this->Slots[i].Cell != key.Cell))
+      {
+      i = (i + 1) & mask;
+      }
+    return i;
+  }
+
+  void Grow()
+  {
+    std::vector< SlotType > slots(this->Slots.empty() ? 1024 :
+                                  2*this->Slots.size());
+    slots.swap(this->Slots);
+    for (size_t i = 0; i < slots.size(); i++)
+      {
+      if (slots[i].PointId >= 0)
+        {
+        this->Slots[this->FindSlot(slots[i])] = slots[i];
+        }
+      }
+  }
+
+  std::vector< SlotType > Slots;
+  size_t                  NumberOfKeys;
+};
+
+
+//----------------------------------------------------------------------------
+// Flat byte buffer holding a locator snapshot. Values are stored in
+// native byte order; the snapshot header records it so that files
+// written on a different architecture are rejected.
+class vtkLocatorSnapshotBuffer
+{
+public:
+  vtkLocatorSnapshotBuffer() : Position(0) {}
+
+  template <class T> void Put(const T &value)
+  {
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    this->Bytes.insert(this->Bytes.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <class T> bool Get(T &value)
+  {
+    if ( this->Position + sizeof(T) > this->Bytes.size() )
+      {
+      return false;
+      }
+    memcpy(&value, &this->Bytes[this->Position], sizeof(T));
+    this->Position += sizeof(T);
+    return true;
+  }
+
+  // Number of bytes left to read.
+  size_t GetRemaining() const
+  {
+    return this->Bytes.size() - this->Position;
+  }
+
+  std::vector<char> Bytes;
+  size_t            Position;
+};
+
+
+//----------------------------------------------------------------------------
+// vtkOBBTree keeps its root node protected. The parallel traversal
+// needs the roots to seed its task queues, and snapshots need to
+// replace the tree without building it.
+class vtkIntersectionOBBTree : public vtkOBBTree
+{
+public:
+  static vtkIntersectionOBBTree *New();
+  vtkTypeMacro(vtkIntersectionOBBTree, vtkOBBTree);
+
+  vtkOBBNode *GetRoot() { return this->Tree; }
+
+  // Write the nodes in preorder. A node stores its corner and axes, a
+  // flag telling whether it has children, and its cell ids (-1 for
+  // no list).
+  void WriteNodes(vtkLocatorSnapshotBuffer &buffer)
+  {
+    buffer.Put(this->DeepestLevel);
+    this->WriteNode(this->Tree, buffer);
+  }
+
+  // Replace the tree by the nodes read from buffer. The data set must
+  // be set first; cell ids are checked against it. The stored depth
+  // sizes the node stacks of IntersectWithOBBTree(), so it must be that
+  // of the nodes actually read. On failure the tree is left empty.
+  bool ReadNodes(vtkLocatorSnapshotBuffer &buffer)
+  {
+    this->FreeSearchStructure();
+
+    int deepestLevel;
+    vtkOBBNode *root = new vtkOBBNode;
+    // Each split leaves cells on both sides, so a tree is never deeper
+    // than the number of cells.
+    vtkIdType numCells = this->DataSet->GetNumberOfCells();
+    if ( !buffer.Get(deepestLevel) || deepestLevel < 0 ||
+         deepestLevel > numCells ||
+         this->ReadNode(root, buffer, numCells, 0, deepestLevel) !=
+         deepestLevel )
+      {
+      this->DeleteTree(root);
+      delete root;
+      return false;
+      }
+
+    this->Tree = root;
+    this->DeepestLevel = deepestLevel;
+    this->Level = deepestLevel;
+    this->BuildTime.Modified();
+    return true;
+  }
+
+protected:
+  vtkIntersectionOBBTree() {}
+  ~vtkIntersectionOBBTree() {}
+
+  void WriteNode(vtkOBBNode *node, vtkLocatorSnapshotBuffer &buffer);
+  int ReadNode(vtkOBBNode *node, vtkLocatorSnapshotBuffer &buffer,
+               vtkIdType numCells, int level, int maxLevel);
+
+private:
+  vtkIntersectionOBBTree(const vtkIntersectionOBBTree&); // no implementation
+  void operator=(const vtkIntersectionOBBTree&);         // no implementation
+};
+
+vtkStandardNewMacro(vtkIntersectionOBBTree);
+
+//----------------------------------------------------------------------------
+void vtkIntersectionOBBTree::WriteNode(vtkOBBNode *node,
+                                       vtkLocatorSnapshotBuffer &buffer)
+{
+  for (int i = 0; i < 3; i++)
+    {
+    buffer.Put(node->Corner[i]);
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      buffer.Put(node->Axes[i][j]);
+      }
+    }
+
+  char hasKids = (node->Kids != NULL);
+  buffer.Put(hasKids);
+
+  vtkIdType numIds = (node->Cells ? node->Cells->GetNumberOfIds() : -1);
+  buffer.Put(numIds);
+  for (vtkIdType i = 0; i < numIds; i++)
+    {
+    buffer.Put(node->Cells->GetId(i));
+    }
+
+  if ( hasKids )
+    {
+    this->WriteNode(node->Kids[0], buffer);
+    this->WriteNode(node->Kids[1], buffer);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Reads the subtree of node at the given level and returns its
+// deepest level, or -1 if the buffer is corrupt or the subtree goes
+// deeper than maxLevel.
+int vtkIntersectionOBBTree::ReadNode(vtkOBBNode *node,
+                                     vtkLocatorSnapshotBuffer &buffer,
+                                     vtkIdType numCells, int level,
+                                     int maxLevel)
+{
+  for (int i = 0; i < 3; i++)
+    {
+    if ( !buffer.Get(node->Corner[i]) )
+      {
+      return -1;
+      }
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      if ( !buffer.Get(node->Axes[i][j]) )
+        {
+        return -1;
+        }
+      }
+    }
+
+  char hasKids;
+  vtkIdType numIds;
+  if ( !buffer.Get(hasKids) || !buffer.Get(numIds) || numIds < -1 ||
+       (hasKids && level >= maxLevel) )
+    {
+    return -1;
+    }
+
+  // Check the size against the data left before allocating the list,
+  // so that a corrupt count cannot request a huge allocation.
+  if ( numIds > numCells ||
+       (numIds > 0 && static_cast<size_t>(numIds) >
+        buffer.GetRemaining() / sizeof(vtkIdType)) )
+    {
+    return -1;
+    }
+
+  if ( numIds >= 0 )
+    {
+    node->Cells = vtkIdList::New();
+    node->Cells->SetNumberOfIds(numIds);
+    for (vtkIdType i = 0; i < numIds; i++)
+      {
+      vtkIdType cellId;
+      if ( !buffer.Get(cellId) || cellId < 0 || cellId >= numCells )
+        {
+        return -1;
+        }
+      node->Cells->SetId(i, cellId);
+      }
+    }
+
+  if ( hasKids )
+    {
+    // Link the children before reading them so that DeleteTree()
+    // releases them if the read fails half way.
+    node->Kids = new vtkOBBNode *[2];
+    node->Kids[0] = new vtkOBBNode;
+    node->Kids[1] = new vtkOBBNode;
+    node->Kids[0]->Parent = node;
+    node->Kids[1]->Parent = node;
+    int deepest0 = this->ReadNode(node->Kids[0], buffer, numCells,
+                                  level + 1, maxLevel);
+    if ( deepest0 < 0 )
+      {
+      return -1;
+      }
+    int deepest1 = this->ReadNode(node->Kids[1], buffer, numCells,
+                                  level + 1, maxLevel);
+    if ( deepest1 < 0 )
+      {
+      return -1;
+      }
+    return (deepest0 > deepest1 ? deepest0 : deepest1);
+    }
+
+  return level;
+}
+
+
+//----------------------------------------------------------------------------
+// Working mesh and OBB tree of one input, kept between executions when
+// CacheInputs is on.
+class vtkIntersectionPolyDataFilter::InputCache
+{
+public:
+  InputCache() : Input(NULL), MTime(0), HasLinks(false) {}
+
+  // The input the mesh was built from and its MTime at that point.
+  vtkPolyData                               *Input;
+  unsigned long                              MTime;
+  bool                                       HasLinks;
+
+  vtkSmartPointer< vtkPolyData >             Mesh;
+  vtkSmartPointer< vtkIntersectionOBBTree >  Tree;
+};
 
 
 //----------------------------------------------------------------------------
@@ -64,6 +929,66 @@ public:
   static int FindTriangleIntersections(vtkOBBNode *node0, vtkOBBNode *node1,
                                        vtkMatrix4x4 *transform, void *arg);
 
+  // Description:
+  // Computes the intersection segments between the triangles of two
+  // leaf nodes and appends them to segments. Only reads the meshes,
+  // so it may be called from several threads at once. The node
+  // bounds are compared using InverseTransform. Triangle vertices and
+  // planes are read from the arrays filled in by PrecomputeTriangles()
+  // if there are any.
+  int IntersectLeafNodes(vtkOBBNode *node0, vtkOBBNode *node1,
+                         IntersectionSegmentVectorType &segments);
+
+  // Description:
+  // Same as IntersectLeafNodes(), but tests the triangles with exact
+  // orientation predicates.
+  int IntersectLeafNodesExact(vtkOBBNode *node0, vtkOBBNode *node1,
+                              IntersectionSegmentVectorType &segments);
+
+  // Description:
+  // Stores the vertex coordinates and supporting plane of every
+  // triangle of Mesh[index] in TrianglePoints[index] and
+  // TrianglePlanes[index].
+  void PrecomputeTriangles(int index);
+
+  // Description:
+  // Adds a segment to the intersection lines and updates the
+  // intersection maps.
+  void AddIntersectionSegment(const IntersectionSegmentType &segment);
+
+  // Description:
+  // Same as AddIntersectionSegment(), but with endpoints that were
+  // already welded into the points ptId0 and ptId1.
+  void AddWeldedSegment(const IntersectionSegmentType &segment,
+                        vtkIdType ptId0, vtkIdType ptId1);
+
+  // Description:
+  // Adds a segment on the boundary of the overlap of two coplanar
+  // cells. The segment is only mapped to the cells it crosses, not to
+  // those on whose edges it lies.
+  void AddCoplanarSegment(const IntersectionSegmentType &segment,
+                          vtkIdType ptId0, vtkIdType ptId1);
+
+  // Description:
+  // Adds the segment from point ptId0 to point ptId1 of
+  // IntersectionPoints, which lies in cell cellId of Mesh[0], to the
+  // maps of Mesh[0] only. A segment along an edge of the cell does not
+  // split it. Used by SplitAlongLines().
+  void AddMeshSegment(vtkIdType cellId, vtkIdType ptId0, vtkIdType ptId1);
+
+  // Description:
+  // Traverses the two OBB trees with numThreads threads. Leaf pairs
+  // are intersected concurrently and their segments are merged in the
+  // order the serial traversal would have produced them.
+  int IntersectTreesInParallel(vtkIntersectionOBBTree *obbTree0,
+                               vtkIntersectionOBBTree *obbTree1,
+                               int numThreads);
+
+  // Description:
+  // Compacts the intersection and point-edge maps once all segments
+  // have been added. Must be called before SplitMesh().
+  void BuildIntersectionMaps();
+
   int SplitMesh(int inputIndex, vtkPolyData *output,
                 vtkPolyData *intersectionLines);
 
@@ -73,7 +998,37 @@ protected:
                           vtkIdType *cellPts, IntersectionMapType *map,
                           vtkPolyData *interLines);
 
-  void AddToPointEdgeMap(int index, vtkIdType ptId, double x[3],
+  // Description:
+  // Splits a cell with vtkSmallPolygonTriangulator. Returns NULL if the
+  // cell has too many points or the triangulation fails.
+  vtkCellArray* SplitSmallCell(vtkPolyData *input, vtkIdType cellId,
+                               vtkIdType *cellPts, IntersectionMapType *map,
+                               vtkPolyData *interLines);
+
+  // Description:
+  // Splits a cell with vtkDelaunay2D. Not thread safe; SplitCell()
+  // calls it with DelaunayLock held.
+  vtkCellArray* SplitCellWithDelaunay(vtkPolyData *input, vtkIdType cellId,
+                                      vtkIdType *cellPts,
+                                      IntersectionMapType *map,
+                                      vtkPolyData *interLines);
+
+  // Description:
+  // Splits a cell with SplitCell() and flips the sub-cells whose
+  // orientation differs from the cell's. Safe to call from several
+  // threads at once.
+  vtkCellArray* SplitAndOrientCell(vtkPolyData *input, vtkPoints *points,
+                                   vtkIdType cellId, vtkIdType *pts,
+                                   IntersectionMapType *map,
+                                   vtkPolyData *interLines);
+
+  class SplitCellsType;
+  static VTK_THREAD_RETURN_TYPE SplitCellsThread(void *arg);
+
+  // Description:
+  // Records that point ptId lies on edge edgeId of cell cellId if its
+  // coordinates x are on that edge. Returns whether they are.
+  bool AddToPointEdgeMap(int index, vtkIdType ptId, double x[3],
                          vtkPolyData *mesh, vtkIdType cellId,
                          vtkIdType edgeId, vtkIdType lineId,
                          vtkIdType triPts[3]);
@@ -81,10 +1036,36 @@ protected:
   void SplitIntersectionLines(int inputIndex, vtkPolyData *sourceMesh,
                               vtkPolyData *splitLines);
 
+  class TraversalThreadState;
+  class Traversal;
+  static VTK_THREAD_RETURN_TYPE TraverseTreesThread(void *arg);
+
+  class WeldPointsType;
+  static VTK_THREAD_RETURN_TYPE WeldPointsThread(void *arg);
+
 public:
   vtkPolyData         *Mesh[2];
+  vtkOBBTree          *OBBTree0;
   vtkOBBTree          *OBBTree1;
 
+  // Transform from the frame of OBBTree1 to that of OBBTree0 and its
+  // inverse. NULL if the trees share a frame.
+  vtkMatrix4x4        *Transform;
+  vtkMatrix4x4        *InverseTransform;
+
+  // Number of threads used to split the meshes.
+  int                  NumberOfThreads;
+
+  // Serializes the vtkDelaunay2D fallback of SplitCell() when cells
+  // are split by several threads.
+  vtkSimpleMutexLock   DelaunayLock;
+
+  // Per-cell triangle vertex coordinates (9 values per cell) and
+  // supporting planes (normal and offset, 4 values per cell). Empty
+  // unless PrecomputeTriangles() was called.
+  std::vector<double>  TrianglePoints[2];
+  std::vector<double>  TrianglePlanes[2];
+
   // Stores the intersection lines.
   vtkCellArray        *IntersectionLines;
 
@@ -102,9 +1083,40 @@ public:
   // soup" to connected polylines.
   vtkPointLocator     *PointMerger;
 
+  // Points of the intersection lines and the distance below which
+  // segment endpoints are merged. Used by the parallel traversal in
+  // place of PointMerger.
+  vtkPoints           *IntersectionPoints;
+  double               MergeTolerance;
+
+  // If non-zero, segment endpoints are merged by the mesh features
+  // they lie on, looked up in FeatureMap.
+  int                  TopologicalChaining;
+  vtkIntersectionFeatureMap FeatureMap;
+
+  // If non-zero, the triangles are tested with exact predicates and
+  // the edges found by the narrow phase go into PointEdgeMap.
+  int                  ExactPredicates;
+
+  // If non-zero, the boundaries of the overlaps of coplanar triangles
+  // are added to the intersection lines.
+  int                  IntersectCoplanarTriangles;
+
+  // The neighbors of a cell find the segments along its edges again,
+  // both as boundaries of coplanar overlaps and as crossings with the
+  // cells next to a coplanar overlap. LinesAlongEdges[i] holds the
+  // cell of mesh i such a segment splits and its point ids, so that it
+  // is added only once whichever way it is found.
+  std::set< std::pair< vtkIdType, std::pair< vtkIdType, vtkIdType > > >
+                       LinesAlongEdges[2];
+
   // Map from cell ID to intersection line.
   IntersectionMapType *IntersectionMap[2];
 
+  // ID of the first point of each split output that lies on the
+  // intersection lines. Set by SplitMesh().
+  vtkIdType            FirstSplitPointId[2];
+
   // Map from point to an edge on which it resides, the ID of the
   // cell, and the ID of the line.
   PointEdgeMapType    *PointEdgeMap[2];
@@ -117,12 +1129,16 @@ protected:
 
 //----------------------------------------------------------------------------
 vtkIntersectionPolyDataFilter::Impl::Impl() :
-  OBBTree1(0), IntersectionLines(0), PointMerger(0)
+  OBBTree0(0), OBBTree1(0), Transform(0), InverseTransform(0),
+  NumberOfThreads(1), IntersectionLines(0), PointMerger(0),
+  IntersectionPoints(0), MergeTolerance(0.0), TopologicalChaining(0),
+  ExactPredicates(0), IntersectCoplanarTriangles(0)
 {
   for (int i = 0; i < 2; i++)
     {
     this->Mesh[i]            = NULL;
     this->CellIds[i]         = NULL;
+    this->FirstSplitPointId[i] = 0;
     this->IntersectionMap[i] = new IntersectionMapType();
     this->PointEdgeMap[i]    = new PointEdgeMapType();
     }
@@ -142,312 +1158,2112 @@ vtkIntersectionPolyDataFilter::Impl::~Impl()
 //----------------------------------------------------------------------------
 int vtkIntersectionPolyDataFilter::Impl
 ::FindTriangleIntersections(vtkOBBNode *node0, vtkOBBNode *node1,
-                            vtkMatrix4x4 *transform, void *arg)
+                            vtkMatrix4x4 *vtkNotUsed(transform), void *arg)
 {
   vtkIntersectionPolyDataFilter::Impl *info =
     reinterpret_cast<vtkIntersectionPolyDataFilter::Impl*>(arg);
 
-  vtkPolyData     *mesh0                = info->Mesh[0];
-  vtkPolyData     *mesh1                = info->Mesh[1];
-  vtkOBBTree      *obbTree1             = info->OBBTree1;
-  vtkCellArray    *intersectionLines    = info->IntersectionLines;
-  vtkIdTypeArray  *intersectionCellIds0 = info->CellIds[0];
-  vtkIdTypeArray  *intersectionCellIds1 = info->CellIds[1];
-  vtkPointLocator *pointMerger          = info->PointMerger;
+  IntersectionSegmentVectorType segments;
+  int retval = info->IntersectLeafNodes(node0, node1, segments);
+
+  for (size_t i = 0; i < segments.size(); i++)
+    {
+    info->AddIntersectionSegment(segments[i]);
+    }
+
+  return retval;
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::Impl
+::IntersectLeafNodes(vtkOBBNode *node0, vtkOBBNode *node1,
+                     IntersectionSegmentVectorType &segments)
+{
+  if ( this->ExactPredicates )
+    {
+    return this->IntersectLeafNodesExact(node0, node1, segments);
+    }
+
+  vtkPolyData     *mesh0                = this->Mesh[0];
+  vtkPolyData     *mesh1                = this->Mesh[1];
+  vtkOBBTree      *obbTree1             = this->OBBTree1;
+
+  bool precomputed =
+    !this->TrianglePlanes[0].empty() && !this->TrianglePlanes[1].empty();
+  double *points0 = precomputed ? &this->TrianglePoints[0][0] : NULL;
+  double *points1 = precomputed ? &this->TrianglePoints[1][0] : NULL;
+  double *planes0 = precomputed ? &this->TrianglePlanes[0][0] : NULL;
+  double *planes1 = precomputed ? &this->TrianglePlanes[1][0] : NULL;
 
   int numCells0 = node0->Cells->GetNumberOfIds();
+  int numCells1 = node1->Cells->GetNumberOfIds();
   int retval = 0;
 
-  for (vtkIdType id0 = 0; id0 < numCells0; id0++)
+  // Gather the triangles of the second node once, in the
+  // structure-of-arrays layout expected by
+  // TriangleTriangleIntersectionBatch().
+  std::vector<vtkIdType> cellIds1;
+  cellIds1.reserve(numCells1);
+  for (vtkIdType id1 = 0; id1 < numCells1; id1++)
     {
-    vtkIdType cellId0 = node0->Cells->GetId(id0);
-    int type0 = mesh0->GetCellType(cellId0);
-    vtkCell *cell0 = mesh0->GetCell(cellId0);
-
-    if (type0 == VTK_TRIANGLE)
+    vtkIdType cellId1 = node1->Cells->GetId(id1);
+    if (mesh1->GetCellType(cellId1) == VTK_TRIANGLE)
       {
-      vtkIdType npts0, *triPtIds0;
-      mesh0->GetCellPoints(cellId0, npts0, triPtIds0);
-      double triPts0[3][3];
-      for (vtkIdType id = 0; id < npts0; id++)
+      cellIds1.push_back(cellId1);
+      }
+    }
+
+  int numCandidates = static_cast<int>(cellIds1.size());
+  if (numCandidates == 0)
+    {
+    return 0;
+    }
+
+  std::vector<double> candidatePts(9*numCandidates);
+  std::vector<double> candidatePlanes(precomputed ? 4*numCandidates : 0);
+  for (int i = 0; i < numCandidates; i++)
+    {
+    if (precomputed)
+      {
+      const double *tri = points1 + 9*cellIds1[i];
+      const double *plane = planes1 + 4*cellIds1[i];
+      for (int k = 0; k < 9; k++)
+        {
+        candidatePts[k*numCandidates + i] = tri[k];
+        }
+      for (int k = 0; k < 4; k++)
+        {
+        candidatePlanes[k*numCandidates + i] = plane[k];
+        }
+      continue;
+      }
+
+    vtkIdType npts1, *triPtIds1;
+    mesh1->GetCellPoints(cellIds1[i], npts1, triPtIds1);
+    for (int j = 0; j < 3; j++)
+      {
+      double pt[3];
+      mesh1->GetPoint(triPtIds1[j], pt);
+      for (int k = 0; k < 3; k++)
+        {
+        candidatePts[(3*j + k)*numCandidates + i] = pt[k];
+        }
+      }
+    }
+
+  std::vector<int> intersects(numCandidates);
+  std::vector<int> coplanar(numCandidates);
+  std::vector<double> pts1(3*numCandidates);
+  std::vector<double> pts2(3*numCandidates);
+  std::vector<int> edges(2*numCandidates);
+
+  for (vtkIdType id0 = 0; id0 < numCells0; id0++)
+    {
+    vtkIdType cellId0 = node0->Cells->GetId(id0);
+    int type0 = mesh0->GetCellType(cellId0);
+
+    if (type0 == VTK_TRIANGLE)
+      {
+      double triPts0[3][3];
+      double *plane0 = NULL;
+      if (precomputed)
+        {
+        std::copy(points0 + 9*cellId0, points0 + 9*cellId0 + 9, triPts0[0]);
+        plane0 = planes0 + 4*cellId0;
+        }
+      else
+        {
+        vtkIdType npts0, *triPtIds0;
+        mesh0->GetCellPoints(cellId0, npts0, triPtIds0);
+        for (vtkIdType id = 0; id < npts0; id++)
+          {
+          mesh0->GetPoint(triPtIds0[id], triPts0[id]);
+          }
+        }
+
+      // The triangle is in the frame of the first tree.
+      if (!obbTree1->TriangleIntersectsNode
+          (node1, triPts0[0], triPts0[1], triPts0[2],
+           this->InverseTransform))
+        {
+        continue;
+        }
+
+      // See which of the cells actually intersect. Record an
+      // intersection segment for each one that does.
+      if (vtkTriangleTriangleIntersectionBatchEdges
+          (triPts0[0], triPts0[1], triPts0[2], plane0, numCandidates,
+           &candidatePts[0], precomputed ? &candidatePlanes[0] : NULL,
+           &intersects[0], &coplanar[0], &pts1[0], &pts2[0],
+           &edges[0]) == 0)
         {
-        mesh0->GetPoint(triPtIds0[id], triPts0[id]);
+        continue;
         }
-      vtkCell *cell0 = mesh0->GetCell(cellId0);
 
-      if (obbTree1->TriangleIntersectsNode
-          (node1, triPts0[0], triPts0[1], triPts0[2], transform))
+      for (int i = 0; i < numCandidates; i++)
         {
-        int numCells1 = node1->Cells->GetNumberOfIds();
-        for (vtkIdType id1 = 0; id1 < numCells1; id1++)
+        if (coplanar[i] && this->IntersectCoplanarTriangles)
           {
-          vtkIdType cellId1 = node1->Cells->GetId(id1);
-          int type1 = mesh1->GetCellType(cellId1);
-          if (type1 == VTK_TRIANGLE)
+          double tri1[3][3];
+          for (int j = 0; j < 3; j++)
             {
-            // See if the two cells actually intersect. If they do,
-            // add an entry into the intersection maps and add an
-            // intersection line.
-            vtkIdType npts1, *triPtIds1;
-            mesh1->GetCellPoints(cellId1, npts1, triPtIds1);
-            vtkCell *cell1 = mesh1->GetCell(cellId1);
-
-            double triPts1[3][3];
-            for (vtkIdType id = 0; id < npts1; id++)
+            for (int k = 0; k < 3; k++)
               {
-              mesh1->GetPoint(triPtIds1[id], triPts1[id]);
+              tri1[j][k] = candidatePts[(3*j + k)*numCandidates + i];
               }
+            }
+          double *t0[3] = {triPts0[0], triPts0[1], triPts0[2]};
+          double *t1[3] = {tri1[0], tri1[1], tri1[2]};
+          retval += vtkCoplanarTriangleOverlap(t0, t1, cellId0, cellIds1[i],
+                                               segments);
+          continue;
+          }
+
+        // Coplanar triangle intersection is not handled otherwise.
+        // This intersection will not be included in the output.
+        if (coplanar[i] || !intersects[i])
+          {
+          continue;
+          }
+
+        double *pt1 = &pts1[3*i];
+        double *pt2 = &pts2[3*i];
+        if ( pt1[0] != pt2[0] || pt1[1] != pt2[1] || pt1[2] != pt2[2] )
+          {
+          IntersectionSegmentType segment;
+          segment.Coplanar  = 0;
+          segment.CellId[0] = cellId0;
+          segment.CellId[1] = cellIds1[i];
+          for (int k = 0; k < 3; k++)
+            {
+            segment.Pt[0][k] = pt1[k];
+            segment.Pt[1][k] = pt2[k];
+            }
+          segment.Edge[0] = edges[2*i];
+          segment.Edge[1] = edges[2*i + 1];
+          segments.push_back(segment);
+          retval++;
+          }
+        }
+      }
+    }
+
+    return retval;
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::Impl
+::IntersectLeafNodesExact(vtkOBBNode *node0, vtkOBBNode *node1,
+                          IntersectionSegmentVectorType &segments)
+{
+  vtkPolyData     *mesh0                = this->Mesh[0];
+  vtkPolyData     *mesh1                = this->Mesh[1];
+  vtkOBBTree      *obbTree1             = this->OBBTree1;
+
+  int numCells0 = node0->Cells->GetNumberOfIds();
+  int numCells1 = node1->Cells->GetNumberOfIds();
+  int retval = 0;
+
+  for (vtkIdType id0 = 0; id0 < numCells0; id0++)
+    {
+    vtkIdType cellId0 = node0->Cells->GetId(id0);
+    if (mesh0->GetCellType(cellId0) != VTK_TRIANGLE)
+      {
+      continue;
+      }
+
+    vtkIdType npts0, *triPtIds0;
+    mesh0->GetCellPoints(cellId0, npts0, triPtIds0);
+    double tri0[3][3];
+    for (vtkIdType id = 0; id < 3; id++)
+      {
+      mesh0->GetPoint(triPtIds0[id], tri0[id]);
+      }
+    if (!obbTree1->TriangleIntersectsNode
+        (node1, tri0[0], tri0[1], tri0[2], this->InverseTransform))
+      {
+      continue;
+      }
+
+    for (vtkIdType id1 = 0; id1 < numCells1; id1++)
+      {
+      vtkIdType cellId1 = node1->Cells->GetId(id1);
+      if (mesh1->GetCellType(cellId1) != VTK_TRIANGLE)
+        {
+        continue;
+        }
+
+      vtkIdType npts1, *triPtIds1;
+      mesh1->GetCellPoints(cellId1, npts1, triPtIds1);
+      double tri1[3][3];
+      for (vtkIdType id = 0; id < 3; id++)
+        {
+        mesh1->GetPoint(triPtIds1[id], tri1[id]);
+        }
+
+      int coplanar = 0;
+      IntersectionSegmentType segment;
+      int intersects = vtkTriangleTriangleIntersectionExact
+        (tri0[0], tri0[1], tri0[2], tri1[0], tri1[1], tri1[2],
+         coplanar, segment.Pt[0], segment.Pt[1], segment.Edge);
+
+      // Coplanar triangle intersection is not handled unless
+      // IntersectCoplanarTriangles is on.
+      if ( coplanar )
+        {
+        if ( this->IntersectCoplanarTriangles )
+          {
+          double *t0[3] = {tri0[0], tri0[1], tri0[2]};
+          double *t1[3] = {tri1[0], tri1[1], tri1[2]};
+          retval += vtkCoplanarTriangleOverlap(t0, t1, cellId0, cellId1,
+                                               segments);
+          }
+        continue;
+        }
+
+      if ( intersects &&
+           ( segment.Pt[0][0] != segment.Pt[1][0] ||
+             segment.Pt[0][1] != segment.Pt[1][1] ||
+             segment.Pt[0][2] != segment.Pt[1][2] ) )
+        {
+        segment.Coplanar  = 0;
+        segment.CellId[0] = cellId0;
+        segment.CellId[1] = cellId1;
+        segments.push_back(segment);
+        retval++;
+        }
+      }
+    }
+
+  return retval;
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl::PrecomputeTriangles(int index)
+{
+  vtkPolyData *mesh = this->Mesh[index];
+  vtkIdType numCells = mesh->GetNumberOfCells();
+
+  std::vector<double> &points = this->TrianglePoints[index];
+  std::vector<double> &planes = this->TrianglePlanes[index];
+  points.assign(9*numCells, 0.0);
+  planes.assign(4*numCells, 0.0);
+
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    if (mesh->GetCellType(cellId) != VTK_TRIANGLE)
+      {
+      continue;
+      }
+
+    vtkIdType npts, *triPtIds;
+    mesh->GetCellPoints(cellId, npts, triPtIds);
+    double *tri = &points[9*cellId];
+    for (vtkIdType id = 0; id < 3; id++)
+      {
+      mesh->GetPoint(triPtIds[id], tri + 3*id);
+      }
+
+    // Same computation as in TriangleTriangleIntersection() so the
+    // results do not depend on whether the planes were precomputed.
+    vtkIntersectionTrianglePlane(tri, tri + 3, tri + 6, &planes[4*cellId]);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl
+::AddIntersectionSegment(const IntersectionSegmentType &segment)
+{
+  vtkIdType ptIds[2];
+  for (int i = 0; i < 2; i++)
+    {
+    int edge = segment.Edge[i];
+    if (!this->TopologicalChaining || edge < 0)
+      {
+      this->PointMerger->InsertUniquePoint(segment.Pt[i], ptIds[i]);
+      continue;
+      }
+
+    // The endpoint is where an edge of a cell of one mesh crosses the
+    // cell of the other mesh. The neighbor of the cell across that
+    // edge finds the same feature.
+    int mesh = edge < 3 ? 0 : 1;
+    vtkIdType npts, *pts;
+    this->Mesh[mesh]->GetCellPoints(segment.CellId[mesh], npts, pts);
+    vtkIdType &featurePtId =
+      this->FeatureMap.InsertKey(mesh, pts[edge % 3], pts[(edge + 1) % 3],
+                                 segment.CellId[1 - mesh]);
+    if (featurePtId < 0)
+      {
+      // The first endpoint on a feature goes through the locator, so
+      // that it is merged with an endpoint merged by distance or lying
+      // on another feature at the same place, such as a vertex of the
+      // other mesh, and so that the later ones can find it.
+      this->PointMerger->InsertUniquePoint(segment.Pt[i], featurePtId);
+      }
+    ptIds[i] = featurePtId;
+    }
+
+  this->AddWeldedSegment(segment, ptIds[0], ptIds[1]);
+}
+
+//----------------------------------------------------------------------------
+// Returns whether the segment (x0, x1) lies on an edge of the triangle
+// with points triPtIds of mesh, using the same test as
+// AddToPointEdgeMap().
+static bool vtkIntersectionSegmentAlongEdge(vtkPolyData *mesh,
+                                            const vtkIdType triPtIds[3],
+                                            double x0[3], double x1[3])
+{
+  for (int edgeId = 0; edgeId < 3; edgeId++)
+    {
+    double pt0[3], pt1[3], t, closestPt[3];
+    mesh->GetPoint(triPtIds[edgeId], pt0);
+    mesh->GetPoint(triPtIds[(edgeId + 1) % 3], pt1);
+    double dist0 = vtkLine::DistanceToLine(x0, pt0, pt1, t, closestPt);
+    if ( fabs(dist0) >= 1e-9 || t < 0.0 || t > 1.0 )
+      {
+      continue;
+      }
+    double dist1 = vtkLine::DistanceToLine(x1, pt0, pt1, t, closestPt);
+    if ( fabs(dist1) < 1e-9 && t >= 0.0 && t <= 1.0 )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl
+::AddWeldedSegment(const IntersectionSegmentType &segment,
+                   vtkIdType ptId0, vtkIdType ptId1)
+{
+  if ( segment.Coplanar )
+    {
+    this->AddCoplanarSegment(segment, ptId0, ptId1);
+    return;
+    }
+
+  vtkIdType cellId0 = segment.CellId[0];
+  vtkIdType cellId1 = segment.CellId[1];
+  double outpt0[3] = {segment.Pt[0][0], segment.Pt[0][1], segment.Pt[0][2]};
+  double outpt1[3] = {segment.Pt[1][0], segment.Pt[1][1], segment.Pt[1][2]};
+
+  vtkIdType npts0, *triPtIds0, npts1, *triPtIds1;
+  this->Mesh[0]->GetCellPoints(cellId0, npts0, triPtIds0);
+  this->Mesh[1]->GetCellPoints(cellId1, npts1, triPtIds1);
+
+  // A segment along an edge of one cell only is also found by the cell
+  // across that edge, which may be coplanar with the other cell. Only
+  // coplanar pairs add such segments a second time, so the default
+  // path skips the check.
+  if ( this->IntersectCoplanarTriangles )
+    {
+    bool along0 = vtkIntersectionSegmentAlongEdge(this->Mesh[0], triPtIds0,
+                                                  outpt0, outpt1);
+    bool along1 = vtkIntersectionSegmentAlongEdge(this->Mesh[1], triPtIds1,
+                                                  outpt0, outpt1);
+    if ( along0 != along1 )
+      {
+      int index = along0 ? 1 : 0;
+      std::pair< vtkIdType, std::pair< vtkIdType, vtkIdType > > key;
+      key.first = segment.CellId[index];
+      key.second.first = std::min(ptId0, ptId1);
+      key.second.second = std::max(ptId0, ptId1);
+      if ( !this->LinesAlongEdges[index].insert(key).second )
+        {
+        return;
+        }
+      }
+    }
+
+  vtkIdType lineId = this->IntersectionLines->GetNumberOfCells();
+  this->IntersectionLines->InsertNextCell(2);
+  this->IntersectionLines->InsertCellPoint(ptId0);
+  this->IntersectionLines->InsertCellPoint(ptId1);
+
+  this->CellIds[0]->InsertNextValue(cellId0);
+  this->CellIds[1]->InsertNextValue(cellId1);
+
+  this->PointCellIds[0]->InsertValue( ptId0, cellId0 );
+  this->PointCellIds[0]->InsertValue( ptId1, cellId0 );
+  this->PointCellIds[1]->InsertValue( ptId0, cellId1 );
+  this->PointCellIds[1]->InsertValue( ptId1, cellId1 );
+
+  this->IntersectionMap[0]->Append(cellId0, lineId);
+  this->IntersectionMap[1]->Append(cellId1, lineId);
+
+  if ( this->ExactPredicates )
+    {
+    // The narrow phase found the edge each endpoint lies on. Only the
+    // endpoints on a vertex are looked up by distance.
+    vtkIdType ptIds[2] = {ptId0, ptId1};
+    double *outpts[2] = {outpt0, outpt1};
+    for (int i = 0; i < 2; i++)
+      {
+      int edge = segment.Edge[i];
+      if ( edge >= 0 )
+        {
+        int index = edge < 3 ? 0 : 1;
+        CellEdgeLineType cellEdgeLine;
+        cellEdgeLine.CellId = segment.CellId[index];
+        cellEdgeLine.EdgeId = edge % 3;
+        cellEdgeLine.LineId = lineId;
+        this->PointEdgeMap[index]->Append(ptIds[i], cellEdgeLine);
+        continue;
+        }
+      for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+        {
+        this->AddToPointEdgeMap(0, ptIds[i], outpts[i], this->Mesh[0],
+                                cellId0, edgeId, lineId, triPtIds0);
+        this->AddToPointEdgeMap(1, ptIds[i], outpts[i], this->Mesh[1],
+                                cellId1, edgeId, lineId, triPtIds1);
+        }
+      }
+    return;
+    }
+
+  // Check which edges of cellId0 and cellId1 outpt0 and outpt1 are
+  // on, if any.
+  for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+    {
+    this->AddToPointEdgeMap(0, ptId0, outpt0, this->Mesh[0], cellId0,
+                            edgeId, lineId, triPtIds0);
+    this->AddToPointEdgeMap(0, ptId1, outpt1, this->Mesh[0], cellId0,
+                            edgeId, lineId, triPtIds0);
+    this->AddToPointEdgeMap(1, ptId0, outpt0, this->Mesh[1], cellId1,
+                            edgeId, lineId, triPtIds1);
+    this->AddToPointEdgeMap(1, ptId1, outpt1, this->Mesh[1], cellId1,
+                            edgeId, lineId, triPtIds1);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl
+::AddCoplanarSegment(const IntersectionSegmentType &segment,
+                     vtkIdType ptId0, vtkIdType ptId1)
+{
+  // A segment on an edge of both cells splits neither.
+  unsigned char along[2];
+  along[0] = segment.EdgeMask[0][0] & segment.EdgeMask[1][0];
+  along[1] = segment.EdgeMask[0][1] & segment.EdgeMask[1][1];
+  if ( ptId0 == ptId1 || ( along[0] && along[1] ) )
+    {
+    return;
+    }
+
+  // The cells sharing the edge the segment lies on find it as well.
+  int index = along[0] ? 1 : 0;
+  std::pair< vtkIdType, std::pair< vtkIdType, vtkIdType > > key;
+  key.first = segment.CellId[index];
+  key.second.first = std::min(ptId0, ptId1);
+  key.second.second = std::max(ptId0, ptId1);
+  if ( !this->LinesAlongEdges[index].insert(key).second )
+    {
+    return;
+    }
+
+  vtkIdType cellId0 = segment.CellId[0];
+  vtkIdType cellId1 = segment.CellId[1];
+  vtkIdType lineId = this->IntersectionLines->GetNumberOfCells();
+  this->IntersectionLines->InsertNextCell(2);
+  this->IntersectionLines->InsertCellPoint(ptId0);
+  this->IntersectionLines->InsertCellPoint(ptId1);
+
+  this->CellIds[0]->InsertNextValue(cellId0);
+  this->CellIds[1]->InsertNextValue(cellId1);
+
+  this->PointCellIds[0]->InsertValue( ptId0, cellId0 );
+  this->PointCellIds[0]->InsertValue( ptId1, cellId0 );
+  this->PointCellIds[1]->InsertValue( ptId0, cellId1 );
+  this->PointCellIds[1]->InsertValue( ptId1, cellId1 );
+
+  vtkIdType ptIds[2] = {ptId0, ptId1};
+  for (int i = 0; i < 2; i++)
+    {
+    if ( !along[i] )
+      {
+      this->IntersectionMap[i]->Append(segment.CellId[i], lineId);
+      }
+
+    // Record the first edge of each cell each endpoint lies on.
+    for (int j = 0; j < 2; j++)
+      {
+      for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+        {
+        if ( segment.EdgeMask[j][i] & (1 << edgeId) )
+          {
+          CellEdgeLineType cellEdgeLine;
+          cellEdgeLine.CellId = segment.CellId[i];
+          cellEdgeLine.EdgeId = edgeId;
+          cellEdgeLine.LineId = lineId;
+          this->PointEdgeMap[i]->Append(ptIds[j], cellEdgeLine);
+          break;
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl
+::AddMeshSegment(vtkIdType cellId, vtkIdType ptId0, vtkIdType ptId1)
+{
+  double pt0[3], pt1[3];
+  this->IntersectionPoints->GetPoint(ptId0, pt0);
+  this->IntersectionPoints->GetPoint(ptId1, pt1);
+
+  vtkIdType npts, *triPtIds;
+  this->Mesh[0]->GetCellPoints(cellId, npts, triPtIds);
+
+  vtkIdType lineId = this->IntersectionLines->GetNumberOfCells();
+  this->IntersectionLines->InsertNextCell(2);
+  this->IntersectionLines->InsertCellPoint(ptId0);
+  this->IntersectionLines->InsertCellPoint(ptId1);
+
+  this->CellIds[0]->InsertNextValue(cellId);
+  this->PointCellIds[0]->InsertValue( ptId0, cellId );
+  this->PointCellIds[0]->InsertValue( ptId1, cellId );
+
+  bool along = false;
+  for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
+    {
+    bool onEdge0 = this->AddToPointEdgeMap(0, ptId0, pt0, this->Mesh[0],
+                                           cellId, edgeId, lineId, triPtIds);
+    bool onEdge1 = this->AddToPointEdgeMap(0, ptId1, pt1, this->Mesh[0],
+                                           cellId, edgeId, lineId, triPtIds);
+    along = along || (onEdge0 && onEdge1);
+    }
+  if ( !along )
+    {
+    this->IntersectionMap[0]->Append(cellId, lineId);
+    }
+}
+
+//----------------------------------------------------------------------------
+// State shared by the threads of the parallel tree traversal. Each
+// thread owns a deque of node pairs. The owner pops from the back,
+// which keeps its own traversal depth-first, and idle threads steal
+// from the front, where the largest subtrees are.
+class vtkIntersectionPolyDataFilter::Impl::TraversalThreadState
+{
+public:
+  vtkSimpleMutexLock                Lock;
+  std::deque< NodePairTaskType >    Tasks;
+  std::deque< TraversalPathType >   Paths;
+  IntersectionSegmentVectorType     Segments;
+  std::vector< SegmentChunkType >   Chunks;
+};
+
+class vtkIntersectionPolyDataFilter::Impl::Traversal
+{
+public:
+  vtkIntersectionPolyDataFilter::Impl   *Impl;
+  TraversalThreadState                  *States;
+  int                                    NumberOfThreads;
+
+  // Number of node pairs queued or being processed. The traversal is
+  // finished when it drops to zero.
+  vtkIdType                              PendingTasks;
+  vtkSimpleMutexLock                     PendingLock;
+
+  // Idle threads wait on WorkAvailable until WorkVersion changes,
+  // which happens whenever node pairs are queued, or the traversal is
+  // finished. Both are guarded by PendingLock.
+  vtkSimpleConditionVariable             WorkAvailable;
+  vtkIdType                              WorkVersion;
+};
+
+//----------------------------------------------------------------------------
+// Work shared by the threads that split the cut cells of a mesh.
+class vtkIntersectionPolyDataFilter::Impl::SplitCellsType
+{
+public:
+  vtkIntersectionPolyDataFilter::Impl   *Impl;
+  vtkPolyData                           *Input;
+  vtkPoints                             *Points;
+  IntersectionMapType                   *Map;
+  vtkPolyData                           *SplitLines;
+  int                                    NumberOfThreads;
+
+  // The cells to split, their points and the resulting sub-cells.
+  std::vector< vtkIdType >               CellIds;
+  std::vector< vtkIdType* >              CellPts;
+  std::vector< vtkCellArray* >           Results;
+
+  // Index of the next cell to hand out.
+  size_t                                 NextCell;
+  vtkSimpleMutexLock                     Lock;
+};
 
-            int coplanar = 0;
-            double outpt0[3], outpt1[3];
-            int intersects =
-              vtkIntersectionPolyDataFilter::TriangleTriangleIntersection
-                (triPts0[0], triPts0[1], triPts0[2],
-                 triPts1[0], triPts1[1], triPts1[2],
-                 coplanar, outpt0, outpt1);
+//----------------------------------------------------------------------------
+// Work shared by the threads that weld the segment endpoints. In the
+// first pass the points are inserted into the welder, in the second
+// one the point each of them is welded to is looked up.
+class vtkIntersectionPolyDataFilter::Impl::WeldPointsType
+{
+public:
+  vtkIntersectionPointWelder            *Welder;
+  vtkIdType                             *Representatives;
+  vtkIdType                              NumberOfPoints;
+  int                                    Pass;
+  int                                    NumberOfThreads;
+
+  // Rank of the next point to hand out.
+  vtkIdType                              NextPoint;
+  vtkSimpleMutexLock                     Lock;
+};
+
+//----------------------------------------------------------------------------
+// Used to sort the segment chunks into the serial visiting order.
+class vtkSegmentChunkPathLess
+{
+public:
+  vtkSegmentChunkPathLess(std::vector< std::vector< unsigned char > > &paths)
+    : Paths(paths) {}
+  bool operator()(size_t a, size_t b) const
+    {
+    return std::lexicographical_compare(this->Paths[a].begin(),
+                                        this->Paths[a].end(),
+                                        this->Paths[b].begin(),
+                                        this->Paths[b].end());
+    }
+  std::vector< std::vector< unsigned char > > &Paths;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkIntersectionPolyDataFilter::Impl
+::TraverseTreesThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  Traversal *traversal =
+    static_cast<Traversal*>(threadInfo->UserData);
+  int threadId = threadInfo->ThreadID;
+  int numThreads = traversal->NumberOfThreads;
+  if (threadId >= numThreads)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  vtkIntersectionPolyDataFilter::Impl *impl = traversal->Impl;
+  TraversalThreadState *state = traversal->States + threadId;
+  vtkOBBTree *obbTree0 = impl->OBBTree0;
+
+  while (true)
+    {
+    // Remember which pushes we have seen, so that we do not sleep
+    // through one that happens while we look for work.
+    traversal->PendingLock.Lock();
+    vtkIdType workVersion = traversal->WorkVersion;
+    traversal->PendingLock.Unlock();
+
+    // Take work from our own queue first, then try to steal some.
+    NodePairTaskType task;
+    bool haveTask = false;
+    state->Lock.Lock();
+    if (!state->Tasks.empty())
+      {
+      task = state->Tasks.back();
+      state->Tasks.pop_back();
+      haveTask = true;
+      }
+    state->Lock.Unlock();
+
+    for (int i = 1; i < numThreads && !haveTask; i++)
+      {
+      TraversalThreadState *victim =
+        traversal->States + (threadId + i) % numThreads;
+      victim->Lock.Lock();
+      if (!victim->Tasks.empty())
+        {
+        task = victim->Tasks.front();
+        victim->Tasks.pop_front();
+        haveTask = true;
+        }
+      victim->Lock.Unlock();
+      }
+
+    if (!haveTask)
+      {
+      traversal->PendingLock.Lock();
+      while (traversal->PendingTasks != 0 &&
+             traversal->WorkVersion == workVersion)
+        {
+        traversal->WorkAvailable.Wait(traversal->PendingLock);
+        }
+      bool done = traversal->PendingTasks == 0;
+      traversal->PendingLock.Unlock();
+      if (done)
+        {
+        break;
+        }
+      continue;
+      }
+
+    // Same recursion as vtkOBBTree::IntersectWithOBBTree.
+    vtkOBBNode *nodeA = task.Node[0];
+    vtkOBBNode *nodeB = task.Node[1];
+    vtkOBBNode *kids[4][2];
+    int numKids = 0;
+    if ( !obbTree0->DisjointOBBNodes( nodeA, nodeB, impl->Transform ) )
+      {
+      if ( nodeA->Kids == NULL && nodeB->Kids == NULL )
+        {
+        SegmentChunkType chunk;
+        chunk.Path  = task.Path;
+        chunk.Begin = state->Segments.size();
+        impl->IntersectLeafNodes(nodeA, nodeB, state->Segments);
+        chunk.End   = state->Segments.size();
+        if (chunk.End > chunk.Begin)
+          {
+          state->Chunks.push_back(chunk);
+          }
+        }
+      else if ( nodeA->Kids == NULL )
+        {
+        kids[0][0] = nodeA; kids[0][1] = nodeB->Kids[0];
+        kids[1][0] = nodeA; kids[1][1] = nodeB->Kids[1];
+        numKids = 2;
+        }
+      else if ( nodeB->Kids == NULL )
+        {
+        kids[0][0] = nodeA->Kids[0]; kids[0][1] = nodeB;
+        kids[1][0] = nodeA->Kids[1]; kids[1][1] = nodeB;
+        numKids = 2;
+        }
+      else
+        {
+        kids[0][0] = nodeA->Kids[0]; kids[0][1] = nodeB->Kids[0];
+        kids[1][0] = nodeA->Kids[1]; kids[1][1] = nodeB->Kids[0];
+        kids[2][0] = nodeA->Kids[0]; kids[2][1] = nodeB->Kids[1];
+        kids[3][0] = nodeA->Kids[1]; kids[3][1] = nodeB->Kids[1];
+        numKids = 4;
+        }
+      }
+
+    if (numKids > 0)
+      {
+      // The serial traversal pushes the children in order and pops the
+      // last one first, so the last child gets the smallest digit.
+      state->Lock.Lock();
+      for (int i = 0; i < numKids; i++)
+        {
+        TraversalPathType path;
+        path.Parent = task.Path;
+        path.Depth  = task.Path->Depth + 1;
+        path.Digit  = static_cast<unsigned char>(numKids - 1 - i);
+        state->Paths.push_back(path);
+
+        NodePairTaskType kidTask;
+        kidTask.Node[0] = kids[i][0];
+        kidTask.Node[1] = kids[i][1];
+        kidTask.Path    = &state->Paths.back();
+        state->Tasks.push_back(kidTask);
+        }
+      state->Lock.Unlock();
+      }
+
+    traversal->PendingLock.Lock();
+    traversal->PendingTasks += numKids - 1;
+    if (numKids > 0 || traversal->PendingTasks == 0)
+      {
+      traversal->WorkVersion++;
+      traversal->WorkAvailable.Broadcast();
+      }
+    traversal->PendingLock.Unlock();
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkIntersectionPolyDataFilter::Impl
+::WeldPointsThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  WeldPointsType *weld = static_cast<WeldPointsType*>(threadInfo->UserData);
+  if (threadInfo->ThreadID >= weld->NumberOfThreads)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  const vtkIdType blockSize = 1024;
+  while (true)
+    {
+    weld->Lock.Lock();
+    vtkIdType begin = weld->NextPoint;
+    weld->NextPoint = std::min(begin + blockSize, weld->NumberOfPoints);
+    vtkIdType end = weld->NextPoint;
+    weld->Lock.Unlock();
+    if (begin >= end)
+      {
+      break;
+      }
+
+    for (vtkIdType rank = begin; rank < end; rank++)
+      {
+      if (weld->Pass == 0)
+        {
+        weld->Welder->Insert(rank);
+        }
+      else
+        {
+        weld->Representatives[rank] = weld->Welder->FindRepresentative(rank);
+        }
+      }
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::Impl
+::IntersectTreesInParallel(vtkIntersectionOBBTree *obbTree0,
+                           vtkIntersectionOBBTree *obbTree1,
+                           int numThreads)
+{
+  vtkOBBNode *root0 = obbTree0->GetRoot();
+  vtkOBBNode *root1 = obbTree1->GetRoot();
+  if (root0 == NULL || root1 == NULL)
+    {
+    return 0;
+    }
+
+  Traversal traversal;
+  traversal.Impl            = this;
+  traversal.States          = new TraversalThreadState[numThreads];
+  traversal.NumberOfThreads = numThreads;
+  traversal.PendingTasks    = 1;
+  traversal.WorkVersion     = 0;
+
+  TraversalPathType rootPath;
+  rootPath.Parent = NULL;
+  rootPath.Depth  = 0;
+  rootPath.Digit  = 0;
+  traversal.States[0].Paths.push_back(rootPath);
+
+  NodePairTaskType rootTask;
+  rootTask.Node[0] = root0;
+  rootTask.Node[1] = root1;
+  rootTask.Path    = &traversal.States[0].Paths.back();
+  traversal.States[0].Tasks.push_back(rootTask);
+
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->SetNumberOfThreads(numThreads);
+  threader->SetSingleMethod(TraverseTreesThread, &traversal);
+  threader->SingleMethodExecute();
+
+  // Put the chunks of all threads back into serial order.
+  std::vector< std::pair< int, size_t > > chunkIds;
+  std::vector< std::vector< unsigned char > > chunkPaths;
+  for (int i = 0; i < numThreads; i++)
+    {
+    for (size_t j = 0; j < traversal.States[i].Chunks.size(); j++)
+      {
+      const TraversalPathType *path = traversal.States[i].Chunks[j].Path;
+      std::vector< unsigned char > digits(path->Depth);
+      for ( ; path->Parent != NULL; path = path->Parent)
+        {
+        digits[path->Depth - 1] = path->Digit;
+        }
+      chunkIds.push_back(std::make_pair(i, j));
+      chunkPaths.push_back(digits);
+      }
+    }
+
+  std::vector< size_t > order(chunkIds.size());
+  for (size_t i = 0; i < order.size(); i++)
+    {
+    order[i] = i;
+    }
+  std::sort(order.begin(), order.end(), vtkSegmentChunkPathLess(chunkPaths));
+
+  std::vector< const IntersectionSegmentType* > segments;
+  for (size_t i = 0; i < order.size(); i++)
+    {
+    TraversalThreadState *state =
+      traversal.States + chunkIds[order[i]].first;
+    const SegmentChunkType &chunk = state->Chunks[chunkIds[order[i]].second];
+    for (size_t j = chunk.Begin; j < chunk.End; j++)
+      {
+      segments.push_back(&state->Segments[j]);
+      }
+    }
+
+  // The features of the endpoints identify them already.
+  if (this->TopologicalChaining)
+    {
+    threader->Delete();
+    for (size_t i = 0; i < segments.size(); i++)
+      {
+      this->AddIntersectionSegment(*segments[i]);
+      }
+    delete [] traversal.States;
+    return static_cast<int>(segments.size());
+    }
+
+  // Weld the endpoints concurrently. Endpoint 2*i+j is endpoint j of
+  // the i-th segment in serial order.
+  vtkIdType numPoints = 2 * static_cast<vtkIdType>(segments.size());
+  std::vector< double > points(3*numPoints + 3);
+  for (size_t i = 0; i < segments.size(); i++)
+    {
+    const double *pt = &segments[i]->Pt[0][0];
+    std::copy(pt, pt + 6, &points[6*i]);
+    }
+
+  std::vector< vtkIdType > representatives(numPoints + 1);
+  vtkIntersectionPointWelder welder(&points[0], numPoints,
+                                    this->MergeTolerance, 4*numThreads);
+  WeldPointsType weld;
+  weld.Welder          = &welder;
+  weld.Representatives = &representatives[0];
+  weld.NumberOfPoints  = numPoints;
+  weld.NumberOfThreads = numThreads;
+  threader->SetSingleMethod(WeldPointsThread, &weld);
+  for (weld.Pass = 0; weld.Pass < 2; weld.Pass++)
+    {
+    weld.NextPoint = 0;
+    threader->SingleMethodExecute();
+    }
+  threader->Delete();
+
+  // Number the welded points in the order in which the serial weld
+  // inserts them, then merge the segments into the output.
+  std::vector< vtkIdType > weldedIds(numPoints + 1, -1);
+  std::vector< vtkIdType > pointIds(numPoints + 1);
+  for (vtkIdType rank = 0; rank < numPoints; rank++)
+    {
+    vtkIdType representative = representatives[rank];
+    if (weldedIds[representative] < 0)
+      {
+      weldedIds[representative] = this->IntersectionPoints->InsertNextPoint(
+        &points[3*representative]);
+      }
+    pointIds[rank] = weldedIds[representative];
+    }
+
+  for (size_t i = 0; i < segments.size(); i++)
+    {
+    this->AddWeldedSegment(*segments[i], pointIds[2*i], pointIds[2*i+1]);
+    }
+
+  delete [] traversal.States;
+
+  return static_cast<int>(segments.size());
+}
+
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::Impl::BuildIntersectionMaps()
+{
+  for (int i = 0; i < 2; i++)
+    {
+    this->IntersectionMap[i]->Build();
+    this->PointEdgeMap[i]->Build();
+
+    // Keep only the first edge of each cell on which a point lies.
+    this->PointEdgeMap[i]->RemoveDuplicates(vtkCellEdgeLineSameCell());
+    }
+}
+
+//----------------------------------------------------------------------------
+// Returns the array of inPD that CopyAllocate() allocated array i of
+// outPD for: the input attribute of the same type for an attribute,
+// otherwise the input array of the same name that is not an attribute.
+// Returns NULL if there is no such array or more than one.
+static vtkAbstractArray* vtkIntersectionFindSourceArray(vtkPointData *inPD,
+                                                       vtkPointData *outPD,
+                                                       int i)
+{
+  int attributeType = outPD->IsArrayAnAttribute(i);
+  if ( attributeType >= 0 )
+    {
+    return inPD->GetAttribute(attributeType);
+    }
+
+  const char *name = outPD->GetAbstractArray(i)->GetName();
+  if ( name == NULL )
+    {
+    return NULL;
+    }
+  vtkAbstractArray *match = NULL;
+  for (int j = 0; j < inPD->GetNumberOfArrays(); j++)
+    {
+    vtkAbstractArray *inArray = inPD->GetAbstractArray(j);
+    if ( inArray->GetName() == NULL || strcmp(inArray->GetName(), name) != 0 ||
+         inPD->IsArrayAnAttribute(j) >= 0 )
+      {
+      continue;
+      }
+    if ( match != NULL )
+      {
+      return NULL;
+      }
+    match = inArray;
+    }
+  return match;
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::Impl
+::SplitMesh(int inputIndex, vtkPolyData *output, vtkPolyData *intersectionLines)
+{
+  vtkPolyData *input = this->Mesh[inputIndex];
+  IntersectionMapType *intersectionMap = this->IntersectionMap[inputIndex];
+  vtkPoints *inPts = input->GetPoints();
+  vtkCellData *inCD  = input->GetCellData();
+  vtkCellData *outCD = output->GetCellData();
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkIdType newId;
+  vtkIdType cellId = 0;
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Process points
+  ///////////////////////////////////////////////////////////////////////////
+  vtkIdType inputNumPoints = input->GetPoints()->GetNumberOfPoints();
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  points->SetDataType(inPts->GetDataType());
+  output->SetPoints(points);
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Split intersection lines. The lines structure is constructed
+  // using a vtkPointLocator. However, some lines may have an endpoint
+  // on a cell edge that has no neighbor. We need to duplicate a line
+  // point in such a case and update the point ID in the line cell.
+  ///////////////////////////////////////////////////////////////////////////
+  vtkSmartPointer< vtkPolyData > splitLines =
+    vtkSmartPointer <vtkPolyData >::New();
+  splitLines->DeepCopy(intersectionLines);
+  this->SplitIntersectionLines( inputIndex, input, splitLines );
+
+  vtkPointData *inPD  = input->GetPointData();
+  vtkPointData *outPD = output->GetPointData();
+  vtkIdType outputNumPoints = inputNumPoints + splitLines->GetNumberOfPoints();
+  outPD->CopyAllocate( inPD, outputNumPoints );
+
+  // Copy over the points and point data from the input in bulk. The
+  // output arrays are the ones set up by CopyAllocate(), so they can
+  // be filled with DeepCopy() and still receive the interpolated
+  // data of the intersection points below.
+  points->GetData()->DeepCopy(inPts->GetData());
+  points->Resize(outputNumPoints);
+
+  std::vector< vtkAbstractArray* > inArrays(outPD->GetNumberOfArrays());
+  bool bulkCopied = true;
+  for (int i = 0; i < outPD->GetNumberOfArrays() && bulkCopied; i++)
+    {
+    vtkAbstractArray *outArray = outPD->GetAbstractArray(i);
+    vtkAbstractArray *inArray = vtkIntersectionFindSourceArray(inPD, outPD, i);
+    bulkCopied = inArray != NULL &&
+      inArray->GetDataType() == outArray->GetDataType() &&
+      inArray->GetNumberOfComponents() == outArray->GetNumberOfComponents() &&
+      inArray->GetNumberOfTuples() == inputNumPoints;
+    inArrays[i] = inArray;
+    }
+
+  if ( bulkCopied )
+    {
+    for (int i = 0; i < outPD->GetNumberOfArrays(); i++)
+      {
+      vtkAbstractArray *outArray = outPD->GetAbstractArray(i);
+      outArray->DeepCopy(inArrays[i]);
+      outArray->Resize(outputNumPoints);
+      }
+    }
+  else
+    {
+    // Arrays that cannot be matched up, copy the data point by point
+    // instead.
+    for (vtkIdType ptId = 0; ptId < inputNumPoints; ptId++)
+      {
+      outPD->CopyData(inPD, ptId, ptId);
+      }
+    }
+
+  // Copy the points from splitLines to the output, interpolating the
+  // data as we go.
+  this->FirstSplitPointId[inputIndex] = output->GetNumberOfPoints();
+  for (vtkIdType id = 0; id < splitLines->GetNumberOfPoints(); id++)
+    {
+    double pt[3];
+    splitLines->GetPoint(id, pt);
+    vtkIdType newPtId = output->GetPoints()->InsertNextPoint(pt);
+
+    // Retrieve the cell ID from splitLines
+    vtkIdType cellId = this->PointCellIds[inputIndex]->GetValue( id );
+
+    double closestPt[3], pcoords[3], dist2, weights[3];
+    int subId;
+    vtkCell *cell = input->GetCell(cellId);
+    cell->EvaluatePosition(pt, closestPt, subId, pcoords, dist2, weights);
+    outPD->InterpolatePoint(input->GetPointData(), newPtId, cell->PointIds,
+                            weights);
+    }
+
+  vtkIdType numInputPts = input->GetNumberOfPoints();
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Process cells
+  ///////////////////////////////////////////////////////////////////////////
+  outCD->CopyAllocate(inCD, numCells);
+
+  if ( input->GetPolys()->GetNumberOfCells() > 0 )
+    {
+    vtkCellArray *cells = input->GetPolys();
+    newId = output->GetNumberOfCells();
+
+    vtkSmartPointer< vtkCellArray > newPolys =
+      vtkSmartPointer< vtkCellArray >::New();
+
+    newPolys->EstimateSize(cells->GetNumberOfCells(),3);
+    output->SetPolys(newPolys);
+
+    // The input bounds are computed lazily, which is not safe to do
+    // from several threads in SplitCell().
+    input->ComputeBounds();
+
+    // First find the cells that need to be split.
+    SplitCellsType split;
+    split.Impl       = this;
+    split.Input      = input;
+    split.Points     = points;
+    split.Map        = intersectionMap;
+    split.SplitLines = splitLines;
+    split.NextCell   = 0;
+
+    vtkSmartPointer< vtkIdList > edgeNeighbors =
+      vtkSmartPointer< vtkIdList >::New();
+    vtkIdType npts = 0;
+    vtkIdType *pts = 0;
+    std::vector< char > cellNeedsSplit(numCells, 0);
+    std::vector< vtkIdType* > cellPts(numCells, static_cast<vtkIdType*>(0));
+    for (cells->InitTraversal(); cells->GetNextCell(npts, pts); cellId++)
+      {
+      if ( npts != 3 )
+        {
+        vtkGenericWarningMacro( << "vtkIntersectionPolyDataFilter only works with "
+                                << "triangle meshes." );
+        continue;
+        }
+
+      cellPts[cellId] = pts;
+
+      // If the cell is in the intersection map, split. If not, one of
+      // its edges may be split by an intersection line that splits a
+      // neighbor cell. Mark the cell as needing a split if this is
+      // the case.
+      bool needsSplit = intersectionMap->GetNumberOfValues( cellId ) > 0;
+      for (vtkIdType ptId = 0; ptId < npts && !needsSplit; ptId++)
+        {
+        vtkIdType pt0Id = pts[ptId];
+        vtkIdType pt1Id = pts[(ptId+1) % npts];
+        edgeNeighbors->Reset();
+        input->GetCellEdgeNeighbors(cellId, pt0Id, pt1Id, edgeNeighbors);
+        for (vtkIdType nbr = 0; nbr < edgeNeighbors->GetNumberOfIds(); nbr++)
+          {
+          if ( intersectionMap->GetNumberOfValues( edgeNeighbors->GetId(nbr) ) > 0 )
+            {
+            needsSplit = true;
+            }
+          } // for (vtkIdType nbr = 0; ...
+        } // for (vtkIdType pt = 0; ...
+
+      if ( needsSplit )
+        {
+        cellNeedsSplit[cellId] = 1;
+        split.CellIds.push_back(cellId);
+        split.CellPts.push_back(pts);
+        }
+      } // for (cells->InitTraversal(); ...
+
+    // Splitting occurs here. Each cut cell is re-triangulated
+    // independently, so the work is shared among the threads.
+    split.Results.resize(split.CellIds.size(), static_cast<vtkCellArray*>(0));
+    int numThreads = this->NumberOfThreads;
+    if ( static_cast<size_t>(numThreads) > split.CellIds.size() )
+      {
+      numThreads = static_cast<int>(split.CellIds.size());
+      }
+    if ( numThreads > 1 )
+      {
+      split.NumberOfThreads = numThreads;
+      vtkMultiThreader *threader = vtkMultiThreader::New();
+      threader->SetNumberOfThreads(numThreads);
+      threader->SetSingleMethod(SplitCellsThread, &split);
+      threader->SingleMethodExecute();
+      threader->Delete();
+      }
+    else
+      {
+      for (size_t i = 0; i < split.CellIds.size(); i++)
+        {
+        split.Results[i] = this->SplitAndOrientCell
+          (input, points, split.CellIds[i], split.CellPts[i], intersectionMap,
+           splitLines);
+        }
+      }
+
+    // Emit the cells in cell ID order.
+    size_t splitIdx = 0;
+    for (cellId = 0; cellId < numCells; cellId++)
+      {
+      if ( cellPts[cellId] == NULL )
+        {
+        continue;
+        }
+
+      if ( !cellNeedsSplit[cellId] )
+        {
+        // Just insert the cell and copy the cell data
+        newId = newPolys->InsertNextCell(3, cellPts[cellId]);
+        outCD->CopyData(inCD, cellId, newId);
+        continue;
+        }
+
+      vtkCellArray *splitCells = split.Results[splitIdx++];
+      vtkIdType *ptIds;
+      for (splitCells->InitTraversal(); splitCells->GetNextCell(npts, ptIds); )
+        {
+        newId = newPolys->InsertNextCell(npts, ptIds);
+        outCD->CopyData(inCD, cellId, newId); // Duplicate cell data
+        }
+      splitCells->Delete();
+      }
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+vtkCellArray* vtkIntersectionPolyDataFilter::Impl
+::SplitAndOrientCell(vtkPolyData *input, vtkPoints *points, vtkIdType cellId,
+                     vtkIdType *pts, IntersectionMapType *map,
+                     vtkPolyData *interLines)
+{
+  vtkCellArray *splitCells = this->SplitCell
+    (input, cellId, pts, map, interLines);
+
+  double pt0[3], pt1[3], pt2[3], normal[3];
+  points->GetPoint(pts[0], pt0);
+  points->GetPoint(pts[1], pt1);
+  points->GetPoint(pts[2], pt2);
+  vtkTriangle::ComputeNormal(pt0, pt1, pt2, normal);
+  vtkMath::Normalize(normal);
+
+  vtkCellArray *orientedCells = vtkCellArray::New();
+  orientedCells->Allocate(splitCells->GetNumberOfConnectivityEntries());
+
+  vtkIdType npts, *ptIds;
+  for (splitCells->InitTraversal(); splitCells->GetNextCell(npts, ptIds); )
+    {
+    // Check for reversed cells. I'm not sure why, but in some
+    // cases, cells are reversed.
+    double subCellNormal[3];
+    points->GetPoint(ptIds[0], pt0);
+    points->GetPoint(ptIds[1], pt1);
+    points->GetPoint(ptIds[2], pt2);
+    vtkTriangle::ComputeNormal(pt0, pt1, pt2, subCellNormal);
+    vtkMath::Normalize(subCellNormal);
+
+    if ( vtkMath::Dot(normal, subCellNormal) > 0 )
+      {
+      orientedCells->InsertNextCell(npts, ptIds);
+      }
+    else
+      {
+      orientedCells->InsertNextCell(npts);
+      for ( int i = 0; i < npts; i++)
+        {
+        orientedCells->InsertCellPoint( ptIds[ npts-i-1 ] );
+        }
+      }
+    }
+  splitCells->Delete();
+
+  return orientedCells;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkIntersectionPolyDataFilter::Impl
+::SplitCellsThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  SplitCellsType *split = static_cast<SplitCellsType*>(threadInfo->UserData);
+  if (threadInfo->ThreadID >= split->NumberOfThreads)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  // Cut cells vary a lot in cost, so hand them out in small chunks.
+  const size_t chunkSize = 8;
+  size_t numSplitCells = split->CellIds.size();
+  while (true)
+    {
+    split->Lock.Lock();
+    size_t begin = split->NextCell;
+    split->NextCell = std::min(begin + chunkSize, numSplitCells);
+    size_t end = split->NextCell;
+    split->Lock.Unlock();
+
+    if (begin >= numSplitCells)
+      {
+      break;
+      }
+
+    for (size_t i = begin; i < end; i++)
+      {
+      split->Results[i] = split->Impl->SplitAndOrientCell
+        (split->Input, split->Points, split->CellIds[i], split->CellPts[i],
+         split->Map, split->SplitLines);
+      }
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+
+//----------------------------------------------------------------------------
+// Maximum number of points in a cut cell that is triangulated with
+// vtkSmallPolygonTriangulator. Cells with more points are handed to
+// vtkDelaunay2D.
+#define VTK_SMALL_POLYGON_MAX_POINTS 64
+
+//----------------------------------------------------------------------------
+// Constrained Delaunay triangulation of a handful of 2D points that
+// works entirely on fixed-size arrays. Points are inserted with the
+// Bowyer-Watson algorithm inside a super triangle, constraint edges
+// are recovered by edge flips (Sloan, "A fast algorithm for generating
+// constrained Delaunay triangulations", 1993) and the Delaunay
+// property is then restored away from the constraints. Triangulate()
+// returns 0 whenever the input is too large or too degenerate, in
+// which case the caller should use vtkDelaunay2D instead.
+class vtkSmallPolygonTriangulator
+{
+public:
+  enum
+  {
+    MaxPoints      = VTK_SMALL_POLYGON_MAX_POINTS,
+    MaxTriangles   = 2*(VTK_SMALL_POLYGON_MAX_POINTS + 3),
+    MaxConstraints = 3*VTK_SMALL_POLYGON_MAX_POINTS
+  };
+
+  vtkSmallPolygonTriangulator()
+    : NumberOfTriangles(0), NumberOfPoints(0), NumberOfConstraints(0) {}
+
+  // Adds a point and returns its index, or -1 if the triangulator is
+  // full.
+  int InsertNextPoint(double x, double y)
+  {
+    if (this->NumberOfPoints >= MaxPoints)
+      {
+      return -1;
+      }
+    this->Points[this->NumberOfPoints][0] = x;
+    this->Points[this->NumberOfPoints][1] = y;
+    return this->NumberOfPoints++;
+  }
+
+  // Requires the edge between points a and b to be in the
+  // triangulation. Returns 0 if the triangulator is full.
+  int InsertConstraint(int a, int b)
+  {
+    if (a == b)
+      {
+      return 1;
+      }
+    if (this->NumberOfConstraints >= MaxConstraints)
+      {
+      return 0;
+      }
+    this->Constraints[this->NumberOfConstraints][0] = a;
+    this->Constraints[this->NumberOfConstraints][1] = b;
+    this->NumberOfConstraints++;
+    return 1;
+  }
+
+  // Computes the triangulation. On success, the counter-clockwise
+  // triangles are available in Triangles[0..NumberOfTriangles-1].
+  int Triangulate();
+
+  int NumberOfTriangles;
+  int Triangles[MaxTriangles][3];
+
+private:
+  double Orientation(int a, int b, int c) const
+  {
+    const double *pa = this->Points[a];
+    const double *pb = this->Points[b];
+    const double *pc = this->Points[c];
+    return (pb[0] - pa[0])*(pc[1] - pa[1]) - (pb[1] - pa[1])*(pc[0] - pa[0]);
+  }
+
+  // Positive if d lies inside the circumcircle of the counter-clockwise
+  // triangle (a, b, c).
+  double InCircle(int a, int b, int c, int d) const
+  {
+    const double *pd = this->Points[d];
+    double adx = this->Points[a][0] - pd[0], ady = this->Points[a][1] - pd[1];
+    double bdx = this->Points[b][0] - pd[0], bdy = this->Points[b][1] - pd[1];
+    double cdx = this->Points[c][0] - pd[0], cdy = this->Points[c][1] - pd[1];
+    return (adx*adx + ady*ady)*(bdx*cdy - cdx*bdy) +
+           (bdx*bdx + bdy*bdy)*(cdx*ady - adx*cdy) +
+           (cdx*cdx + cdy*cdy)*(adx*bdy - bdx*ady);
+  }
+
+  // True if the open segments (a, b) and (c, d) cross.
+  bool Crosses(int a, int b, int c, int d) const
+  {
+    return this->Orientation(a, b, c)*this->Orientation(a, b, d) < 0.0 &&
+           this->Orientation(c, d, a)*this->Orientation(c, d, b) < 0.0;
+  }
+
+  // Finds the triangle with the directed edge (a, b). Returns its
+  // index and the opposite vertex, or -1.
+  int FindEdge(int a, int b, int &opposite) const
+  {
+    for (int t = 0; t < this->NumberOfTriangles; t++)
+      {
+      for (int i = 0; i < 3; i++)
+        {
+        if (this->Triangles[t][i] == a && this->Triangles[t][(i+1) % 3] == b)
+          {
+          opposite = this->Triangles[t][(i+2) % 3];
+          return t;
+          }
+        }
+      }
+    return -1;
+  }
+
+  bool HasEdge(int a, int b) const
+  {
+    int opposite;
+    return this->FindEdge(a, b, opposite) >= 0 ||
+           this->FindEdge(b, a, opposite) >= 0;
+  }
+
+  bool IsConstraint(int a, int b) const
+  {
+    for (int i = 0; i < this->NumberOfConstraints; i++)
+      {
+      if ((this->Constraints[i][0] == a && this->Constraints[i][1] == b) ||
+          (this->Constraints[i][0] == b && this->Constraints[i][1] == a))
+        {
+        return true;
+        }
+      }
+    return false;
+  }
+
+  // Replaces the diagonal (u, v) of the quadrilateral formed by the
+  // triangles (u, v, w1) and (v, u, w2) with (w1, w2). The
+  // quadrilateral must be strictly convex.
+  void FlipEdge(int t1, int t2, int u, int v, int w1, int w2)
+  {
+    this->SetTriangle(t1, u, w2, w1);
+    this->SetTriangle(t2, w2, v, w1);
+  }
+
+  void SetTriangle(int t, int a, int b, int c)
+  {
+    this->Triangles[t][0] = a;
+    this->Triangles[t][1] = b;
+    this->Triangles[t][2] = c;
+  }
+
+  int InsertDelaunay(int p);
+  int RecoverConstraint(int a, int b);
+  int RestoreDelaunay();
+
+  int    NumberOfPoints;
+  double Points[MaxPoints + 3][2];
+  int    NumberOfConstraints;
+  int    Constraints[MaxConstraints][2];
+};
+
+//----------------------------------------------------------------------------
+int vtkSmallPolygonTriangulator::Triangulate()
+{
+  int numPoints = this->NumberOfPoints;
+  if (numPoints < 3)
+    {
+    return 0;
+    }
+
+  // Enclose all points in a large super triangle.
+  double bounds[4] = {this->Points[0][0], this->Points[0][0],
+                      this->Points[0][1], this->Points[0][1]};
+  for (int i = 1; i < numPoints; i++)
+    {
+    bounds[0] = std::min(bounds[0], this->Points[i][0]);
+    bounds[1] = std::max(bounds[1], this->Points[i][0]);
+    bounds[2] = std::min(bounds[2], this->Points[i][1]);
+    bounds[3] = std::max(bounds[3], this->Points[i][1]);
+    }
+  double size = std::max(bounds[1] - bounds[0], bounds[3] - bounds[2]);
+  if (size <= 0.0)
+    {
+    return 0;
+    }
+  double cx = 0.5*(bounds[0] + bounds[1]);
+  double cy = 0.5*(bounds[2] + bounds[3]);
+  int s0 = numPoints, s1 = numPoints + 1, s2 = numPoints + 2;
+  this->Points[s0][0] = cx - 20.0*size; this->Points[s0][1] = cy - 10.0*size;
+  this->Points[s1][0] = cx + 20.0*size; this->Points[s1][1] = cy - 10.0*size;
+  this->Points[s2][0] = cx;             this->Points[s2][1] = cy + 20.0*size;
+  this->NumberOfTriangles = 1;
+  this->SetTriangle(0, s0, s1, s2);
+
+  for (int i = 0; i < numPoints; i++)
+    {
+    if (!this->InsertDelaunay(i))
+      {
+      return 0;
+      }
+    }
+
+  for (int i = 0; i < this->NumberOfConstraints; i++)
+    {
+    if (!this->RecoverConstraint(this->Constraints[i][0],
+                                 this->Constraints[i][1]))
+      {
+      return 0;
+      }
+    }
+
+  if (!this->RestoreDelaunay())
+    {
+    return 0;
+    }
+
+  // Remove the triangles that use the super triangle vertices.
+  int numKept = 0;
+  for (int t = 0; t < this->NumberOfTriangles; t++)
+    {
+    if (this->Triangles[t][0] < numPoints &&
+        this->Triangles[t][1] < numPoints &&
+        this->Triangles[t][2] < numPoints)
+      {
+      this->SetTriangle(numKept++, this->Triangles[t][0],
+                        this->Triangles[t][1], this->Triangles[t][2]);
+      }
+    }
+  this->NumberOfTriangles = numKept;
+
+  return numKept > 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkSmallPolygonTriangulator::InsertDelaunay(int p)
+{
+  // Find the triangles whose circumcircle contains the point.
+  bool bad[MaxTriangles];
+  int numBad = 0;
+  for (int t = 0; t < this->NumberOfTriangles; t++)
+    {
+    const int *tri = this->Triangles[t];
+    bad[t] = this->InCircle(tri[0], tri[1], tri[2], p) > 0.0;
+    numBad += bad[t];
+    }
+  if (numBad == 0)
+    {
+    return 0;
+    }
+
+  // The edges of the bad triangles that are not shared by two of them
+  // bound the cavity.
+  int cavity[3*MaxTriangles][2];
+  int numCavityEdges = 0;
+  for (int t = 0; t < this->NumberOfTriangles; t++)
+    {
+    if (!bad[t])
+      {
+      continue;
+      }
+    for (int i = 0; i < 3; i++)
+      {
+      int u = this->Triangles[t][i];
+      int v = this->Triangles[t][(i+1) % 3];
+      int opposite;
+      int nbr = this->FindEdge(v, u, opposite);
+      if (nbr < 0 || !bad[nbr])
+        {
+        cavity[numCavityEdges][0] = u;
+        cavity[numCavityEdges][1] = v;
+        numCavityEdges++;
+        }
+      }
+    }
+
+  int numKept = 0;
+  for (int t = 0; t < this->NumberOfTriangles; t++)
+    {
+    if (!bad[t])
+      {
+      this->SetTriangle(numKept++, this->Triangles[t][0],
+                        this->Triangles[t][1], this->Triangles[t][2]);
+      }
+    }
+  if (numKept + numCavityEdges > MaxTriangles)
+    {
+    return 0;
+    }
+
+  // Connect the point to the cavity boundary. A new triangle with the
+  // wrong orientation means round-off made the cavity non-star-shaped.
+  for (int i = 0; i < numCavityEdges; i++)
+    {
+    if (this->Orientation(cavity[i][0], cavity[i][1], p) <= 0.0)
+      {
+      return 0;
+      }
+    this->SetTriangle(numKept++, cavity[i][0], cavity[i][1], p);
+    }
+  this->NumberOfTriangles = numKept;
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkSmallPolygonTriangulator::RecoverConstraint(int a, int b)
+{
+  if (this->HasEdge(a, b))
+    {
+    return 1;
+    }
+
+  // Collect the edges that cross the constraint.
+  int queue[3*MaxTriangles][2];
+  int head = 0, numQueued = 0;
+  for (int t = 0; t < this->NumberOfTriangles; t++)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      int u = this->Triangles[t][i];
+      int v = this->Triangles[t][(i+1) % 3];
+      if (u < v && this->Crosses(a, b, u, v))
+        {
+        queue[numQueued][0] = u;
+        queue[numQueued][1] = v;
+        numQueued++;
+        }
+      }
+    }
 
-            if ( coplanar )
-              {
-              // Coplanar triangle intersection is not handled.
-              // This intersection will not be included in the output.
-              intersects = 0;
-              continue;
-              }
+  // Flip them away. Edges whose quadrilateral is not convex are put
+  // back at the end of the queue until a neighboring flip makes it so.
+  const int queueSize = 3*MaxTriangles;
+  int maxIterations = 32*MaxTriangles;
+  for (int iteration = 0; head != numQueued; iteration++)
+    {
+    if (iteration > maxIterations)
+      {
+      return 0;
+      }
 
-            if ( intersects &&
-                 ( outpt0[0] != outpt1[0] ||
-                   outpt0[1] != outpt1[1] ||
-                   outpt0[2] != outpt1[2] ) )
-              {
-              vtkIdType lineId = intersectionLines->GetNumberOfCells();
-              intersectionLines->InsertNextCell(2);
+    int u = queue[head % queueSize][0];
+    int v = queue[head % queueSize][1];
+    head++;
 
-              vtkIdType ptId0, ptId1;
-              pointMerger->InsertUniquePoint(outpt0, ptId0);
-              pointMerger->InsertUniquePoint(outpt1, ptId1);
-              intersectionLines->InsertCellPoint(ptId0);
-              intersectionLines->InsertCellPoint(ptId1);
+    int w1 = -1, w2 = -1;
+    int t1 = this->FindEdge(u, v, w1);
+    int t2 = this->FindEdge(v, u, w2);
+    if (t1 < 0 || t2 < 0)
+      {
+      return 0;
+      }
 
-              intersectionCellIds0->InsertNextValue(cellId0);
-              intersectionCellIds1->InsertNextValue(cellId1);
+    int next[2] = {u, v};
+    if (this->Crosses(u, v, w1, w2))
+      {
+      this->FlipEdge(t1, t2, u, v, w1, w2);
+      if (!this->Crosses(a, b, w1, w2))
+        {
+        continue;
+        }
+      next[0] = w1;
+      next[1] = w2;
+      }
 
-              info->PointCellIds[0]->InsertValue( ptId0, cellId0 );
-              info->PointCellIds[0]->InsertValue( ptId1, cellId0 );
-              info->PointCellIds[1]->InsertValue( ptId0, cellId1 );
-              info->PointCellIds[1]->InsertValue( ptId1, cellId1 );
+    if (numQueued - head >= queueSize)
+      {
+      return 0;
+      }
+    queue[numQueued % queueSize][0] = next[0];
+    queue[numQueued % queueSize][1] = next[1];
+    numQueued++;
+    }
 
-              info->IntersectionMap[0]->insert(std::make_pair(cellId0, lineId));
-              info->IntersectionMap[1]->insert(std::make_pair(cellId1, lineId));
+  return this->HasEdge(a, b);
+}
 
-              // Check which edges of cellId0 and cellId1 outpt0 and
-              // outpt1 are on, if any.
-              for (vtkIdType edgeId = 0; edgeId < 3; edgeId++)
-                {
-                info->AddToPointEdgeMap(0, ptId0, outpt0, mesh0, cellId0,
-                                        edgeId, lineId, triPtIds0);
-                info->AddToPointEdgeMap(0, ptId1, outpt1, mesh0, cellId0,
-                                        edgeId, lineId, triPtIds0);
-                info->AddToPointEdgeMap(1, ptId0, outpt0, mesh1, cellId1,
-                                        edgeId, lineId, triPtIds1);
-                info->AddToPointEdgeMap(1, ptId1, outpt1, mesh1, cellId1,
-                                        edgeId, lineId, triPtIds1);
-                }
-              retval++;
-              }
-            }
+//----------------------------------------------------------------------------
+int vtkSmallPolygonTriangulator::RestoreDelaunay()
+{
+  // Lawson flips on the unconstrained edges until the triangulation is
+  // constrained Delaunay.
+  for (int pass = 0; pass < MaxTriangles; pass++)
+    {
+    bool flipped = false;
+    for (int t1 = 0; t1 < this->NumberOfTriangles; t1++)
+      {
+      for (int i = 0; i < 3; i++)
+        {
+        int u  = this->Triangles[t1][i];
+        int v  = this->Triangles[t1][(i+1) % 3];
+        int w1 = this->Triangles[t1][(i+2) % 3];
+        int w2 = -1;
+        int t2 = this->FindEdge(v, u, w2);
+        if (t2 < 0 || this->IsConstraint(u, v) ||
+            this->InCircle(u, v, w1, w2) <= 0.0 ||
+            !this->Crosses(u, v, w1, w2))
+          {
+          continue;
           }
+        this->FlipEdge(t1, t2, u, v, w1, w2);
+        flipped = true;
+        break;
         }
       }
+    if (!flipped)
+      {
+      return 1;
+      }
     }
 
-    return retval;
+  return 0;
 }
 
-
 //----------------------------------------------------------------------------
-int vtkIntersectionPolyDataFilter::Impl
-::SplitMesh(int inputIndex, vtkPolyData *output, vtkPolyData *intersectionLines)
+vtkCellArray* vtkIntersectionPolyDataFilter::Impl
+::SplitSmallCell(vtkPolyData *input, vtkIdType cellId, vtkIdType *cellPts,
+                 IntersectionMapType *map, vtkPolyData *interLines)
 {
-  vtkPolyData *input = this->Mesh[inputIndex];
-  IntersectionMapType *intersectionMap = this->IntersectionMap[inputIndex];
-  vtkPoints *inPts = input->GetPoints();
-  vtkCellData *inCD  = input->GetCellData();
-  vtkCellData *outCD = output->GetCellData();
-  vtkIdType numCells = input->GetNumberOfCells();
-  vtkIdType newId;
-  vtkIdType cellId = 0;
+  const int maxPoints = vtkSmallPolygonTriangulator::MaxPoints;
+  const double tolerance2 = 1e-6*1e-6;
 
-  ///////////////////////////////////////////////////////////////////////////
-  // Process points
-  ///////////////////////////////////////////////////////////////////////////
-  vtkIdType inputNumPoints = input->GetPoints()->GetNumberOfPoints();
-  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
-  points->Allocate(100);
-  output->SetPoints(points);
+  // Points of the cell, welded by a linear search. The first three
+  // are the cell points.
+  double x[maxPoints][3];
+  int numPoints = 0;
+  for (int i = 0; i < 3; i++)
+    {
+    input->GetPoint(cellPts[i], x[numPoints++]);
+    }
 
-  ///////////////////////////////////////////////////////////////////////////
-  // Split intersection lines. The lines structure is constructed
-  // using a vtkPointLocator. However, some lines may have an endpoint
-  // on a cell edge that has no neighbor. We need to duplicate a line
-  // point in such a case and update the point ID in the line cell.
-  ///////////////////////////////////////////////////////////////////////////
-  vtkSmartPointer< vtkPolyData > splitLines =
-    vtkSmartPointer <vtkPolyData >::New();
-  splitLines->DeepCopy(intersectionLines);
-  this->SplitIntersectionLines( inputIndex, input, splitLines );
+  // Maps the point IDs in interLines to the cell point IDs. NOTE: The
+  // point IDs from the cell are not stored here.
+  vtkIdType mappedIds[2*maxPoints];
+  int mappedLocalIds[2*maxPoints];
+  int numMapped = 0;
 
-  vtkPointData *inPD  = input->GetPointData();
-  vtkPointData *outPD = output->GetPointData();
-  outPD->CopyAllocate( inPD, input->GetNumberOfPoints() );
+  // Constraint lines, as cell point IDs.
+  int lines[3*maxPoints][2];
+  int numLines = 0;
 
-  // Copy over the point data from the input
-  for (vtkIdType ptId = 0; ptId < inputNumPoints; ptId++)
+  vtkIdType numCellLines = map->GetNumberOfValues( cellId );
+  for (vtkIdType lineIdx = 0; lineIdx < numCellLines; lineIdx++)
     {
-    double pt[3];
-    input->GetPoints()->GetPoint(ptId, pt);
-    output->GetPoints()->InsertNextPoint(pt);
-    outPD->CopyData(inPD, ptId, ptId);
+    vtkIdType lineId = map->GetValues( cellId )[lineIdx];
+    vtkIdType nLinePts, *linePtIds;
+    interLines->GetLines()->GetCell( 3*lineId, nLinePts, linePtIds );
+    if ( nLinePts != 2 || numLines >= 3*maxPoints )
+      {
+      return NULL;
+      }
+    for (vtkIdType i = 0; i < nLinePts; i++)
+      {
+      int localId = -1;
+      for (int j = 0; j < numMapped && localId < 0; j++)
+        {
+        if ( mappedIds[j] == linePtIds[i] )
+          {
+          localId = mappedLocalIds[j];
+          }
+        }
+      if ( localId < 0 )
+        {
+        double pt[3];
+        interLines->GetPoint( linePtIds[i], pt );
+        for (int j = 0; j < numPoints && localId < 0; j++)
+          {
+          if ( vtkMath::Distance2BetweenPoints( pt, x[j] ) <= tolerance2 )
+            {
+            localId = j;
+            }
+          }
+        if ( localId < 0 )
+          {
+          if ( numPoints >= maxPoints )
+            {
+            return NULL;
+            }
+          localId = numPoints;
+          x[numPoints][0] = pt[0];
+          x[numPoints][1] = pt[1];
+          x[numPoints][2] = pt[2];
+          numPoints++;
+          }
+        if ( numMapped >= 2*maxPoints )
+          {
+          return NULL;
+          }
+        mappedIds[numMapped] = linePtIds[i];
+        mappedLocalIds[numMapped] = localId;
+        numMapped++;
+        }
+      lines[numLines][i] = localId;
+      }
+    numLines++;
     }
 
-  // Copy the points from splitLines to the output, interpolating the
-  // data as we go.
-  for (vtkIdType id = 0; id < splitLines->GetNumberOfPoints(); id++)
+  // Now add the points that the lines of neighboring cells put on
+  // the edges of the cell.
+  for (vtkIdType i = 0; i < 3; i++)
     {
-    double pt[3];
-    splitLines->GetPoint(id, pt);
-    vtkIdType newPtId = output->GetPoints()->InsertNextPoint(pt);
+    vtkIdType edgePtId0 = cellPts[i];
+    vtkIdType edgePtId1 = cellPts[(i+1) % 3];
+    double *edgePt0 = x[i];
+    double *edgePt1 = x[(i+1) % 3];
+
+    // Same as GetCellEdgeNeighbors(), without the vtkIdList.
+    unsigned short nCells;
+    vtkIdType *edgeCells;
+    input->GetPointCells( edgePtId0, nCells, edgeCells );
+    for (unsigned short j = 0; j < nCells; j++)
+      {
+      vtkIdType nbrCellId = edgeCells[j];
+      if ( nbrCellId == cellId )
+        {
+        continue;
+        }
+      vtkIdType nNbrPts, *nbrPts;
+      input->GetCellPoints( nbrCellId, nNbrPts, nbrPts );
+      if ( std::find( nbrPts, nbrPts + nNbrPts, edgePtId1 ) == nbrPts + nNbrPts )
+        {
+        continue;
+        }
 
-    // Retrieve the cell ID from splitLines
-    vtkIdType cellId = this->PointCellIds[inputIndex]->GetValue( id );
+      vtkIdType numNbrLines = map->GetNumberOfValues( nbrCellId );
+      for (vtkIdType lineIdx = 0; lineIdx < numNbrLines; lineIdx++)
+        {
+        vtkIdType lineId = map->GetValues( nbrCellId )[lineIdx];
+        vtkIdType nLinePts, *linePtIds;
+        interLines->GetLines()->GetCell( 3*lineId, nLinePts, linePtIds );
+        for (vtkIdType k = 0; k < nLinePts; k++)
+          {
+          bool mapped = false;
+          for (int m = 0; m < numMapped && !mapped; m++)
+            {
+            mapped = mappedIds[m] == linePtIds[k];
+            }
+          if ( mapped )
+            {
+            continue;
+            }
 
-    double closestPt[3], pcoords[3], dist2, weights[3];
-    int subId;
-    vtkCell *cell = input->GetCell(cellId);
-    cell->EvaluatePosition(pt, closestPt, subId, pcoords, dist2, weights);
-    outPD->InterpolatePoint(input->GetPointData(), newPtId, cell->PointIds,
-                            weights);
+          double pt[3], t, closestPt[3];
+          interLines->GetPoint( linePtIds[k], pt );
+          double dist = vtkLine::DistanceToLine(pt, edgePt0, edgePt1, t,
+                                                closestPt);
+          if ( fabs(dist) < 1e-6 && t >= 0.0 && t <= 1.0 )
+            {
+            // Point is on edge. Add it as a point.
+            int localId = -1;
+            for (int m = 0; m < numPoints && localId < 0; m++)
+              {
+              if ( vtkMath::Distance2BetweenPoints( pt, x[m] ) <= tolerance2 )
+                {
+                localId = m;
+                }
+              }
+            if ( localId < 0 )
+              {
+              if ( numPoints >= maxPoints )
+                {
+                return NULL;
+                }
+              localId = numPoints;
+              x[numPoints][0] = pt[0];
+              x[numPoints][1] = pt[1];
+              x[numPoints][2] = pt[2];
+              numPoints++;
+              }
+            if ( numMapped >= 2*maxPoints )
+              {
+              return NULL;
+              }
+            mappedIds[numMapped] = linePtIds[k];
+            mappedLocalIds[numMapped] = localId;
+            numMapped++;
+            }
+          }
+        }
+      }
     }
 
-  vtkIdType numInputPts = input->GetNumberOfPoints();
-
-  ///////////////////////////////////////////////////////////////////////////
-  // Process cells
-  ///////////////////////////////////////////////////////////////////////////
-  outCD->CopyAllocate(inCD, numCells);
+  // Set up reverse ID map. If more than one point maps back to the
+  // same cell point, use the one with the smallest ID, as SplitCell()
+  // does.
+  vtkIdType reverseIds[maxPoints];
+  for (int i = 0; i < numPoints; i++)
+    {
+    reverseIds[i] = -1;
+    }
+  for (int i = 0; i < numMapped; i++)
+    {
+    vtkIdType &reverseId = reverseIds[mappedLocalIds[i]];
+    if ( reverseId < 0 || mappedIds[i] < reverseId )
+      {
+      reverseId = mappedIds[i];
+      }
+    }
 
-  if ( input->GetPolys()->GetNumberOfCells() > 0 )
+  // Set up the 2D frame of the cell and sort the points on the cell
+  // boundary by angle, as SplitCell() does.
+  double n[3], v0[3], v1[3], c[3];
+  vtkTriangle::TriangleCenter( x[0], x[1], x[2], c );
+  vtkTriangle::ComputeNormal( x[0], x[1], x[2], n );
+  if ( vtkMath::Norm( n ) == 0.0 )
     {
-    vtkCellArray *cells = input->GetPolys();
-    newId = output->GetNumberOfCells();
+    return NULL;
+    }
+  vtkMath::Perpendiculars( n, v0, v1, 0.0 );
 
-    vtkSmartPointer< vtkCellArray > newPolys =
-      vtkSmartPointer< vtkCellArray >::New();
+  vtkSmallPolygonTriangulator triangulator;
+  int edgeMask[maxPoints];
+  double angles[maxPoints];
+  int boundaryIds[maxPoints];
+  int numBoundary = 0;
+  for (int i = 0; i < numPoints; i++)
+    {
+    double d[3];
+    vtkMath::Subtract( x[i], c, d );
+    triangulator.InsertNextPoint( vtkMath::Dot(d, v0), vtkMath::Dot(d, v1) );
 
-    newPolys->EstimateSize(cells->GetNumberOfCells(),3);
-    output->SetPolys(newPolys);
+    // Record on which cell edges the point lies.
+    edgeMask[i] = 0;
+    for (int e = 0; e < 3; e++)
+      {
+      double t, closestPt[3];
+      double dist = vtkLine::DistanceToLine(x[i], x[e], x[(e+1) % 3], t,
+                                            closestPt);
+      if ( (i == e || i == (e+1) % 3) ||
+           (dist < 1e-6 && t >= 0.0 && t <= 1.0) )
+        {
+        edgeMask[i] |= 1 << e;
+        }
+      }
 
-    vtkSmartPointer< vtkIdList > edgeNeighbors =
-      vtkSmartPointer< vtkIdList >::New();
-    vtkIdType npts = 0;
-    vtkIdType *pts = 0;
-    vtkSmartPointer< vtkIdList > cellsToCheck =
-      vtkSmartPointer< vtkIdList >::New();
-    for (cells->InitTraversal(); cells->GetNextCell(npts, pts); cellId++)
+    if ( edgeMask[i] )
       {
-      if ( npts != 3 )
+      // Insertion sort keeps the boundary points ordered by angle.
+      double angle = atan2( vtkMath::Dot(d, v0), vtkMath::Dot(d, v1) );
+      int j = numBoundary++;
+      for ( ; j > 0 && angles[j-1] > angle; j--)
         {
-        vtkGenericWarningMacro( << "vtkIntersectionPolyDataFilter only works with "
-                                << "triangle meshes." );
-        continue;
+        angles[j] = angles[j-1];
+        boundaryIds[j] = boundaryIds[j-1];
         }
+      angles[j] = angle;
+      boundaryIds[j] = i;
+      }
+    }
 
-      cellsToCheck->Reset();
-      cellsToCheck->Allocate(npts+1);
-      cellsToCheck->InsertNextId(cellId);
+  for (int i = 0; i < numLines; i++)
+    {
+    if ( !triangulator.InsertConstraint( lines[i][0], lines[i][1] ) )
+      {
+      return NULL;
+      }
+    }
+  for (int i = 0; i < numBoundary; i++)
+    {
+    if ( !triangulator.InsertConstraint( boundaryIds[i],
+                                         boundaryIds[(i+1) % numBoundary] ) )
+      {
+      return NULL;
+      }
+    }
 
-      // Collect the cells relevant for splitting this cell.  If the
-      // cell is in the intersection map, split. If not, one of its
-      // edges may be split by an intersection line that splits a
-      // neighbor cell. Mark the cell as needing a split if this is
-      // the case.
-      bool needsSplit = intersectionMap->find( cellId ) != intersectionMap->end();
-      for (vtkIdType ptId = 0; ptId < npts; ptId++)
-        {
-        vtkIdType pt0Id = pts[ptId];
-        vtkIdType pt1Id = pts[(ptId+1) % npts];
-        edgeNeighbors->Reset();
-        input->GetCellEdgeNeighbors(cellId, pt0Id, pt1Id, edgeNeighbors);
-        for (vtkIdType nbr = 0; nbr < edgeNeighbors->GetNumberOfIds(); nbr++)
-          {
-          vtkIdType nbrId = edgeNeighbors->GetId(nbr);
-          cellsToCheck->InsertNextId(nbrId);
+  if ( !triangulator.Triangulate() )
+    {
+    return NULL;
+    }
 
-          if ( intersectionMap->find( nbrId ) != intersectionMap->end() )
-            {
-            needsSplit = true;
-            }
-          } // for (vtkIdType nbr = 0; ...
-        } // for (vtkIdType pt = 0; ...
+  vtkCellArray *splitCells = vtkCellArray::New();
+  splitCells->Allocate( 4*triangulator.NumberOfTriangles );
+  for (int i = 0; i < triangulator.NumberOfTriangles; i++)
+    {
+    const int *tri = triangulator.Triangles[i];
+
+    // Skip the degenerate triangles that connect points on the same
+    // cell edge.
+    if ( edgeMask[tri[0]] & edgeMask[tri[1]] & edgeMask[tri[2]] )
+      {
+      continue;
+      }
 
-      // Splitting occurs here
-      if ( !needsSplit )
+    splitCells->InsertNextCell( 3 );
+    for (int j = 0; j < 3; j++)
+      {
+      vtkIdType remappedPtId;
+      if ( tri[j] < 3 ) // Point from the cell
         {
-        // Just insert the cell and copy the cell data
-        newId = newPolys->InsertNextCell(3, pts);
-        outCD->CopyData(inCD, cellId, newId);
+        remappedPtId = cellPts[ tri[j] ];
         }
       else
         {
-        vtkCellArray *splitCells = this->SplitCell
-          (input, cellId, pts, intersectionMap, splitLines);
-
-        double pt0[3], pt1[3], pt2[3], normal[3];
-        points->GetPoint(pts[0], pt0);
-        points->GetPoint(pts[1], pt1);
-        points->GetPoint(pts[2], pt2);
-        vtkTriangle::ComputeNormal(pt0, pt1, pt2, normal);
-        vtkMath::Normalize(normal);
-
-        vtkIdType npts, *ptIds, subCellId = 0;
-        for (splitCells->InitTraversal(); splitCells->GetNextCell(npts, ptIds); subCellId++)
-          {
-          // Check for reversed cells. I'm not sure why, but in some
-          // cases, cells are reversed.
-          double subCellNormal[3];
-          points->GetPoint(ptIds[0], pt0);
-          points->GetPoint(ptIds[1], pt1);
-          points->GetPoint(ptIds[2], pt2);
-          vtkTriangle::ComputeNormal(pt0, pt1, pt2, subCellNormal);
-          vtkMath::Normalize(subCellNormal);
-
-          if ( vtkMath::Dot(normal, subCellNormal) > 0 )
-            {
-            newId = newPolys->InsertNextCell(npts, ptIds);
-            }
-          else
-            {
-            newId = newPolys->InsertNextCell(npts);
-            for ( int i = 0; i < npts; i++)
-              {
-              newPolys->InsertCellPoint( ptIds[ npts-i-1 ] );
-              }
-            }
-
-          outCD->CopyData(inCD, cellId, newId); // Duplicate cell data
-          }
-        splitCells->Delete();
+        remappedPtId = reverseIds[ tri[j] ] + input->GetNumberOfPoints();
         }
-      } // for (cells->InitTraversal(); ...
+      splitCells->InsertCellPoint( remappedPtId );
+      }
     }
 
-  return 1;
-}
+  if ( splitCells->GetNumberOfCells() == 0 )
+    {
+    splitCells->Delete();
+    return NULL;
+    }
 
+  return splitCells;
+}
 
 //----------------------------------------------------------------------------
 vtkCellArray* vtkIntersectionPolyDataFilter::Impl
 ::SplitCell(vtkPolyData *input, vtkIdType cellId, vtkIdType *cellPts,
             IntersectionMapType *map, vtkPolyData *interLines)
+{
+  // Most cut cells have only a few points. Triangulate those without
+  // setting up a vtkDelaunay2D pipeline.
+  vtkCellArray *splitCells = this->SplitSmallCell
+    (input, cellId, cellPts, map, interLines);
+  if ( splitCells )
+    {
+    return splitCells;
+    }
+
+  // The pipeline machinery and the garbage collector are not thread
+  // safe, so only one thread at a time may set up, run and destroy a
+  // vtkDelaunay2D pipeline.
+  this->DelaunayLock.Lock();
+  splitCells = this->SplitCellWithDelaunay
+    (input, cellId, cellPts, map, interLines);
+  this->DelaunayLock.Unlock();
+
+  return splitCells;
+}
+
+//----------------------------------------------------------------------------
+vtkCellArray* vtkIntersectionPolyDataFilter::Impl
+::SplitCellWithDelaunay(vtkPolyData *input, vtkIdType cellId,
+                        vtkIdType *cellPts, IntersectionMapType *map,
+                        vtkPolyData *interLines)
 {
   // Gather points from the cell
   vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
@@ -479,11 +3295,10 @@ vtkCellArray* vtkIntersectionPolyDataFilter::Impl
   // point IDs from the cell are not stored here.
   std::map< vtkIdType, vtkIdType > ptIdMap;
 
-  IntersectionMapIteratorType iterLower = map->lower_bound( cellId );
-  IntersectionMapIteratorType iterUpper = map->upper_bound( cellId );
-  while ( iterLower != iterUpper )
+  vtkIdType numLines = map->GetNumberOfValues( cellId );
+  for (vtkIdType lineIdx = 0; lineIdx < numLines; lineIdx++)
     {
-    vtkIdType lineId = iterLower->second;
+    vtkIdType lineId = map->GetValues( cellId )[lineIdx];
     vtkIdType nLinePts, *linePtIds;
     interLines->GetLines()->GetCell( 3*lineId, nLinePts, linePtIds );
     lines->InsertNextCell(2);
@@ -504,7 +3319,6 @@ vtkCellArray* vtkIntersectionPolyDataFilter::Impl
         lines->InsertCellPoint( location->second );
         }
       }
-    ++iterLower;
     }
 
   // Now check the neighbors of the cell
@@ -528,11 +3342,10 @@ vtkCellArray* vtkIntersectionPolyDataFilter::Impl
     for (vtkIdType j = 0; j < nbrCellIds->GetNumberOfIds(); j++)
       {
       vtkIdType nbrCellId = nbrCellIds->GetId( j );
-      iterLower = map->lower_bound( nbrCellId );
-      iterUpper = map->upper_bound( nbrCellId );
-      while ( iterLower != iterUpper )
+      vtkIdType numNbrLines = map->GetNumberOfValues( nbrCellId );
+      for (vtkIdType lineIdx = 0; lineIdx < numNbrLines; lineIdx++)
         {
-        vtkIdType lineId = iterLower->second;
+        vtkIdType lineId = map->GetValues( nbrCellId )[lineIdx];
         vtkIdType nLinePts, *linePtIds;
         interLines->GetLines()->GetCell( 3*lineId, nLinePts, linePtIds );
         for (vtkIdType k = 0; k < nLinePts; k++)
@@ -555,8 +3368,6 @@ vtkCellArray* vtkIntersectionPolyDataFilter::Impl
               }
             }
           }
-
-        ++iterLower;
         }
       }
     }
@@ -739,7 +3550,7 @@ vtkCellArray* vtkIntersectionPolyDataFilter::Impl
 }
 
 //----------------------------------------------------------------------------
-void vtkIntersectionPolyDataFilter::Impl
+bool vtkIntersectionPolyDataFilter::Impl
 ::AddToPointEdgeMap(int index, vtkIdType ptId, double x[3], vtkPolyData *mesh,
                     vtkIdType cellId, vtkIdType edgeId, vtkIdType lineId,
                     vtkIdType triPtIds[3])
@@ -748,24 +3559,11 @@ void vtkIntersectionPolyDataFilter::Impl
   vtkIdType edgePtId1 = triPtIds[(edgeId+1) % 3];
   double pt0[3], pt1[3];
 
-  mesh->GetPoint(edgePtId0, pt0);
-  mesh->GetPoint(edgePtId1, pt1);
-
-  // Check to see if this point-cell combo is already in the list
-  PointEdgeMapIteratorType iterLower =
-    this->PointEdgeMap[index]->lower_bound( ptId );
-  PointEdgeMapIteratorType iterUpper =
-    this->PointEdgeMap[index]->upper_bound( ptId );
-
-  while (iterLower != iterUpper)
-    {
-    if ( iterLower->second.CellId == cellId )
-      {
-      return;
-      }
-    ++iterLower;
-    }
-
+  mesh->GetPoint(edgePtId0, pt0);
+  mesh->GetPoint(edgePtId1, pt1);
+
+  // Entries for a point-cell combo that is already in the map are
+  // removed in BuildIntersectionMaps().
   double t, dist, closestPt[3];
   dist = vtkLine::DistanceToLine(x, pt0, pt1, t, closestPt);
   if (fabs(dist) < 1e-9 && t >= 0.0 && t <= 1.0)
@@ -774,8 +3572,10 @@ void vtkIntersectionPolyDataFilter::Impl
     cellEdgeLine.CellId = cellId;
     cellEdgeLine.EdgeId = edgeId;
     cellEdgeLine.LineId = lineId;
-    this->PointEdgeMap[index]->insert(std::make_pair(ptId, cellEdgeLine));
+    this->PointEdgeMap[index]->Append(ptId, cellEdgeLine);
+    return true;
     }
+  return false;
 }
 
 //----------------------------------------------------------------------------
@@ -784,6 +3584,10 @@ void vtkIntersectionPolyDataFilter::Impl
                          vtkPolyData *splitLines)
 {
   vtkIdType numOrigPts = splitLines->GetNumberOfPoints();
+  const PointEdgeMapType *pointEdgeMap = this->PointEdgeMap[inputIndex];
+
+  // Marks the entries of the current point that have been handled.
+  std::vector<char> removed;
 
   // This maps the points to a cell that contains them. It will be
   // used later for interpolating point data.
@@ -793,15 +3597,23 @@ void vtkIntersectionPolyDataFilter::Impl
     splitLines->GetPoint(ptId, pt);
 
     // Iterate over all edges to which this point belongs.
-    PointEdgeMapIteratorType iterLower =
-      this->PointEdgeMap[inputIndex]->lower_bound( ptId );
-    PointEdgeMapIteratorType iterUpper =
-      this->PointEdgeMap[inputIndex]->upper_bound( ptId );
+    vtkIdType numEntries = pointEdgeMap->GetNumberOfValues( ptId );
+    if ( numEntries == 0 )
+      {
+      continue;
+      }
+    const CellEdgeLineType *entries = pointEdgeMap->GetValues( ptId );
+    removed.assign( numEntries, 0 );
 
     bool firstSplit = true;
-    while (iterLower != iterUpper)
+    for (vtkIdType entry = 0; entry < numEntries; entry++)
       {
-      CellEdgeLineType cellEdgeLine = iterLower->second;
+      if ( removed[entry] )
+        {
+        continue;
+        }
+
+      CellEdgeLineType cellEdgeLine = entries[entry];
       vtkIdType cellId = cellEdgeLine.CellId;
       vtkIdType edgeId = cellEdgeLine.EdgeId;
       vtkIdType lineId = cellEdgeLine.LineId;
@@ -840,17 +3652,14 @@ void vtkIntersectionPolyDataFilter::Impl
       sourceMesh->GetCellEdgeNeighbors( cellId, edgePtIds[0], edgePtIds[1],
                                    nbrCellIds );
 
-      // Remove these cell IDs from the point-edge map.
-      PointEdgeMapIteratorType removalIterLower =
-        this->PointEdgeMap[inputIndex]->lower_bound( ptId );
-      PointEdgeMapIteratorType removalIterUpper =
-        this->PointEdgeMap[inputIndex]->upper_bound( ptId );
-      while ( removalIterLower != removalIterUpper )
+      // Remove these cell IDs from the point-edge map. Earlier entries
+      // have all been handled, and a cell is not its own neighbor.
+      for (vtkIdType other = entry + 1; other < numEntries; other++)
         {
-        vtkIdType candidateCellId = removalIterLower->second.CellId;
-        if ( nbrCellIds->IsId( candidateCellId ) >= 0 )
+        if ( !removed[other] &&
+             nbrCellIds->IsId( entries[other].CellId ) >= 0 )
           {
-          vtkIdType nbrLineId = removalIterLower->second.LineId;
+          vtkIdType nbrLineId = entries[other].LineId;
           splitLines->GetLines()->GetCell( 3*nbrLineId, nLinePts, linePtIds );
           newLinePtIds[0] = linePtIds[0];
           newLinePtIds[1] = linePtIds[1];
@@ -860,17 +3669,12 @@ void vtkIntersectionPolyDataFilter::Impl
 
           splitLines->GetLines()->ReplaceCell( 3*nbrLineId, nLinePts, newLinePtIds );
 
-          this->PointEdgeMap[inputIndex]->erase( removalIterLower++ );
-          }
-        else
-          {
-          ++removalIterLower;
+          removed[other] = 1;
           }
         }
 
-
-      // Remove this entry from the map.
-      this->PointEdgeMap[inputIndex]->erase( iterLower++ );
+      // Mark this entry as handled.
+      removed[entry] = 1;
       }
     }
 }
@@ -880,67 +3684,751 @@ vtkStandardNewMacro(vtkIntersectionPolyDataFilter);
 
 //----------------------------------------------------------------------------
 vtkIntersectionPolyDataFilter::vtkIntersectionPolyDataFilter()
-  : SplitFirstOutput(1), SplitSecondOutput(1)
+  : SplitFirstOutput(1), SplitSecondOutput(1), NumberOfThreads(1),
+    PrecomputeTrianglePlanes(0), TopologicalChaining(0), OutputPolylines(0),
+    ExactPredicates(0), IntersectCoplanarTriangles(0), CacheInputs(0),
+    Transform(NULL),
+    LocatorCache(NULL)
 {
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(3);
+
+  this->Caches = new InputCache[2];
+  this->FirstSplitPointId[0] = 0;
+  this->FirstSplitPointId[1] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIntersectionPolyDataFilter::~vtkIntersectionPolyDataFilter()
+{
+  this->SetTransform(NULL);
+  this->SetLocatorCache(NULL);
+  delete [] this->Caches;
+}
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkIntersectionPolyDataFilter, Transform,
+                     vtkLinearTransform);
+vtkCxxSetObjectMacro(vtkIntersectionPolyDataFilter, LocatorCache,
+                     vtkPolyDataLocatorCache);
+
+//----------------------------------------------------------------------------
+vtkIdType vtkIntersectionPolyDataFilter::GetFirstSplitPointId(int index)
+{
+  if ( index < 0 || index > 1 )
+    {
+    vtkErrorMacro(<< "Invalid output index " << index);
+    return 0;
+    }
+  return this->FirstSplitPointId[index];
+}
+
+//----------------------------------------------------------------------------
+// Creates the tree of a locator cache entry over a working mesh of
+// input, without building it. The tree keeps the working mesh alive.
+// Cells, links and bounds are built here so that filters sharing the
+// entry only read the mesh.
+static vtkIntersectionOBBTree* vtkIntersectionPolyDataFilterNewEntry(vtkPolyData *input)
+{
+  vtkPolyData *mesh = vtkPolyData::New();
+  mesh->ShallowCopy(input);
+  mesh->SetSource(NULL);
+  mesh->BuildLinks();
+  mesh->ComputeBounds();
+
+  vtkIntersectionOBBTree *tree = vtkIntersectionOBBTree::New();
+  tree->SetDataSet(mesh);
+  tree->SetNumberOfCellsPerNode(10);
+  tree->SetMaxLevel(1e6);
+  tree->SetTolerance(1e-6);
+  tree->AutomaticOn();
+  mesh->Delete();
+
+  return tree;
+}
+
+//----------------------------------------------------------------------------
+vtkObject* vtkIntersectionPolyDataFilter::BuildLocatorCacheEntry(vtkPolyData *input)
+{
+  vtkIntersectionOBBTree *tree = vtkIntersectionPolyDataFilterNewEntry(input);
+  tree->BuildLocator();
+
+  return tree;
+}
+
+//----------------------------------------------------------------------------
+// Snapshot file layout: magic, version, byte order mark, size of
+// vtkIdType, number of points and cells, fingerprint of the mesh, then
+// the tree nodes.
+static const char      vtkLocatorSnapshotMagic[8] = "VTKOBBT";
+static const int       vtkLocatorSnapshotVersion = 1;
+static const int       vtkLocatorSnapshotByteOrder = 0x01020304;
+
+//----------------------------------------------------------------------------
+// FNV-1a hash of the point coordinates and cell connectivity, so that
+// a snapshot is not applied to a mesh that only happens to have the
+// same number of points and cells.
+static void vtkLocatorSnapshotHash(vtkTypeUInt64 &hash, const void *data,
+                                   size_t size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++)
+    {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+    }
+}
+
+static vtkTypeUInt64 vtkLocatorSnapshotFingerprint(vtkPolyData *mesh)
+{
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+
+  double x[3];
+  for (vtkIdType ptId = 0; ptId < mesh->GetNumberOfPoints(); ptId++)
+    {
+    mesh->GetPoint(ptId, x);
+    vtkLocatorSnapshotHash(hash, x, sizeof(x));
+    }
+
+  vtkIdType npts, *pts;
+  for (vtkIdType cellId = 0; cellId < mesh->GetNumberOfCells(); cellId++)
+    {
+    mesh->GetCellPoints(cellId, npts, pts);
+    vtkLocatorSnapshotHash(hash, &npts, sizeof(npts));
+    vtkLocatorSnapshotHash(hash, pts, npts*sizeof(vtkIdType));
+    }
+
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::WriteLocatorSnapshot(vtkObject *entry,
+                                                        const char *fileName)
+{
+  vtkIntersectionOBBTree *tree = vtkIntersectionOBBTree::SafeDownCast(entry);
+  vtkPolyData *mesh =
+    tree ? vtkPolyData::SafeDownCast(tree->GetDataSet()) : NULL;
+  if ( mesh == NULL || tree->GetRoot() == NULL || fileName == NULL )
+    {
+    vtkGenericWarningMacro(<< "No locator cache entry to write");
+    return 0;
+    }
+
+  vtkLocatorSnapshotBuffer buffer;
+  buffer.Put(vtkLocatorSnapshotMagic);
+  buffer.Put(vtkLocatorSnapshotVersion);
+  buffer.Put(vtkLocatorSnapshotByteOrder);
+  buffer.Put(static_cast<int>(sizeof(vtkIdType)));
+  buffer.Put(mesh->GetNumberOfPoints());
+  buffer.Put(mesh->GetNumberOfCells());
+  buffer.Put(vtkLocatorSnapshotFingerprint(mesh));
+  tree->WriteNodes(buffer);
+
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  file.write(&buffer.Bytes[0], buffer.Bytes.size());
+  if ( !file )
+    {
+    vtkGenericWarningMacro(<< "Cannot write locator snapshot " << fileName);
+    return 0;
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+vtkObject* vtkIntersectionPolyDataFilter::ReadLocatorSnapshot(vtkPolyData *input,
+                                                              const char *fileName)
+{
+  if ( input == NULL || fileName == NULL )
+    {
+    return NULL;
+    }
+
+  // Read the whole file at once; the nodes are then decoded from memory.
+  std::ifstream file(fileName, std::ios::in | std::ios::binary);
+  if ( !file )
+    {
+    vtkGenericWarningMacro(<< "Cannot open locator snapshot " << fileName);
+    return NULL;
+    }
+  vtkLocatorSnapshotBuffer buffer;
+  file.seekg(0, std::ios::end);
+  buffer.Bytes.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0, std::ios::beg);
+  if ( buffer.Bytes.empty() || !file.read(&buffer.Bytes[0], buffer.Bytes.size()) )
+    {
+    vtkGenericWarningMacro(<< "Cannot read locator snapshot " << fileName);
+    return NULL;
+    }
+
+  vtkIntersectionOBBTree *tree = vtkIntersectionPolyDataFilterNewEntry(input);
+  vtkPolyData *mesh = vtkPolyData::SafeDownCast(tree->GetDataSet());
+
+  char magic[8];
+  int version, byteOrder, idTypeSize;
+  vtkIdType numPts, numCells;
+  vtkTypeUInt64 fingerprint;
+  bool valid =
+    buffer.Get(magic) && memcmp(magic, vtkLocatorSnapshotMagic, 8) == 0 &&
+    buffer.Get(version) && version == vtkLocatorSnapshotVersion &&
+    buffer.Get(byteOrder) && byteOrder == vtkLocatorSnapshotByteOrder &&
+    buffer.Get(idTypeSize) && idTypeSize == static_cast<int>(sizeof(vtkIdType));
+  if ( !valid )
+    {
+    vtkGenericWarningMacro(<< fileName << " is not a locator snapshot "
+                           << "written by this build");
+    tree->Delete();
+    return NULL;
+    }
+
+  valid =
+    buffer.Get(numPts) && numPts == mesh->GetNumberOfPoints() &&
+    buffer.Get(numCells) && numCells == mesh->GetNumberOfCells() &&
+    buffer.Get(fingerprint) &&
+    fingerprint == vtkLocatorSnapshotFingerprint(mesh);
+  if ( !valid )
+    {
+    vtkGenericWarningMacro(<< "Locator snapshot " << fileName
+                           << " was written for a different mesh");
+    tree->Delete();
+    return NULL;
+    }
+
+  if ( !tree->ReadNodes(buffer) || buffer.Position != buffer.Bytes.size() )
+    {
+    vtkGenericWarningMacro(<< "Locator snapshot " << fileName
+                           << " is corrupt");
+    tree->Delete();
+    return NULL;
+    }
+
+  return tree;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkIntersectionPolyDataFilter::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+
+  if ( this->Transform != NULL )
+    {
+    unsigned long transformMTime = this->Transform->GetMTime();
+    mTime = (transformMTime > mTime ? transformMTime : mTime);
+    }
+
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::UpdateInputCache(int index,
+                                                     vtkPolyData *input,
+                                                     bool buildLinks)
+{
+  InputCache &cache = this->Caches[index];
+  if ( this->LocatorCache != NULL )
+    {
+    vtkObject *entry = this->LocatorCache->AcquireEntry
+      (input, vtkIntersectionPolyDataFilter::BuildLocatorCacheEntry);
+    cache.Input    = input;
+    cache.MTime    = input->GetMTime();
+    cache.HasLinks = true;
+    cache.Tree.TakeReference(vtkIntersectionOBBTree::SafeDownCast(entry));
+    cache.Mesh     = vtkPolyData::SafeDownCast(cache.Tree->GetDataSet());
+    return;
+    }
+
+  if ( cache.Mesh == NULL || cache.Input != input ||
+       cache.MTime != input->GetMTime() )
+    {
+    // Set up new poly data for the input to build cells and links. The
+    // mesh shares the point and connectivity arrays of the input;
+    // BuildCells() and BuildLinks() replace the cell and link
+    // structures of the copy only, so the input is left untouched.
+    cache.Input    = input;
+    cache.MTime    = input->GetMTime();
+    cache.HasLinks = false;
+    cache.Mesh     = vtkSmartPointer< vtkPolyData >::New();
+    cache.Mesh->ShallowCopy(input);
+    cache.Mesh->SetSource(NULL);
+
+    cache.Tree = vtkSmartPointer< vtkIntersectionOBBTree >::New();
+    cache.Tree->SetDataSet(cache.Mesh);
+    cache.Tree->SetNumberOfCellsPerNode(10);
+    cache.Tree->SetMaxLevel(1e6);
+    cache.Tree->SetTolerance(1e-6);
+    cache.Tree->AutomaticOn();
+    cache.Tree->BuildLocator();
+    }
+
+  if ( buildLinks && !cache.HasLinks )
+    {
+    cache.Mesh->BuildLinks();
+    cache.HasLinks = true;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntersectionPolyDataFilter::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "SplitFirstOutput: " << this->SplitFirstOutput << endl;
+  os << indent << "SplitSecondOutput: " << this->SplitSecondOutput << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
+  os << indent << "PrecomputeTrianglePlanes: "
+     << this->PrecomputeTrianglePlanes << endl;
+  os << indent << "TopologicalChaining: " << this->TopologicalChaining << endl;
+  os << indent << "OutputPolylines: " << this->OutputPolylines << endl;
+  os << indent << "ExactPredicates: " << this->ExactPredicates << endl;
+  os << indent << "IntersectCoplanarTriangles: "
+     << this->IntersectCoplanarTriangles << endl;
+  os << indent << "CacheInputs: " << this->CacheInputs << endl;
+  os << indent << "Transform: " << this->Transform << endl;
+  os << indent << "LocatorCache: " << this->LocatorCache << endl;
+}
+
+//----------------------------------------------------------------------------
+// Fused multiply-adds are disabled from here to the end of the batched
+// triangle test. The expansion arithmetic relies on every product
+// being rounded before it is added, and the vector lanes of the
+// batched test must round like the scalar code.
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+# pragma GCC push_options
+# pragma GCC optimize ("fp-contract=off")
+#elif defined(_MSC_VER)
+# pragma fp_contract (off)
+#endif
+
+//----------------------------------------------------------------------------
+// Floating-point expansion arithmetic after J. R. Shewchuk, "Adaptive
+// Precision Floating-Point Arithmetic and Fast Robust Geometric
+// Predicates". An expansion is a sum of doubles stored in order of
+// increasing magnitude with no two of them overlapping, so that its
+// sign is the sign of its last non-zero component.
+typedef std::vector< double > vtkExactExpansion;
+
+static const double vtkExactEpsilon = 1.1102230246251565e-16; // 2^-53
+static const double vtkExactSplitter = 134217729.0;          // 2^27 + 1
+
+//----------------------------------------------------------------------------
+static inline void vtkExactTwoSum(double a, double b, double &x, double &y)
+{
+  x = a + b;
+  double bVirtual = x - a;
+  double aVirtual = x - bVirtual;
+  y = (a - aVirtual) + (b - bVirtual);
+}
+
+//----------------------------------------------------------------------------
+static inline void vtkExactSplit(double a, double &high, double &low)
+{
+  double c = vtkExactSplitter * a;
+  high = c - (c - a);
+  low = a - high;
+}
+
+//----------------------------------------------------------------------------
+static inline void vtkExactTwoProduct(double a, double b, double &x, double &y)
+{
+  x = a * b;
+  double aHigh, aLow, bHigh, bLow;
+  vtkExactSplit(a, aHigh, aLow);
+  vtkExactSplit(b, bHigh, bLow);
+  y = aLow * bLow - (((x - aHigh * bHigh) - aLow * bHigh) - aHigh * bLow);
+}
+
+//----------------------------------------------------------------------------
+// Returns the exact difference a - b.
+static vtkExactExpansion vtkExactDifference(double a, double b)
+{
+  vtkExactExpansion e(2);
+  vtkExactTwoSum(a, -b, e[1], e[0]);
+  return e;
+}
+
+//----------------------------------------------------------------------------
+// Returns e + f, dropping zero components.
+static vtkExactExpansion vtkExactSum(const vtkExactExpansion &e,
+                                     const vtkExactExpansion &f)
+{
+  vtkExactExpansion h(e);
+  for (size_t i = 0; i < f.size(); i++)
+    {
+    double q = f[i];
+    vtkExactExpansion g;
+    for (size_t j = 0; j < h.size(); j++)
+      {
+      double sum, err;
+      vtkExactTwoSum(q, h[j], sum, err);
+      if (err != 0.0)
+        {
+        g.push_back(err);
+        }
+      q = sum;
+      }
+    if (q != 0.0)
+      {
+      g.push_back(q);
+      }
+    h.swap(g);
+    }
+  return h;
+}
+
+//----------------------------------------------------------------------------
+// Returns e * b, dropping zero components.
+static vtkExactExpansion vtkExactScale(const vtkExactExpansion &e, double b)
+{
+  vtkExactExpansion h;
+  if (e.empty())
+    {
+    return h;
+    }
+
+  double q, err;
+  vtkExactTwoProduct(e[0], b, q, err);
+  if (err != 0.0)
+    {
+    h.push_back(err);
+    }
+  for (size_t i = 1; i < e.size(); i++)
+    {
+    double product, productErr, sum;
+    vtkExactTwoProduct(e[i], b, product, productErr);
+    vtkExactTwoSum(q, productErr, sum, err);
+    if (err != 0.0)
+      {
+      h.push_back(err);
+      }
+    vtkExactTwoSum(product, sum, q, err);
+    if (err != 0.0)
+      {
+      h.push_back(err);
+      }
+    }
+  if (q != 0.0)
+    {
+    h.push_back(q);
+    }
+  return h;
+}
+
+//----------------------------------------------------------------------------
+static vtkExactExpansion vtkExactProduct(const vtkExactExpansion &e,
+                                         const vtkExactExpansion &f)
+{
+  vtkExactExpansion h;
+  for (size_t i = 0; i < f.size(); i++)
+    {
+    h = vtkExactSum(h, vtkExactScale(e, f[i]));
+    }
+  return h;
+}
+
+//----------------------------------------------------------------------------
+// Returns a value whose sign is the sign of the determinant
+//
+//   | a - d |
+//   | b - d |
+//   | c - d |
+//
+// which is positive if d lies below the plane through a, b and c,
+// oriented so that they appear counterclockwise from above. The
+// determinant is evaluated in floating point and recomputed exactly
+// only if it is smaller than the error bound of the evaluation.
+static double vtkExactOrient3D(const double a[3], const double b[3],
+                               const double c[3], const double d[3])
+{
+  double adx = a[0] - d[0], ady = a[1] - d[1], adz = a[2] - d[2];
+  double bdx = b[0] - d[0], bdy = b[1] - d[1], bdz = b[2] - d[2];
+  double cdx = c[0] - d[0], cdy = c[1] - d[1], cdz = c[2] - d[2];
+
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+  double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) +
+    cdz * (adxbdy - bdxady);
+  double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * fabs(adz) +
+    (fabs(cdxady) + fabs(adxcdy)) * fabs(bdz) +
+    (fabs(adxbdy) + fabs(bdxady)) * fabs(cdz);
+  double errorBound = (7.0 + 56.0 * vtkExactEpsilon) * vtkExactEpsilon *
+    permanent;
+  if (det > errorBound || -det > errorBound)
+    {
+    return det;
+    }
+
+  // The differences are not exact in floating point, so the exact
+  // evaluation starts from the coordinates.
+  vtkExactExpansion dx[3], dy[3], dz[3];
+  const double *pts[3] = {a, b, c};
+  for (int i = 0; i < 3; i++)
+    {
+    dx[i] = vtkExactDifference(pts[i][0], d[0]);
+    dy[i] = vtkExactDifference(pts[i][1], d[1]);
+    dz[i] = vtkExactDifference(pts[i][2], d[2]);
+    }
+
+  vtkExactExpansion exact;
+  for (int i = 0; i < 3; i++)
+    {
+    int j = (i + 1) % 3, k = (i + 2) % 3;
+    vtkExactExpansion minor =
+      vtkExactSum(vtkExactProduct(dx[j], dy[k]),
+                  vtkExactScale(vtkExactProduct(dx[k], dy[j]), -1.0));
+    exact = vtkExactSum(exact, vtkExactProduct(dz[i], minor));
+    }
+
+  if (exact.empty())
+    {
+    return 0.0;
+    }
+  // Keep the magnitude of the estimate, which the callers use to
+  // interpolate, and only correct its sign.
+  double sign = exact.back() > 0.0 ? 1.0 : -1.0;
+  return det * sign > 0.0 ? det : sign * std::max(fabs(det), VTK_DBL_MIN);
+}
+
+//----------------------------------------------------------------------------
+// Collects the points where the triangle tri crosses the plane whose
+// orientation tests gave the values dist for the vertices of tri. The
+// signs of dist are exact, so exactly two points are found unless all
+// the vertices are on the same side. Edge crossings are interpolated
+// and store edgeOffset plus the index of the edge in edges, vertices
+// on the plane store -1.
+static int vtkExactTrianglePlaneCrossings(double *tri[3], const double dist[3],
+                                          int edgeOffset, double x[2][3],
+                                          int edges[2])
+{
+  int numCrossings = 0;
+  for (int i = 0; i < 3 && numCrossings < 2; i++)
+    {
+    int j = (i + 1) % 3;
+    if (dist[i] == 0.0)
+      {
+      std::copy(tri[i], tri[i] + 3, x[numCrossings]);
+      edges[numCrossings++] = -1;
+      }
+    else if ((dist[i] > 0.0 && dist[j] < 0.0) ||
+             (dist[i] < 0.0 && dist[j] > 0.0))
+      {
+      double t = dist[i] / (dist[i] - dist[j]);
+      t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+      for (int k = 0; k < 3; k++)
+        {
+        x[numCrossings][k] = tri[i][k] + t * (tri[j][k] - tri[i][k]);
+        }
+      edges[numCrossings++] = edgeOffset + i;
+      }
+    }
+
+  // A single vertex touching the plane.
+  if (numCrossings == 1)
+    {
+    std::copy(x[0], x[0] + 3, x[1]);
+    edges[1] = edges[0];
+    numCrossings = 2;
+    }
+  return numCrossings;
+}
+
+//----------------------------------------------------------------------------
+// Same as vtkTriangleTriangleIntersectionEdges(), but decides on which
+// side of each other's plane the vertices of the triangles lie with
+// exact orientation tests, so that the result is consistent for
+// nearly degenerate pairs and never NaN. The endpoints are computed
+// in floating point.
+static int vtkTriangleTriangleIntersectionExact(double p1[3], double q1[3],
+                                                double r1[3], double p2[3],
+                                                double q2[3], double r2[3],
+                                                int &coplanar, double pt1[3],
+                                                double pt2[3], int *edges)
+{
+  double *tri1[3] = {p1, q1, r1}, *tri2[3] = {p2, q2, r2};
+  coplanar = 0;
+
+  double dist1[3], dist2[3];
+  for (int i = 0; i < 3; i++)
+    {
+    dist1[i] = vtkExactOrient3D(p2, q2, r2, tri1[i]);
+    }
+  if ((dist1[0] > 0.0 && dist1[1] > 0.0 && dist1[2] > 0.0) ||
+      (dist1[0] < 0.0 && dist1[1] < 0.0 && dist1[2] < 0.0))
+    {
+    return 0;
+    }
+  if (dist1[0] == 0.0 && dist1[1] == 0.0 && dist1[2] == 0.0)
+    {
+    coplanar = 1;
+    return 0;
+    }
+
+  for (int i = 0; i < 3; i++)
+    {
+    dist2[i] = vtkExactOrient3D(p1, q1, r1, tri2[i]);
+    }
+  if ((dist2[0] > 0.0 && dist2[1] > 0.0 && dist2[2] > 0.0) ||
+      (dist2[0] < 0.0 && dist2[1] < 0.0 && dist2[2] < 0.0))
+    {
+    return 0;
+    }
+
+  // Both triangles cross the line where the two planes meet.
+  double x1[2][3], x2[2][3];
+  int e1[2], e2[2];
+  vtkExactTrianglePlaneCrossings(tri1, dist1, 0, x1, e1);
+  vtkExactTrianglePlaneCrossings(tri2, dist2, 3, x2, e2);
+
+  // Order the crossings along the coordinate axis closest to the
+  // direction of that line.
+  double u1[3], v1[3], u2[3], v2[3], n1[3], n2[3], dir[3];
+  for (int k = 0; k < 3; k++)
+    {
+    u1[k] = q1[k] - p1[k]; v1[k] = r1[k] - p1[k];
+    u2[k] = q2[k] - p2[k]; v2[k] = r2[k] - p2[k];
+    }
+  vtkMath::Cross(u1, v1, n1);
+  vtkMath::Cross(u2, v2, n2);
+  vtkMath::Cross(n1, n2, dir);
+  int axis = 0;
+  for (int k = 1; k < 3; k++)
+    {
+    if (fabs(dir[k]) > fabs(dir[axis]))
+      {
+      axis = k;
+      }
+    }
+  if (dir[axis] == 0.0)
+    {
+    // Nearly parallel planes. Use the axis of largest spread.
+    for (int k = 0; k < 3; k++)
+      {
+      dir[k] = fabs(x1[1][k] - x1[0][k]) + fabs(x2[1][k] - x2[0][k]);
+      if (dir[k] > dir[axis])
+        {
+        axis = k;
+        }
+      }
+    }
+
+  if (x1[0][axis] > x1[1][axis])
+    {
+    std::swap_ranges(x1[0], x1[0] + 3, x1[1]);
+    std::swap(e1[0], e1[1]);
+    }
+  if (x2[0][axis] > x2[1][axis])
+    {
+    std::swap_ranges(x2[0], x2[0] + 3, x2[1]);
+    std::swap(e2[0], e2[1]);
+    }
+
+  double a0 = x1[0][axis], a1 = x1[1][axis];
+  double b0 = x2[0][axis], b1 = x2[1][axis];
+  if (a1 < b0 || b1 < a0)
+    {
+    return 0;
+    }
+
+  // The later start and the earlier end of the two intervals. Ends
+  // shared by both lie on an edge of both triangles.
+  const double *start = a0 < b0 ? x2[0] : x1[0];
+  const double *end   = a1 < b1 ? x1[1] : x2[1];
+  int startEdge = a0 < b0 ? e2[0] : (a0 == b0 ? -1 : e1[0]);
+  int endEdge   = a1 < b1 ? e1[1] : (a1 == b1 ? -1 : e2[1]);
+
+  std::copy(start, start + 3, pt1);
+  std::copy(end, end + 3, pt2);
+  if (edges)
+    {
+    edges[0] = startEdge;
+    edges[1] = endEdge;
+    }
+  return 1;
 }
 
 //----------------------------------------------------------------------------
-vtkIntersectionPolyDataFilter::~vtkIntersectionPolyDataFilter()
+// Same arithmetic, in the same order, as vtkTriangle::ComputeNormal()
+// and vtkMath::Dot(), but compiled here so that it rounds like the
+// vector lanes.
+static void vtkIntersectionTrianglePlane(const double p[3], const double q[3],
+                                         const double r[3], double plane[4])
 {
+  double a[3], b[3];
+  for (int i = 0; i < 3; i++)
+    {
+    a[i] = r[i] - q[i];
+    b[i] = p[i] - q[i];
+    }
+  plane[0] = a[1]*b[2] - a[2]*b[1];
+  plane[1] = a[2]*b[0] - a[0]*b[2];
+  plane[2] = a[0]*b[1] - a[1]*b[0];
+
+  double length = sqrt(plane[0]*plane[0] + plane[1]*plane[1] +
+                       plane[2]*plane[2]);
+  if (length != 0.0)
+    {
+    plane[0] /= length;
+    plane[1] /= length;
+    plane[2] /= length;
+    }
+  plane[3] = -(plane[0]*p[0] + plane[1]*p[1] + plane[2]*p[2]);
 }
 
 //----------------------------------------------------------------------------
-void vtkIntersectionPolyDataFilter::PrintSelf(ostream &os, vtkIndent indent)
+int vtkIntersectionPolyDataFilter
+::TriangleTriangleIntersection(double p1[3], double q1[3], double r1[3],
+                               double p2[3], double q2[3], double r2[3],
+                               int &coplanar, double pt1[3], double pt2[3])
 {
-  this->Superclass::PrintSelf(os,indent);
+  double plane1[4], plane2[4];
 
-  os << indent << "SplitFirstOutput: " << this->SplitFirstOutput << endl;
-  os << indent << "SplitSecondOutput: " << this->SplitSecondOutput << endl;
+  // Compute supporting planes.
+  vtkIntersectionTrianglePlane(p1, q1, r1, plane1);
+  vtkIntersectionTrianglePlane(p2, q2, r2, plane2);
+
+  return vtkIntersectionPolyDataFilter::TriangleTriangleIntersection
+    (p1, q1, r1, plane1, plane1[3], p2, q2, r2, plane2, plane2[3],
+     coplanar, pt1, pt2);
 }
 
 //----------------------------------------------------------------------------
 int vtkIntersectionPolyDataFilter
 ::TriangleTriangleIntersection(double p1[3], double q1[3], double r1[3],
+                               double n1[3], double s1,
                                double p2[3], double q2[3], double r2[3],
+                               double n2[3], double s2,
                                int &coplanar, double pt1[3], double pt2[3])
 {
-  double n1[3], n2[3], d1, d2;
-
-  // Compute supporting plane normals.
-  vtkTriangle::ComputeNormal(p1, q1, r1, n1);
-  vtkTriangle::ComputeNormal(p2, q2, r2, n2);
-  double s1 = -vtkMath::Dot(n1, p1);
-  double s2 = -vtkMath::Dot(n2, p2);
-
-  // Compute signed distances of points p1, q1, r1 from supporting
-  // plane of second triangle.
-  double dist1[3];
-  dist1[0] = vtkMath::Dot(n2, p1) + s2;
-  dist1[1] = vtkMath::Dot(n2, q1) + s2;
-  dist1[2] = vtkMath::Dot(n2, r1) + s2;
-
-  // If signs of all points are the same, all the points lie on the
-  // same side of the supporting plane, and we can exit early.
-  if ((dist1[0]*dist1[1] > 0.0) && (dist1[0]*dist1[2] > 0.0)) return 0;
-
-  // Do the same for p2, q2, r2 and supporting plane of first
-  // triangle.
-  double dist2[3];
-  dist2[0] = vtkMath::Dot(n1, p2) + s1;
-  dist2[1] = vtkMath::Dot(n1, q2) + s1;
-  dist2[2] = vtkMath::Dot(n1, r2) + s1;
-
-  // If signs of all points are the same, all the points lie on the
-  // same side of the supporting plane, and we can exit early.
-  if ((dist2[0]*dist2[1] > 0.0) && (dist2[0]*dist2[2] > 0.0)) return 0;
+  return vtkTriangleTriangleIntersectionEdges(p1, q1, r1, n1, s1,
+                                              p2, q2, r2, n2, s2,
+                                              coplanar, pt1, pt2, NULL);
+}
 
-  // Check for coplanarity of the supporting planes.
-  if ( fabs( n1[0] - n2[0] ) < 1e-9 &&
-       fabs( n1[1] - n2[1] ) < 1e-9 &&
-       fabs( n1[2] - n2[2] ) < 1e-9 &&
-       fabs( s1 - s2 ) < 1e-9 )
+//----------------------------------------------------------------------------
+// Second half of vtkTriangleTriangleIntersectionEdges(), for triangles
+// that the plane-side tests did not reject.
+static int vtkTriangleTriangleIntersectionSegment(double p1[3], double q1[3],
+                                                  double r1[3], double n1[3],
+                                                  double s1, double p2[3],
+                                                  double q2[3], double r2[3],
+                                                  double n2[3], double s2,
+                                                  int &coplanar,
+                                                  double pt1[3],
+                                                  double pt2[3], int *edges)
+{
+  // Check for coplanarity of the supporting planes, which may face
+  // either way.
+  if ( ( fabs( n1[0] - n2[0] ) < 1e-9 &&
+         fabs( n1[1] - n2[1] ) < 1e-9 &&
+         fabs( n1[2] - n2[2] ) < 1e-9 &&
+         fabs( s1 - s2 ) < 1e-9 ) ||
+       ( fabs( n1[0] + n2[0] ) < 1e-9 &&
+         fabs( n1[1] + n2[1] ) < 1e-9 &&
+         fabs( n1[2] + n2[2] ) < 1e-9 &&
+         fabs( s1 + s2 ) < 1e-9 ) )
     {
     coplanar = 1;
     return 0;
@@ -963,8 +4451,11 @@ int vtkIntersectionPolyDataFilter
   vtkMath::Cross(n1, n2, v);
   vtkMath::Normalize( v );
 
+  // The edge that produced each t coordinate, or -1 if the crossing
+  // is at a vertex of the edge.
   int index1 = 0, index2 = 0, index = 0;
-  double t1[2], t2[2];
+  double t1[3], t2[3];
+  int e1[3], e2[3];
   for (int i = 0; i < 3; i++)
     {
     double t, x[3], d[3];
@@ -973,11 +4464,13 @@ int vtkIntersectionPolyDataFilter
     // Find t coordinate on line of intersection between two planes.
     if (vtkPlane::IntersectWithLine( pts1[id1], pts1[id2], n2, p2, t, x ))
       {
+      e1[index1] = ( t > 0.0 && t < 1.0 ) ? i : -1;
       t1[index1++] = vtkMath::Dot(x, v) - vtkMath::Dot(p, v);
       }
 
     if (vtkPlane::IntersectWithLine( pts2[id1], pts2[id2], n1, p1, t, x ))
       {
+      e2[index2] = ( t > 0.0 && t < 1.0 ) ? 3 + i : -1;
       t2[index2++] = vtkMath::Dot(x, v) - vtkMath::Dot(p, v);
       }
     }
@@ -996,11 +4489,22 @@ int vtkIntersectionPolyDataFilter
     return 0;
     }
 
-  if ( t1[0] > t1[1] ) std::swap( t1[0], t1[1] );
-  if ( t2[0] > t2[1] ) std::swap( t2[0], t2[1] );
+  if ( t1[0] > t1[1] )
+    {
+    std::swap( t1[0], t1[1] );
+    std::swap( e1[0], e1[1] );
+    }
+  if ( t2[0] > t2[1] )
+    {
+    std::swap( t2[0], t2[1] );
+    std::swap( e2[0], e2[1] );
+    }
 
-  // Handle the different interval configuration cases.
+  // Handle the different interval configuration cases. An endpoint
+  // where the two intervals end together lies on an edge of both
+  // triangles.
   double tt1, tt2;
+  int edge1, edge2;
   if ( t1[1] < t2[0] || t2[1] < t1[0] )
     {
     return 0; // No overlap
@@ -1011,11 +4515,15 @@ int vtkIntersectionPolyDataFilter
       {
       tt1 = t2[0];
       tt2 = t1[1];
+      edge1 = e2[0];
+      edge2 = e1[1];
       }
     else
       {
       tt1 = t2[0];
       tt2 = t2[1];
+      edge1 = e2[0];
+      edge2 = t1[1] == t2[1] ? -1 : e2[1];
       }
     }
   else // t1[0] >= t2[0]
@@ -1024,14 +4532,24 @@ int vtkIntersectionPolyDataFilter
       {
       tt1 = t1[0];
       tt2 = t1[1];
+      edge1 = t1[0] == t2[0] ? -1 : e1[0];
+      edge2 = e1[1];
       }
     else
       {
       tt1 = t1[0];
       tt2 = t2[1];
+      edge1 = t1[0] == t2[0] ? -1 : e1[0];
+      edge2 = t1[1] == t2[1] ? -1 : e2[1];
       }
     }
 
+  if ( edges )
+    {
+    edges[0] = edge1;
+    edges[1] = edge2;
+    }
+
   // Create actual intersection points.
   pt1[0] = p[0] + tt1*v[0];
   pt1[1] = p[1] + tt1*v[1];
@@ -1044,6 +4562,312 @@ int vtkIntersectionPolyDataFilter
   return 1;
 }
 
+//----------------------------------------------------------------------------
+static int vtkTriangleTriangleIntersectionEdges(double p1[3], double q1[3],
+                                                double r1[3], double n1[3],
+                                                double s1, double p2[3],
+                                                double q2[3], double r2[3],
+                                                double n2[3], double s2,
+                                                int &coplanar, double pt1[3],
+                                                double pt2[3], int *edges)
+{
+  // Compute signed distances of points p1, q1, r1 from supporting
+  // plane of second triangle.
+  double dist1[3];
+  dist1[0] = vtkMath::Dot(n2, p1) + s2;
+  dist1[1] = vtkMath::Dot(n2, q1) + s2;
+  dist1[2] = vtkMath::Dot(n2, r1) + s2;
+
+  // If signs of all points are the same, all the points lie on the
+  // same side of the supporting plane, and we can exit early.
+  if ((dist1[0]*dist1[1] > 0.0) && (dist1[0]*dist1[2] > 0.0)) return 0;
+
+  // Do the same for p2, q2, r2 and supporting plane of first
+  // triangle.
+  double dist2[3];
+  dist2[0] = vtkMath::Dot(n1, p2) + s1;
+  dist2[1] = vtkMath::Dot(n1, q2) + s1;
+  dist2[2] = vtkMath::Dot(n1, r2) + s1;
+
+  // If signs of all points are the same, all the points lie on the
+  // same side of the supporting plane, and we can exit early.
+  if ((dist2[0]*dist2[1] > 0.0) && (dist2[0]*dist2[2] > 0.0)) return 0;
+
+  return vtkTriangleTriangleIntersectionSegment(p1, q1, r1, n1, s1,
+                                                p2, q2, r2, n2, s2,
+                                                coplanar, pt1, pt2, edges);
+}
+
+//----------------------------------------------------------------------------
+// Lane helpers for the batched plane-side tests. The arithmetic is
+// done in the same order as vtkIntersectionTrianglePlane() and
+// vtkMath::Dot, so the vector lanes give bit-identical results to
+// the scalar TriangleTriangleIntersection.
+#if defined(__AVX__)
+typedef __m256d vtkBatchVector;
+#define VTK_BATCH_LANES 4
+static inline vtkBatchVector vtkBatchLoad(const double *x) { return _mm256_loadu_pd(x); }
+static inline void vtkBatchStore(double *x, vtkBatchVector a) { _mm256_storeu_pd(x, a); }
+static inline vtkBatchVector vtkBatchSet(double x) { return _mm256_set1_pd(x); }
+static inline vtkBatchVector vtkBatchAdd(vtkBatchVector a, vtkBatchVector b) { return _mm256_add_pd(a, b); }
+static inline vtkBatchVector vtkBatchSub(vtkBatchVector a, vtkBatchVector b) { return _mm256_sub_pd(a, b); }
+static inline vtkBatchVector vtkBatchMul(vtkBatchVector a, vtkBatchVector b) { return _mm256_mul_pd(a, b); }
+static inline vtkBatchVector vtkBatchDiv(vtkBatchVector a, vtkBatchVector b) { return _mm256_div_pd(a, b); }
+static inline vtkBatchVector vtkBatchSqrt(vtkBatchVector a) { return _mm256_sqrt_pd(a); }
+static inline vtkBatchVector vtkBatchAnd(vtkBatchVector a, vtkBatchVector b) { return _mm256_and_pd(a, b); }
+static inline vtkBatchVector vtkBatchOr(vtkBatchVector a, vtkBatchVector b) { return _mm256_or_pd(a, b); }
+static inline vtkBatchVector vtkBatchAndNot(vtkBatchVector a, vtkBatchVector b) { return _mm256_andnot_pd(a, b); }
+static inline vtkBatchVector vtkBatchGreater(vtkBatchVector a, vtkBatchVector b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+static inline vtkBatchVector vtkBatchNotEqual(vtkBatchVector a, vtkBatchVector b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+static inline int vtkBatchMask(vtkBatchVector a) { return _mm256_movemask_pd(a); }
+#elif defined(__SSE2__)
+typedef __m128d vtkBatchVector;
+#define VTK_BATCH_LANES 2
+static inline vtkBatchVector vtkBatchLoad(const double *x) { return _mm_loadu_pd(x); }
+static inline void vtkBatchStore(double *x, vtkBatchVector a) { _mm_storeu_pd(x, a); }
+static inline vtkBatchVector vtkBatchSet(double x) { return _mm_set1_pd(x); }
+static inline vtkBatchVector vtkBatchAdd(vtkBatchVector a, vtkBatchVector b) { return _mm_add_pd(a, b); }
+static inline vtkBatchVector vtkBatchSub(vtkBatchVector a, vtkBatchVector b) { return _mm_sub_pd(a, b); }
+static inline vtkBatchVector vtkBatchMul(vtkBatchVector a, vtkBatchVector b) { return _mm_mul_pd(a, b); }
+static inline vtkBatchVector vtkBatchDiv(vtkBatchVector a, vtkBatchVector b) { return _mm_div_pd(a, b); }
+static inline vtkBatchVector vtkBatchSqrt(vtkBatchVector a) { return _mm_sqrt_pd(a); }
+static inline vtkBatchVector vtkBatchAnd(vtkBatchVector a, vtkBatchVector b) { return _mm_and_pd(a, b); }
+static inline vtkBatchVector vtkBatchOr(vtkBatchVector a, vtkBatchVector b) { return _mm_or_pd(a, b); }
+static inline vtkBatchVector vtkBatchAndNot(vtkBatchVector a, vtkBatchVector b) { return _mm_andnot_pd(a, b); }
+static inline vtkBatchVector vtkBatchGreater(vtkBatchVector a, vtkBatchVector b) { return _mm_cmpgt_pd(a, b); }
+static inline vtkBatchVector vtkBatchNotEqual(vtkBatchVector a, vtkBatchVector b) { return _mm_cmpneq_pd(a, b); }
+static inline int vtkBatchMask(vtkBatchVector a) { return _mm_movemask_pd(a); }
+#endif
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter
+::TriangleTriangleIntersectionBatch(double p1[3], double q1[3], double r1[3],
+                                    int numCandidates, double *candidatePts,
+                                    int *intersects, int *coplanar,
+                                    double *pts1, double *pts2)
+{
+  return vtkTriangleTriangleIntersectionBatchEdges(p1, q1, r1, NULL,
+                                                   numCandidates,
+                                                   candidatePts, NULL,
+                                                   intersects, coplanar,
+                                                   pts1, pts2, NULL);
+}
+
+//----------------------------------------------------------------------------
+// Same as TriangleTriangleIntersectionBatch(). plane1 is the plane of
+// the first triangle and candidatePlanes holds the planes of the
+// candidates in the layout of candidatePts, with normal component k
+// at candidatePlanes[k*numCandidates + i] and the offset at k = 3.
+// Either may be NULL, in which case the planes are computed.
+static int vtkTriangleTriangleIntersectionBatchEdges(double p1[3], double q1[3],
+                                                     double r1[3],
+                                                     double *plane1,
+                                                     int numCandidates,
+                                                     double *candidatePts,
+                                                     double *candidatePlanes,
+                                                     int *intersects,
+                                                     int *coplanar,
+                                                     double *pts1,
+                                                     double *pts2,
+                                                     int *edges)
+{
+  double *tri1[3] = {p1, q1, r1};
+  double n1[3], s1;
+  if (plane1)
+    {
+    n1[0] = plane1[0];
+    n1[1] = plane1[1];
+    n1[2] = plane1[2];
+    s1 = plane1[3];
+    }
+  else
+    {
+    double plane[4];
+    vtkIntersectionTrianglePlane(p1, q1, r1, plane);
+    n1[0] = plane[0];
+    n1[1] = plane[1];
+    n1[2] = plane[2];
+    s1 = plane[3];
+    }
+
+  for (int i = 0; i < numCandidates; i++)
+    {
+    intersects[i] = 0;
+    coplanar[i] = 0;
+    }
+
+  int numIntersections = 0;
+  int i = 0;
+#ifdef VTK_BATCH_LANES
+  // The vector loop runs the plane-side tests on as many candidates as
+  // fit in full lanes. The candidates that survive go on to the rest
+  // of the test with the planes computed in the lanes.
+  double *c[9];
+  for (int k = 0; k < 9; k++)
+    {
+    c[k] = candidatePts + k*numCandidates;
+    }
+
+  vtkBatchVector zero = vtkBatchSet(0.0);
+  vtkBatchVector one  = vtkBatchSet(1.0);
+  vtkBatchVector n1x = vtkBatchSet(n1[0]);
+  vtkBatchVector n1y = vtkBatchSet(n1[1]);
+  vtkBatchVector n1z = vtkBatchSet(n1[2]);
+  vtkBatchVector vs1 = vtkBatchSet(s1);
+
+  for ( ; i + VTK_BATCH_LANES <= numCandidates; i += VTK_BATCH_LANES)
+    {
+    vtkBatchVector px = vtkBatchLoad(c[0] + i);
+    vtkBatchVector py = vtkBatchLoad(c[1] + i);
+    vtkBatchVector pz = vtkBatchLoad(c[2] + i);
+    vtkBatchVector qx = vtkBatchLoad(c[3] + i);
+    vtkBatchVector qy = vtkBatchLoad(c[4] + i);
+    vtkBatchVector qz = vtkBatchLoad(c[5] + i);
+    vtkBatchVector rx = vtkBatchLoad(c[6] + i);
+    vtkBatchVector ry = vtkBatchLoad(c[7] + i);
+    vtkBatchVector rz = vtkBatchLoad(c[8] + i);
+
+    vtkBatchVector n2x, n2y, n2z, s2;
+    if (candidatePlanes)
+      {
+      n2x = vtkBatchLoad(candidatePlanes + i);
+      n2y = vtkBatchLoad(candidatePlanes + numCandidates + i);
+      n2z = vtkBatchLoad(candidatePlanes + 2*numCandidates + i);
+      s2  = vtkBatchLoad(candidatePlanes + 3*numCandidates + i);
+      }
+    else
+      {
+      // Candidate planes, as in vtkIntersectionTrianglePlane(p, q, r).
+      vtkBatchVector ax = vtkBatchSub(rx, qx);
+      vtkBatchVector ay = vtkBatchSub(ry, qy);
+      vtkBatchVector az = vtkBatchSub(rz, qz);
+      vtkBatchVector bx = vtkBatchSub(px, qx);
+      vtkBatchVector by = vtkBatchSub(py, qy);
+      vtkBatchVector bz = vtkBatchSub(pz, qz);
+      n2x = vtkBatchSub(vtkBatchMul(ay, bz), vtkBatchMul(az, by));
+      n2y = vtkBatchSub(vtkBatchMul(az, bx), vtkBatchMul(ax, bz));
+      n2z = vtkBatchSub(vtkBatchMul(ax, by), vtkBatchMul(ay, bx));
+      vtkBatchVector length = vtkBatchSqrt
+        (vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n2x, n2x),
+                                 vtkBatchMul(n2y, n2y)),
+                     vtkBatchMul(n2z, n2z)));
+      vtkBatchVector nonZero = vtkBatchNotEqual(length, zero);
+      length = vtkBatchOr(vtkBatchAnd(nonZero, length),
+                          vtkBatchAndNot(nonZero, one));
+      n2x = vtkBatchDiv(n2x, length);
+      n2y = vtkBatchDiv(n2y, length);
+      n2z = vtkBatchDiv(n2z, length);
+
+      s2 = vtkBatchSub
+        (zero, vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n2x, px),
+                                       vtkBatchMul(n2y, py)),
+                           vtkBatchMul(n2z, pz)));
+      }
+
+    // Signed distances of the first triangle from the candidate planes.
+    vtkBatchVector d1[3];
+    for (int j = 0; j < 3; j++)
+      {
+      d1[j] = vtkBatchAdd
+        (vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n2x, vtkBatchSet(tri1[j][0])),
+                                 vtkBatchMul(n2y, vtkBatchSet(tri1[j][1]))),
+                     vtkBatchMul(n2z, vtkBatchSet(tri1[j][2]))), s2);
+      }
+
+    // Signed distances of the candidates from the first triangle's plane.
+    vtkBatchVector d2[3];
+    d2[0] = vtkBatchAdd(vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n1x, px),
+                                                vtkBatchMul(n1y, py)),
+                                    vtkBatchMul(n1z, pz)), vs1);
+    d2[1] = vtkBatchAdd(vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n1x, qx),
+                                                vtkBatchMul(n1y, qy)),
+                                    vtkBatchMul(n1z, qz)), vs1);
+    d2[2] = vtkBatchAdd(vtkBatchAdd(vtkBatchAdd(vtkBatchMul(n1x, rx),
+                                                vtkBatchMul(n1y, ry)),
+                                    vtkBatchMul(n1z, rz)), vs1);
+
+    vtkBatchVector reject1 =
+      vtkBatchAnd(vtkBatchGreater(vtkBatchMul(d1[0], d1[1]), zero),
+                  vtkBatchGreater(vtkBatchMul(d1[0], d1[2]), zero));
+    vtkBatchVector reject2 =
+      vtkBatchAnd(vtkBatchGreater(vtkBatchMul(d2[0], d2[1]), zero),
+                  vtkBatchGreater(vtkBatchMul(d2[0], d2[2]), zero));
+    int rejectMask = vtkBatchMask(vtkBatchOr(reject1, reject2));
+    if (rejectMask == (1 << VTK_BATCH_LANES) - 1)
+      {
+      continue;
+      }
+
+    double n2[3][VTK_BATCH_LANES], offset2[VTK_BATCH_LANES];
+    vtkBatchStore(n2[0], n2x);
+    vtkBatchStore(n2[1], n2y);
+    vtkBatchStore(n2[2], n2z);
+    vtkBatchStore(offset2, s2);
+    for (int lane = 0; lane < VTK_BATCH_LANES; lane++)
+      {
+      if (rejectMask & (1 << lane))
+        {
+        continue;
+        }
+
+      int k = i + lane;
+      double tri2[3][3], plane2[3];
+      for (int j = 0; j < 3; j++)
+        {
+        tri2[j][0] = c[3*j][k];
+        tri2[j][1] = c[3*j + 1][k];
+        tri2[j][2] = c[3*j + 2][k];
+        plane2[j] = n2[j][lane];
+        }
+      intersects[k] = vtkTriangleTriangleIntersectionSegment
+        (p1, q1, r1, n1, s1, tri2[0], tri2[1], tri2[2], plane2,
+         offset2[lane], coplanar[k], pts1 + 3*k, pts2 + 3*k,
+         edges ? edges + 2*k : NULL);
+      numIntersections += intersects[k];
+      }
+    }
+#endif
+
+  // The remaining candidates go through the scalar test.
+  for ( ; i < numCandidates; i++)
+    {
+    double tri2[3][3], plane2[4];
+    for (int j = 0; j < 3; j++)
+      {
+      for (int k = 0; k < 3; k++)
+        {
+        tri2[j][k] = candidatePts[(3*j + k)*numCandidates + i];
+        }
+      }
+    if (candidatePlanes)
+      {
+      for (int k = 0; k < 4; k++)
+        {
+        plane2[k] = candidatePlanes[k*numCandidates + i];
+        }
+      }
+    else
+      {
+      vtkIntersectionTrianglePlane(tri2[0], tri2[1], tri2[2], plane2);
+      }
+
+    intersects[i] = vtkTriangleTriangleIntersectionEdges
+      (p1, q1, r1, n1, s1, tri2[0], tri2[1], tri2[2], plane2, plane2[3],
+       coplanar[i], pts1 + 3*i, pts2 + 3*i, edges ? edges + 2*i : NULL);
+    numIntersections += intersects[i];
+    }
+
+  return numIntersections;
+}
+
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT DEFAULT
+#elif defined(__GNUC__)
+# pragma GCC pop_options
+#elif defined(_MSC_VER)
+# pragma fp_contract (on)
+#endif
+
 //----------------------------------------------------------------------------
 int vtkIntersectionPolyDataFilter::RequestData(vtkInformation*        vtkNotUsed(request),
                                          vtkInformationVector** inputVector,
@@ -1063,9 +4887,6 @@ int vtkIntersectionPolyDataFilter::RequestData(vtkInformation*        vtkNotUsed
 
   vtkPolyData *outputIntersection = vtkPolyData::SafeDownCast(
     outIntersectionInfo->Get(vtkDataObject::DATA_OBJECT()));
-  vtkSmartPointer< vtkPoints > outputIntersectionPoints =
-    vtkSmartPointer< vtkPoints >::New();
-  outputIntersection->SetPoints(outputIntersectionPoints);
 
   vtkPolyData *outputPolyData0 = vtkPolyData::SafeDownCast(
     outPolyDataInfo0->Get(vtkDataObject::DATA_OBJECT()));
@@ -1073,38 +4894,229 @@ int vtkIntersectionPolyDataFilter::RequestData(vtkInformation*        vtkNotUsed
   vtkPolyData *outputPolyData1 = vtkPolyData::SafeDownCast(
     outPolyDataInfo1->Get(vtkDataObject::DATA_OBJECT()));
 
-  // Set up new poly data for the inputs to build cells and links.
-  vtkSmartPointer< vtkPolyData > mesh0 = vtkSmartPointer< vtkPolyData >::New();
-  mesh0->DeepCopy(input0);
-  mesh0->SetSource(NULL);
-
-  vtkSmartPointer< vtkPolyData > mesh1 = vtkSmartPointer< vtkPolyData >::New();
-  mesh1->DeepCopy(input1);
-  mesh1->SetSource(NULL);
-
-  // Find the triangle-triangle intersections between mesh0 and mesh1
-  vtkSmartPointer< vtkOBBTree > obbTree0 = vtkSmartPointer< vtkOBBTree >::New();
-  obbTree0->SetDataSet(mesh0);
-  obbTree0->SetNumberOfCellsPerNode(10);
-  obbTree0->SetMaxLevel(1e6);
-  obbTree0->SetTolerance(1e-6);
-  obbTree0->AutomaticOn();
-  obbTree0->BuildLocator();
-
-  vtkSmartPointer< vtkOBBTree > obbTree1 = vtkSmartPointer< vtkOBBTree >::New();
-  obbTree1->SetDataSet(mesh1);
-  obbTree1->SetNumberOfCellsPerNode(10);
-  obbTree1->SetMaxLevel(1e6);
-  obbTree1->SetTolerance(1e-6);
-  obbTree1->AutomaticOn();
-  obbTree1->BuildLocator();
+  return this->ComputeIntersection(input0, input1, outputIntersection,
+                                   outputPolyData0, outputPolyData1);
+}
+
+//----------------------------------------------------------------------------
+// Returns the root of the set containing id, halving the path on the
+// way.
+static vtkIdType vtkIntersectionPolyDataFilterFindRoot(
+  std::vector< vtkIdType > &parents, vtkIdType id)
+{
+  while (parents[id] != id)
+    {
+    parents[id] = parents[parents[id]];
+    id = parents[id];
+    }
+  return id;
+}
+
+//----------------------------------------------------------------------------
+// Replaces the two-point lines of intersection by maximal polylines.
+// A polyline runs through the points shared by exactly two segments and
+// stops at the others. Closed polylines repeat their first point at
+// the end. The per-segment cell data are replaced by the LoopId of the
+// connected curve each polyline belongs to, a Closed flag and the
+// ArcLength of the polyline.
+static void vtkIntersectionPolyDataFilterChainLines(vtkPolyData *intersection)
+{
+  vtkCellArray *lines = intersection->GetLines();
+  vtkIdType numPoints = intersection->GetNumberOfPoints();
+
+  // Collect the segments, skipping those collapsed by the weld.
+  std::vector< vtkIdType > segmentPts;
+  segmentPts.reserve(2*lines->GetNumberOfCells());
+  vtkIdType npts, *pts;
+  for (lines->InitTraversal(); lines->GetNextCell(npts, pts); )
+    {
+    if (npts == 2 && pts[0] != pts[1])
+      {
+      segmentPts.push_back(pts[0]);
+      segmentPts.push_back(pts[1]);
+      }
+    }
+  vtkIdType numSegments = static_cast<vtkIdType>(segmentPts.size()) / 2;
+
+  // Segments incident to each point, in compressed-sparse-row form,
+  // and the connected curves as disjoint sets of points.
+  std::vector< vtkIdType > offsets(numPoints + 1, 0);
+  std::vector< vtkIdType > parents(numPoints);
+  for (vtkIdType i = 0; i < 2*numSegments; i++)
+    {
+    offsets[segmentPts[i] + 1]++;
+    }
+  for (vtkIdType ptId = 0; ptId < numPoints; ptId++)
+    {
+    offsets[ptId + 1] += offsets[ptId];
+    parents[ptId] = ptId;
+    }
+  std::vector< vtkIdType > incident(2*numSegments + 1);
+  std::vector< vtkIdType > next(offsets.begin(), offsets.end() - 1);
+  for (vtkIdType i = 0; i < numSegments; i++)
+    {
+    vtkIdType ptId0 = segmentPts[2*i];
+    vtkIdType ptId1 = segmentPts[2*i + 1];
+    incident[next[ptId0]++] = i;
+    incident[next[ptId1]++] = i;
+    parents[vtkIntersectionPolyDataFilterFindRoot(parents, ptId0)] =
+      vtkIntersectionPolyDataFilterFindRoot(parents, ptId1);
+    }
+
+  vtkSmartPointer< vtkCellArray > polylines =
+    vtkSmartPointer< vtkCellArray >::New();
+  vtkSmartPointer< vtkIdTypeArray > loopIds =
+    vtkSmartPointer< vtkIdTypeArray >::New();
+  loopIds->SetName("LoopId");
+  vtkSmartPointer< vtkUnsignedCharArray > closed =
+    vtkSmartPointer< vtkUnsignedCharArray >::New();
+  closed->SetName("Closed");
+  vtkSmartPointer< vtkDoubleArray > arcLengths =
+    vtkSmartPointer< vtkDoubleArray >::New();
+  arcLengths->SetName("ArcLength");
+
+  // Open polylines start at the points that do not have two segments.
+  // The segments left afterwards form cycles, which may start anywhere.
+  std::vector< char > visited(numSegments, 0);
+  std::vector< vtkIdType > loopOfRoot(numPoints, -1);
+  vtkIdType numLoops = 0;
+  std::vector< vtkIdType > chain;
+  for (int pass = 0; pass < 2; pass++)
+    {
+    for (vtkIdType start = 0; start < numPoints; start++)
+      {
+      bool regular = offsets[start + 1] - offsets[start] == 2;
+      if (regular != (pass == 1))
+        {
+        continue;
+        }
+
+      for (vtkIdType k = offsets[start]; k < offsets[start + 1]; k++)
+        {
+        vtkIdType segmentId = incident[k];
+        if (visited[segmentId])
+          {
+          continue;
+          }
+
+        chain.clear();
+        chain.push_back(start);
+        double arcLength = 0.0;
+        vtkIdType ptId = start;
+        while (true)
+          {
+          visited[segmentId] = 1;
+          vtkIdType prevId = ptId;
+          ptId = segmentPts[2*segmentId] == ptId ?
+            segmentPts[2*segmentId + 1] : segmentPts[2*segmentId];
+          chain.push_back(ptId);
+
+          double x0[3], x1[3];
+          intersection->GetPoint(prevId, x0);
+          intersection->GetPoint(ptId, x1);
+          arcLength += sqrt(vtkMath::Distance2BetweenPoints(x0, x1));
+
+          if (ptId == start || offsets[ptId + 1] - offsets[ptId] != 2)
+            {
+            break;
+            }
+          const vtkIdType *pair = &incident[offsets[ptId]];
+          segmentId = pair[0] == segmentId ? pair[1] : pair[0];
+          if (visited[segmentId])
+            {
+            break;
+            }
+          }
+
+        vtkIdType root = vtkIntersectionPolyDataFilterFindRoot(parents, start);
+        if (loopOfRoot[root] < 0)
+          {
+          loopOfRoot[root] = numLoops++;
+          }
+
+        polylines->InsertNextCell(static_cast<vtkIdType>(chain.size()),
+                                  &chain[0]);
+        loopIds->InsertNextValue(loopOfRoot[root]);
+        closed->InsertNextValue(chain.front() == chain.back() ? 1 : 0);
+        arcLengths->InsertNextValue(arcLength);
+        }
+      }
+    }
+
+  intersection->SetLines(polylines);
+  vtkCellData *cellData = intersection->GetCellData();
+  cellData->Initialize();
+  cellData->AddArray(loopIds);
+  cellData->AddArray(closed);
+  cellData->AddArray(arcLengths);
+}
+
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::ComputeIntersection(vtkPolyData *input0,
+                                                       vtkPolyData *input1,
+                                                       vtkPolyData *outputIntersection,
+                                                       vtkPolyData *outputPolyData0,
+                                                       vtkPolyData *outputPolyData1)
+{
+  if ( !input0 || !input1 || !outputIntersection ||
+       !outputPolyData0 || !outputPolyData1 )
+    {
+    return 0;
+    }
+
+  vtkSmartPointer< vtkPoints > outputIntersectionPoints =
+    vtkSmartPointer< vtkPoints >::New();
+  outputIntersection->SetPoints(outputIntersectionPoints);
+
+  // Get the working meshes and OBB trees, reusing the ones from the
+  // previous execution if the inputs did not change.
+  this->UpdateInputCache(0, input0, this->SplitFirstOutput != 0);
+  this->UpdateInputCache(1, input1, this->SplitSecondOutput != 0);
+
+  vtkPolyData *mesh0 = this->Caches[0].Mesh;
+  vtkIntersectionOBBTree *obbTree0 = this->Caches[0].Tree;
+  vtkIntersectionOBBTree *obbTree1 = this->Caches[1].Tree;
+
+  // The second mesh is intersected in the transformed frame, but its
+  // OBB tree stays in the frame of the input and is compared with the
+  // first tree through the transform matrix.
+  vtkSmartPointer< vtkPolyData > mesh1 = this->Caches[1].Mesh;
+  vtkSmartPointer< vtkMatrix4x4 > matrix;
+  vtkSmartPointer< vtkMatrix4x4 > inverseMatrix;
+  if ( this->Transform != NULL )
+    {
+    this->Transform->Update();
+    matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+    matrix->DeepCopy(this->Transform->GetMatrix());
+    inverseMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+    vtkMatrix4x4::Invert(matrix, inverseMatrix);
+
+    vtkSmartPointer< vtkPoints > transformedPoints =
+      vtkSmartPointer< vtkPoints >::New();
+    transformedPoints->SetDataTypeToDouble();
+    this->Transform->TransformPoints(mesh1->GetPoints(), transformedPoints);
+
+    // Shares the cells and links of the cached mesh.
+    mesh1 = vtkSmartPointer< vtkPolyData >::New();
+    mesh1->ShallowCopy(this->Caches[1].Mesh);
+    mesh1->SetPoints(transformedPoints);
+    }
 
   // Set up the structure for determining exact triangle-triangle
   // intersections.
   vtkIntersectionPolyDataFilter::Impl *impl = new vtkIntersectionPolyDataFilter::Impl();
   impl->Mesh[0]  = mesh0;
   impl->Mesh[1]  = mesh1;
+  impl->OBBTree0 = obbTree0;
   impl->OBBTree1 = obbTree1;
+  impl->Transform = matrix;
+  impl->InverseTransform = inverseMatrix;
+
+  if ( this->PrecomputeTrianglePlanes )
+    {
+    impl->PrecomputeTriangles(0);
+    impl->PrecomputeTriangles(1);
+    }
 
   vtkSmartPointer< vtkCellArray > lines = vtkSmartPointer< vtkCellArray >::New();
   outputIntersection->SetLines(lines);
@@ -1142,41 +5154,148 @@ int vtkIntersectionPolyDataFilter::RequestData(vtkInformation*        vtkNotUsed
   pointMerger->SetTolerance(1e-6);
   pointMerger->InitPointInsertion(outputIntersection->GetPoints(), bounds0);
   impl->PointMerger = pointMerger;
+  impl->IntersectionPoints = outputIntersection->GetPoints();
+  impl->MergeTolerance = pointMerger->GetTolerance();
+  impl->TopologicalChaining = this->TopologicalChaining;
+  impl->ExactPredicates = this->ExactPredicates;
+  impl->IntersectCoplanarTriangles = this->IntersectCoplanarTriangles;
 
   // This performs the triangle intersection search
-  obbTree0->IntersectWithOBBTree
-    (obbTree1, 0, vtkIntersectionPolyDataFilter::Impl::FindTriangleIntersections,
-     impl);
+  if ( this->NumberOfThreads > 1 )
+    {
+    impl->IntersectTreesInParallel(obbTree0, obbTree1, this->NumberOfThreads);
+    }
+  else
+    {
+    obbTree0->IntersectWithOBBTree
+      (obbTree1, matrix, vtkIntersectionPolyDataFilter::Impl::FindTriangleIntersections,
+       impl);
+    }
+
+  impl->BuildIntersectionMaps();
+  impl->NumberOfThreads = this->NumberOfThreads;
 
   // Split the first output if so desired
   if ( this->SplitFirstOutput )
     {
-    mesh0->BuildLinks();
     impl->SplitMesh(0, outputPolyData0, outputIntersection);
+    this->FirstSplitPointId[0] = impl->FirstSplitPointId[0];
     }
   else
     {
     outputPolyData0->ShallowCopy( mesh0 );
+    this->FirstSplitPointId[0] = outputPolyData0->GetNumberOfPoints();
     }
 
   // Split the second output if desired
   if ( this->SplitSecondOutput )
     {
-    mesh1->BuildLinks();
     impl->SplitMesh(1, outputPolyData1, outputIntersection);
+    this->FirstSplitPointId[1] = impl->FirstSplitPointId[1];
     }
   else
     {
     outputPolyData1->ShallowCopy( mesh1 );
+    this->FirstSplitPointId[1] = outputPolyData1->GetNumberOfPoints();
     }
 
   impl->PointCellIds[0]->Delete();
   impl->PointCellIds[1]->Delete();
   delete impl;
 
+  if ( this->OutputPolylines )
+    {
+    vtkIntersectionPolyDataFilterChainLines(outputIntersection);
+    }
+
+  if ( !this->CacheInputs )
+    {
+    this->Caches[0] = InputCache();
+    this->Caches[1] = InputCache();
+    }
+
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkIntersectionPolyDataFilter::SplitAlongLines(vtkPolyData *input,
+                                                   vtkPolyData *lines,
+                                                   vtkIdTypeArray *cellIds,
+                                                   vtkPolyData *output)
+{
+  if ( !input || !lines || !lines->GetPoints() || !cellIds || !output )
+    {
+    return 0;
+    }
+  if ( cellIds->GetNumberOfTuples() != lines->GetNumberOfLines() )
+    {
+    vtkErrorMacro(<< "Expected one cell ID per line segment");
+    return 0;
+    }
+
+  // The same working mesh ComputeIntersection() splits.
+  vtkSmartPointer< vtkPolyData > mesh = vtkSmartPointer< vtkPolyData >::New();
+  mesh->ShallowCopy(input);
+  mesh->BuildLinks();
+  mesh->ComputeBounds();
+
+  vtkSmartPointer< vtkPolyData > intersection =
+    vtkSmartPointer< vtkPolyData >::New();
+  vtkSmartPointer< vtkCellArray > intersectionLines =
+    vtkSmartPointer< vtkCellArray >::New();
+  intersection->SetPoints(lines->GetPoints());
+  intersection->SetLines(intersectionLines);
+
+  vtkIntersectionPolyDataFilter::Impl *impl = new vtkIntersectionPolyDataFilter::Impl();
+  impl->Mesh[0] = mesh;
+  impl->IntersectionLines = intersectionLines;
+  impl->IntersectionPoints = lines->GetPoints();
+  impl->NumberOfThreads = this->NumberOfThreads;
+  for (int i = 0; i < 2; i++)
+    {
+    impl->CellIds[i] = vtkIdTypeArray::New();
+    impl->PointCellIds[i] = vtkIdTypeArray::New();
+    }
+
+  vtkIdType numCells = mesh->GetNumberOfCells();
+  vtkIdType npts, *pts;
+  vtkIdType lineId = 0;
+  vtkCellArray *segments = lines->GetLines();
+  bool valid = true;
+  segments->InitTraversal();
+  while ( valid && segments->GetNextCell(npts, pts) )
+    {
+    vtkIdType cellId = cellIds->GetValue(lineId);
+    valid = npts == 2 && cellId >= 0 && cellId < numCells;
+    if ( valid )
+      {
+      impl->AddMeshSegment(cellId, pts[0], pts[1]);
+      lineId++;
+      }
+    }
+
+  if ( valid )
+    {
+    impl->BuildIntersectionMaps();
+    impl->SplitMesh(0, output, intersection);
+    this->FirstSplitPointId[0] = impl->FirstSplitPointId[0];
+    }
+  else
+    {
+    vtkErrorMacro(<< "Line " << lineId << " is not a segment in a cell of "
+                  << "the input");
+    }
+
+  for (int i = 0; i < 2; i++)
+    {
+    impl->CellIds[i]->Delete();
+    impl->PointCellIds[i]->Delete();
+    }
+  delete impl;
+
+  return valid ? 1 : 0;
+}
+
 //----------------------------------------------------------------------------
 int vtkIntersectionPolyDataFilter::FillInputPortInformation(int port,
                                                       vtkInformation *info)
@@ -30,6 +30,9 @@
 
 #include "vtkPolyDataAlgorithm.h"
 
+class vtkIdTypeArray;
+class vtkLinearTransform;
+class vtkPolyDataLocatorCache;
 
 class vtkIntersectionPolyDataFilter : public vtkPolyDataAlgorithm
 {
@@ -52,6 +55,133 @@ public:
   vtkSetMacro(SplitSecondOutput, int);
   vtkBooleanMacro(SplitSecondOutput, int);
 
+  // Description:
+  // Set/get the number of threads used to search for intersecting
+  // triangles and to split the output meshes. With more than one
+  // thread, the traversal of the two OBB trees is split into tasks
+  // that idle threads steal from busy ones, and the cut cells are
+  // re-triangulated concurrently. The output is identical to the
+  // single-threaded result. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // If on, the vertex coordinates and supporting plane of every
+  // triangle are computed once, before the intersection search, and
+  // stored in flat arrays indexed by cell id. This avoids recomputing
+  // the planes for each candidate pair at the cost of 13 doubles of
+  // memory per cell. Defaults to off.
+  vtkGetMacro(PrecomputeTrianglePlanes, int);
+  vtkSetMacro(PrecomputeTrianglePlanes, int);
+  vtkBooleanMacro(PrecomputeTrianglePlanes, int);
+
+  // Description:
+  // If on, the segments found between pairs of triangles are joined
+  // into intersection lines by the mesh features their endpoints lie
+  // on instead of by their distance. An endpoint where an edge of one
+  // triangle crosses the other triangle is identified by the two
+  // point ids of the edge and the cell id of the other triangle, and
+  // looked up in a hash table. Only endpoints on a vertex or on an
+  // edge of both triangles are merged by distance, as is the first
+  // endpoint found on each feature, so that it is shared with the
+  // endpoints at the same place. The inputs must share points between
+  // adjacent cells. Defaults to off.
+  vtkGetMacro(TopologicalChaining, int);
+  vtkSetMacro(TopologicalChaining, int);
+  vtkBooleanMacro(TopologicalChaining, int);
+
+  // Description:
+  // If on, the intersection lines of the first output are joined into
+  // maximal polylines, which run through the points shared by exactly
+  // two segments. Closed polylines repeat their first point at the
+  // end. The Input0CellID and Input1CellID cell data are then replaced
+  // by LoopId, the id of the connected curve the polyline belongs to,
+  // Closed, set to 1 for closed polylines, and ArcLength, the length
+  // of the polyline. The split outputs are not affected. Defaults to
+  // off.
+  vtkGetMacro(OutputPolylines, int);
+  vtkSetMacro(OutputPolylines, int);
+  vtkBooleanMacro(OutputPolylines, int);
+
+  // Description:
+  // If on, the sides of each other's plane on which the vertices of
+  // two triangles lie are decided with exact orientation predicates.
+  // A floating-point evaluation is used when its error bound proves
+  // the sign, and exact arithmetic otherwise. Nearly degenerate
+  // triangle pairs then give consistent segments instead of missing
+  // ones, and the edges the segment endpoints lie on are taken from
+  // the predicates instead of a distance test. The endpoint
+  // coordinates are still computed in floating point. Defaults to
+  // off.
+  vtkGetMacro(ExactPredicates, int);
+  vtkSetMacro(ExactPredicates, int);
+  vtkBooleanMacro(ExactPredicates, int);
+
+  // Description:
+  // If on, pairs of coplanar triangles are clipped against each other
+  // in their common plane and the boundary of their overlap is added
+  // to the intersection lines. Each boundary segment splits the cell
+  // it crosses; segments on the edges of both cells are left out.
+  // Otherwise coplanar pairs are skipped, which leaves the seams of
+  // overlapping coplanar regions open. Defaults to off.
+  vtkGetMacro(IntersectCoplanarTriangles, int);
+  vtkSetMacro(IntersectCoplanarTriangles, int);
+  vtkBooleanMacro(IntersectCoplanarTriangles, int);
+
+  // Description:
+  // Set/get a transform applied to the second input before it is
+  // intersected with the first. The intersection lines and the third
+  // output are expressed in the transformed frame. The OBB tree of
+  // the second input is built in its own frame, so moving it only
+  // requires a new transform; see CacheInputs. Defaults to NULL.
+  virtual void SetTransform(vtkLinearTransform*);
+  vtkGetObjectMacro(Transform, vtkLinearTransform);
+
+  // Description:
+  // If on, the OBB tree and cell links built for each input are kept
+  // after execution and reused as long as the input and its MTime do
+  // not change. Together with Transform, this lets one input be
+  // dragged across the other without rebuilding either tree. Defaults
+  // to off.
+  vtkGetMacro(CacheInputs, int);
+  vtkSetMacro(CacheInputs, int);
+  vtkBooleanMacro(CacheInputs, int);
+
+  // Description:
+  // Set/get a cache shared with other filters from which the working
+  // meshes and OBB trees of the inputs are taken. Takes precedence
+  // over CacheInputs. Defaults to NULL.
+  virtual void SetLocatorCache(vtkPolyDataLocatorCache*);
+  vtkGetObjectMacro(LocatorCache, vtkPolyDataLocatorCache);
+
+  // Description:
+  // Builds the working mesh and OBB tree of input as a
+  // vtkPolyDataLocatorCache entry. Pass it to
+  // vtkPolyDataLocatorCache::Prebuild() or Pin() to prepare an input
+  // ahead of time.
+  static vtkObject* BuildLocatorCacheEntry(vtkPolyData *input);
+
+  // Description:
+  // Writes the OBB tree of an entry built by BuildLocatorCacheEntry()
+  // to a binary file. ReadLocatorSnapshot() reads it back over input
+  // and returns a new entry to be handed to
+  // vtkPolyDataLocatorCache::AddEntry() with BuildLocatorCacheEntry,
+  // or NULL if the file cannot be read or was written for different
+  // points or cells. Snapshots are only valid between builds with the
+  // same byte order and vtkIdType size. Returns 1 on success.
+  //
+  // Only the OBB trees of this filter are covered: the cell locators
+  // of vtkImplicitPolyData are still built on first use. The file is
+  // read into memory rather than mapped, since its nodes are decoded
+  // into the vtkOBBNode and vtkIdList objects vtkOBBTree works on.
+  static int WriteLocatorSnapshot(vtkObject *entry, const char *fileName);
+  static vtkObject* ReadLocatorSnapshot(vtkPolyData *input,
+                                        const char *fileName);
+
+  // Description:
+  // Return the MTime also considering the Transform.
+  unsigned long GetMTime();
+
   // Description:
   // Given two triangles defined by points (p1, q1, r1) and (p2, q2,
   // r2), returns whether the two triangles intersect. If they do,
@@ -62,6 +192,67 @@ public:
                                           double p2[3], double q2[3], double r2[3],
                                           int &coplanar, double pt1[3], double pt2[3]);
 
+  // Description:
+  // Same as above, but takes the supporting planes of the triangles
+  // as input. The plane of the first triangle is given by the unit
+  // normal n1 and offset s1 such that dot(n1, x) + s1 = 0 for points
+  // x on the plane; likewise for the second triangle.
+  static int TriangleTriangleIntersection(double p1[3], double q1[3], double r1[3],
+                                          double n1[3], double s1,
+                                          double p2[3], double q2[3], double r2[3],
+                                          double n2[3], double s2,
+                                          int &coplanar, double pt1[3], double pt2[3]);
+
+  // Description:
+  // Tests the triangle (p1, q1, r1) against numCandidates triangles at
+  // once. The candidates are stored in structure-of-arrays layout:
+  // candidatePts[k*numCandidates + i] is coordinate k%3 of vertex k/3
+  // of candidate i, for k = 0..8. The plane-side rejection tests are
+  // evaluated in SIMD lanes when the compiler targets SSE2 or AVX;
+  // the remaining candidates go through
+  // TriangleTriangleIntersection(). For each candidate i, intersects[i]
+  // and coplanar[i] receive the result of the test and, if the
+  // triangles intersect, pts1[3*i] and pts2[3*i] the segment
+  // endpoints. Returns the number of intersecting candidates.
+  static int TriangleTriangleIntersectionBatch(double p1[3], double q1[3], double r1[3],
+                                               int numCandidates, double *candidatePts,
+                                               int *intersects, int *coplanar,
+                                               double *pts1, double *pts2);
+
+  // Description:
+  // Computes the intersection of input0 and input1 directly, without
+  // going through the pipeline. outputIntersection receives the
+  // intersection lines and outputPolyData0/outputPolyData1 the
+  // (optionally split) inputs, as on the three output ports. The
+  // inputs are not modified. Returns 1 on success, 0 otherwise.
+  int ComputeIntersection(vtkPolyData *input0, vtkPolyData *input1,
+                          vtkPolyData *outputIntersection,
+                          vtkPolyData *outputPolyData0,
+                          vtkPolyData *outputPolyData1);
+
+  // Description:
+  // Splits input along the two-point line segments of lines without
+  // searching for intersections, as ComputeIntersection() splits its
+  // inputs along the segments it finds. cellIds holds, for each
+  // segment, the ID of the cell of input that contains it, and every
+  // point of lines must be used by a segment. The points of lines are
+  // added to output in order after the points of input, so surfaces
+  // split along segments taken from one set of points have matching
+  // seams. Used to split a surface once along the intersection lines
+  // found with several other surfaces. GetFirstSplitPointId(0)
+  // returns the ID of the first added point. Returns 1 on success, 0
+  // otherwise.
+  int SplitAlongLines(vtkPolyData *input, vtkPolyData *lines,
+                      vtkIdTypeArray *cellIds, vtkPolyData *output);
+
+  // Description:
+  // Returns the ID of the first point of output index + 1 (index is 0
+  // or 1) that lies on the intersection lines, as of the last
+  // execution. The points before it are the points of the input, the
+  // points from it on were added by the split. Equals the number of
+  // points of the output if that output was not split.
+  vtkIdType GetFirstSplitPointId(int index);
+
 protected:
   vtkIntersectionPolyDataFilter();
   ~vtkIntersectionPolyDataFilter();
@@ -71,12 +262,31 @@ protected:
 
   int SplitFirstOutput;
   int SplitSecondOutput;
+  int NumberOfThreads;
+  int PrecomputeTrianglePlanes;
+  int TopologicalChaining;
+  int OutputPolylines;
+  int ExactPredicates;
+  int IntersectCoplanarTriangles;
+  int CacheInputs;
+  vtkLinearTransform *Transform;
+  vtkPolyDataLocatorCache *LocatorCache;
+  vtkIdType FirstSplitPointId[2];
 
 private:
   vtkIntersectionPolyDataFilter(const vtkIntersectionPolyDataFilter&); // no implementation
   void operator=(const vtkIntersectionPolyDataFilter&);          // no implementation
 
   class Impl;
+
+  // Working mesh and OBB tree of each input.
+  class InputCache;
+  InputCache *Caches;
+
+  // Description:
+  // Brings the working mesh and OBB tree of input index up to date.
+  // Cell links are built if buildLinks is true.
+  void UpdateInputCache(int index, vtkPolyData *input, bool buildLinks);
 };
 
 
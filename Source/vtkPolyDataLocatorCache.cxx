@@ -0,0 +1,357 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPolyDataLocatorCache.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPolyDataLocatorCache.h"
+
+#include "vtkConditionVariable.h"
+#include "vtkMutexLock.h"
+#include "vtkObjectFactory.h"
+#include "vtkPolyData.h"
+
+#include <list>
+
+vtkStandardNewMacro(vtkPolyDataLocatorCache);
+
+//-----------------------------------------------------------------------------
+// One cached structure. The cache holds a reference to both the input
+// and the structure, so the key cannot be reused by another object
+// while the entry exists. Building is set while a thread builds the
+// structure without the lock; such entries are never removed.
+class vtkPolyDataLocatorCache::Entry
+{
+public:
+  vtkPolyData       *Input;
+  unsigned long      MTime;
+  BuildFunctionType  Build;
+  vtkObject         *Locator;
+  int                PinCount;
+  unsigned long      LastUse;
+  bool               Building;
+};
+
+class vtkPolyDataLocatorCache::Entries : public std::list< Entry >
+{
+};
+
+//-----------------------------------------------------------------------------
+static void vtkPolyDataLocatorCacheRelease(vtkPolyDataLocatorCache *self,
+                                           vtkObject *locator,
+                                           vtkPolyData *input)
+{
+  if ( locator )
+    {
+    locator->UnRegister(self);
+    }
+  input->UnRegister(self);
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache::vtkPolyDataLocatorCache()
+{
+  this->MaximumNumberOfEntries = 16;
+  this->Items = new Entries;
+  this->Lock = vtkSimpleMutexLock::New();
+  this->EntryBuilt = vtkSimpleConditionVariable::New();
+  this->UseCounter = 0;
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache::~vtkPolyDataLocatorCache()
+{
+  this->RemoveAllEntries();
+  delete this->Items;
+  this->EntryBuilt->Delete();
+  this->Lock->Delete();
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache::Entry*
+vtkPolyDataLocatorCache::FindEntry(vtkPolyData *input,
+                                   BuildFunctionType build)
+{
+  Entries::iterator iter;
+  for (iter = this->Items->begin(); iter != this->Items->end(); ++iter)
+    {
+    if ( iter->Input == input && iter->Build == build )
+      {
+      break;
+      }
+    }
+
+  if ( iter == this->Items->end() )
+    {
+    Entry entry;
+    entry.Input    = input;
+    entry.MTime    = 0;
+    entry.Build    = build;
+    entry.Locator  = NULL;
+    entry.PinCount = 0;
+    entry.LastUse  = 0;
+    entry.Building = false;
+    input->Register(this);
+    iter = this->Items->insert(this->Items->end(), entry);
+    }
+
+  return &(*iter);
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache::Entry*
+vtkPolyDataLocatorCache::WaitForEntry(vtkPolyData *input,
+                                      BuildFunctionType build)
+{
+  // Builds register the input, so only one build per input may run
+  // at a time, whatever its build function. The entry may be evicted
+  // once its build is done and the lock released, so look it up again
+  // after each wait.
+  while ( true )
+    {
+    bool building = false;
+    for (Entries::iterator iter = this->Items->begin();
+         iter != this->Items->end() && !building; ++iter)
+      {
+      building = iter->Input == input && iter->Building;
+      }
+    if ( !building )
+      {
+      return this->FindEntry(input, build);
+      }
+    this->EntryBuilt->Wait(*this->Lock);
+    }
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyDataLocatorCache::Entry*
+vtkPolyDataLocatorCache::FindOrBuildEntry(vtkPolyData *input,
+                                          BuildFunctionType build)
+{
+  Entry *entry = this->WaitForEntry(input, build);
+
+  // Build or rebuild the structure if the input changed. The build
+  // runs without the lock, so that other entries can be used and built
+  // meanwhile; threads that want this entry wait for it instead.
+  unsigned long mTime = input->GetMTime();
+  if ( entry->Locator == NULL || entry->MTime != mTime )
+    {
+    entry->Building = true;
+    this->Lock->Unlock();
+    vtkObject *locator = (*build)(input);
+    this->Lock->Lock();
+    entry->Building = false;
+
+    if ( entry->Locator )
+      {
+      entry->Locator->UnRegister(this);
+      }
+    entry->Locator = locator;
+    entry->MTime = mTime;
+    this->EntryBuilt->Broadcast();
+    }
+  entry->LastUse = ++this->UseCounter;
+
+  return entry;
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::EvictEntries()
+{
+  while (true)
+    {
+    int numUnpinned = 0;
+    Entries::iterator oldest = this->Items->end();
+    for (Entries::iterator iter = this->Items->begin();
+         iter != this->Items->end(); ++iter)
+      {
+      if ( iter->PinCount > 0 || iter->Building )
+        {
+        continue;
+        }
+      numUnpinned++;
+      if ( oldest == this->Items->end() || iter->LastUse < oldest->LastUse )
+        {
+        oldest = iter;
+        }
+      }
+
+    if ( numUnpinned <= this->MaximumNumberOfEntries ||
+         oldest == this->Items->end() )
+      {
+      return;
+      }
+
+    vtkPolyDataLocatorCacheRelease(this, oldest->Locator, oldest->Input);
+    this->Items->erase(oldest);
+    }
+}
+
+//-----------------------------------------------------------------------------
+vtkObject* vtkPolyDataLocatorCache::AcquireEntry(vtkPolyData *input,
+                                                 BuildFunctionType build)
+{
+  if ( input == NULL || build == NULL )
+    {
+    return NULL;
+    }
+
+  // Take our reference before evicting, so that the structure
+  // survives even if its entry does not.
+  this->Lock->Lock();
+  vtkObject *locator = this->FindOrBuildEntry(input, build)->Locator;
+  if ( locator )
+    {
+    locator->Register(NULL);
+    }
+  this->EvictEntries();
+  this->Lock->Unlock();
+
+  return locator;
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::Prebuild(vtkPolyData *input,
+                                       BuildFunctionType build, bool pin)
+{
+  if ( input == NULL || build == NULL )
+    {
+    return;
+    }
+
+  this->Lock->Lock();
+  Entry *entry = this->FindOrBuildEntry(input, build);
+  if ( pin )
+    {
+    entry->PinCount++;
+    }
+  this->EvictEntries();
+  this->Lock->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::AddEntry(vtkPolyData *input,
+                                       BuildFunctionType build,
+                                       vtkObject *locator, bool pin)
+{
+  if ( input == NULL || build == NULL || locator == NULL )
+    {
+    return;
+    }
+
+  this->Lock->Lock();
+  Entry *entry = this->WaitForEntry(input, build);
+  locator->Register(this);
+  if ( entry->Locator )
+    {
+    entry->Locator->UnRegister(this);
+    }
+  entry->Locator = locator;
+  entry->MTime = input->GetMTime();
+  entry->LastUse = ++this->UseCounter;
+  if ( pin )
+    {
+    entry->PinCount++;
+    }
+  this->EvictEntries();
+  this->Lock->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::Pin(vtkPolyData *input, BuildFunctionType build)
+{
+  this->Prebuild(input, build, true);
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::Unpin(vtkPolyData *input, BuildFunctionType build)
+{
+  this->Lock->Lock();
+  for (Entries::iterator iter = this->Items->begin();
+       iter != this->Items->end(); ++iter)
+    {
+    if ( iter->Input == input && iter->Build == build )
+      {
+      if ( iter->PinCount > 0 )
+        {
+        iter->PinCount--;
+        }
+      break;
+      }
+    }
+  this->EvictEntries();
+  this->Lock->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::SetMaximumNumberOfEntries(int maxEntries)
+{
+  maxEntries = (maxEntries < 0 ? 0 : maxEntries);
+  this->Lock->Lock();
+  bool changed = this->MaximumNumberOfEntries != maxEntries;
+  this->MaximumNumberOfEntries = maxEntries;
+  this->EvictEntries();
+  this->Lock->Unlock();
+
+  if ( changed )
+    {
+    this->Modified();
+    }
+}
+
+//-----------------------------------------------------------------------------
+int vtkPolyDataLocatorCache::GetNumberOfEntries()
+{
+  this->Lock->Lock();
+  int numEntries = static_cast<int>(this->Items->size());
+  this->Lock->Unlock();
+
+  return numEntries;
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::RemoveAllEntries()
+{
+  // Wait for the builds in progress, whose entries are still in use.
+  this->Lock->Lock();
+  bool building = true;
+  while ( building )
+    {
+    building = false;
+    for (Entries::iterator iter = this->Items->begin();
+         iter != this->Items->end() && !building; ++iter)
+      {
+      building = iter->Building;
+      }
+    if ( building )
+      {
+      this->EntryBuilt->Wait(*this->Lock);
+      }
+    }
+
+  for (Entries::iterator iter = this->Items->begin();
+       iter != this->Items->end(); ++iter)
+    {
+    vtkPolyDataLocatorCacheRelease(this, iter->Locator, iter->Input);
+    }
+  this->Items->clear();
+  this->Lock->Unlock();
+}
+
+//-----------------------------------------------------------------------------
+void vtkPolyDataLocatorCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "MaximumNumberOfEntries: "
+     << this->MaximumNumberOfEntries << "\n";
+  os << indent << "NumberOfEntries: " << this->GetNumberOfEntries() << "\n";
+}
@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPolyDataLocatorCache.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkPolyDataLocatorCache
+// .SECTION Description
+//
+// vtkPolyDataLocatorCache keeps acceleration structures built over
+// vtkPolyData objects so that they can be reused across filter
+// executions. Entries are keyed on the vtkPolyData, its MTime and the
+// function that built the entry; an entry whose vtkPolyData has been
+// modified since is rebuilt on the next request.
+//
+// vtkIntersectionPolyDataFilter stores its OBB trees here and
+// vtkImplicitPolyData its cell locators (see their SetLocatorCache()
+// methods), so a single cache can be shared by the intersection,
+// distance and boolean filters. Entries for a mesh that is used over
+// and over can be built ahead of time with Prebuild() and protected
+// from eviction with Pin().
+//
+// All methods may be called from several threads at once. Entries are
+// built without holding the lock on the cache, so building one entry
+// does not hold up the use of the others; threads that request an
+// entry being built wait for it.
+
+#ifndef __vtkPolyDataLocatorCache_h
+#define __vtkPolyDataLocatorCache_h
+
+#include "vtkObject.h"
+
+
+class vtkPolyData;
+class vtkSimpleConditionVariable;
+class vtkSimpleMutexLock;
+
+class vtkPolyDataLocatorCache : public vtkObject
+{
+public:
+  static vtkPolyDataLocatorCache *New();
+  vtkTypeMacro(vtkPolyDataLocatorCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Function that builds a cache entry for a vtkPolyData. It returns a
+  // new reference that the cache takes over.
+  typedef vtkObject* (*BuildFunctionType)(vtkPolyData *input);
+
+  // Description:
+  // Returns the entry built by build for input, building it first if
+  // there is none or input was modified since. The caller receives a
+  // new reference and must release it with Delete(); the structure
+  // stays valid until then even if its entry is evicted.
+  vtkObject* AcquireEntry(vtkPolyData *input, BuildFunctionType build);
+
+  // Description:
+  // Builds the entry for input and build if it is not up to date. If
+  // pin is true, the entry is also pinned, as with Pin().
+  void Prebuild(vtkPolyData *input, BuildFunctionType build, bool pin);
+
+  // Description:
+  // Stores locator as the up-to-date entry for input and build,
+  // replacing any existing one, as if build had just returned it. The
+  // cache takes its own reference. Used to warm the cache from
+  // snapshots, see vtkIntersectionPolyDataFilter::ReadLocatorSnapshot().
+  void AddEntry(vtkPolyData *input, BuildFunctionType build,
+                vtkObject *locator, bool pin);
+
+  // Description:
+  // Pinned entries are never evicted. Pin() builds the entry if
+  // needed. Pins are counted, so every Pin() needs a matching
+  // Unpin().
+  void Pin(vtkPolyData *input, BuildFunctionType build);
+  void Unpin(vtkPolyData *input, BuildFunctionType build);
+
+  // Description:
+  // Set/get the maximum number of unpinned entries. When a new entry
+  // would exceed it, the least recently used unpinned entry is
+  // evicted. Defaults to 16.
+  void SetMaximumNumberOfEntries(int maxEntries);
+  vtkGetMacro(MaximumNumberOfEntries, int);
+
+  // Description:
+  // Returns the number of entries, pinned or not.
+  int GetNumberOfEntries();
+
+  // Description:
+  // Removes all entries, including pinned ones.
+  void RemoveAllEntries();
+
+protected:
+  vtkPolyDataLocatorCache();
+  ~vtkPolyDataLocatorCache();
+
+  int MaximumNumberOfEntries;
+
+private:
+  vtkPolyDataLocatorCache(const vtkPolyDataLocatorCache&);  // Not implemented.
+  void operator=(const vtkPolyDataLocatorCache&);  // Not implemented.
+
+  class Entry;
+  class Entries;
+
+  // Description:
+  // Returns the entry for input and build, adding an empty one if there
+  // is none. Must be called with the lock held.
+  Entry* FindEntry(vtkPolyData *input, BuildFunctionType build);
+
+  // Description:
+  // Same as FindEntry(), but first waits for any build for input in
+  // progress. Must be called with the lock held, which is released
+  // while waiting.
+  Entry* WaitForEntry(vtkPolyData *input, BuildFunctionType build);
+
+  // Description:
+  // Returns the up-to-date entry for input and build, building it if
+  // needed. Must be called with the lock held, which is released while
+  // building.
+  Entry* FindOrBuildEntry(vtkPolyData *input, BuildFunctionType build);
+
+  // Description:
+  // Evicts least recently used unpinned entries until the limit is
+  // met. Must be called with the lock held.
+  void EvictEntries();
+
+  Entries                    *Items;
+  vtkSimpleMutexLock         *Lock;
+  vtkSimpleConditionVariable *EntryBuilt;
+  unsigned long               UseCounter;
+};
+
+#endif